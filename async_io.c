@@ -0,0 +1,692 @@
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define ASYNC_IO_URING
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+// <linux/fs.h> (included by <linux/io_uring.h>) defines its own BLOCK_SIZE (1024)
+#undef BLOCK_SIZE
+#endif
+#endif
+
+#include "async_io.h"
+#include "stats.h"
+#include <errno.h>
+#include <pthread.h>
+#include <sys/uio.h>
+
+/**
+ * Struct that represents a read or a write of one chunk, partial transfers are resubmitted until the chunk is complete
+ *
+ * @param file_descriptor the file descriptor (int)
+ * @param buffer the start of the transfer (uint8_t array)
+ * @param size the number of bytes to transfer (size_t)
+ * @param done the number of bytes already transferred (size_t)
+ * @param zero_writes the number of consecutive writes that transferred nothing (int)
+ * @param buffer_index the index of the registered buffer that holds the transfer (int)
+ * @param is_write 1 for a write, 0 for a read (int)
+ * @param in_flight 1 while the transfer is not complete (int)
+ */
+struct async_request
+{
+    int file_descriptor;
+    uint8_t *buffer;
+    size_t size;
+    size_t done;
+    int zero_writes;
+    int buffer_index;
+    int is_write;
+    int in_flight;
+};
+
+struct async_engine;
+
+/**
+ * Struct that represents a transfer thread of the fallback, it does the reads (or the writes) one at a time with plain read/write calls
+ *
+ * @param engine pointer to the engine (struct async_engine)
+ * @param pending the request to transfer, NULL while idle (struct async_request)
+ * @param thread the thread (pthread_t)
+ */
+struct async_lane
+{
+    struct async_engine *engine;
+    struct async_request *pending;
+    pthread_t thread;
+};
+
+/**
+ * Struct that represents the io engine, an io_uring or the plain read/write fallback (ring_file_descriptor is -1)
+ *
+ * @param ring_file_descriptor the io_uring file descriptor, -1 for the fallback (int)
+ * @param fixed_buffers 1 if the buffers are registered in the ring (int)
+ * @param lanes the transfer threads of the fallback, one for the reads and one for the writes (struct async_lane array)
+ * @param lanes_started 1 once the transfer threads are running (int)
+ * @param stopping 1 when the transfer threads must exit (int)
+ * @param mutex the mutex of the lanes (pthread_mutex_t)
+ * @param changed signaled when a request is handed to a lane or completed (pthread_cond_t)
+ * @param sq_head pointer to the submission queue head (unsigned)
+ * @param sq_tail pointer to the submission queue tail (unsigned)
+ * @param sq_mask pointer to the submission queue mask (unsigned)
+ * @param sq_array pointer to the submission queue index array (unsigned array)
+ * @param sqes the submission queue entries
+ * @param cq_head pointer to the completion queue head (unsigned)
+ * @param cq_tail pointer to the completion queue tail (unsigned)
+ * @param cq_mask pointer to the completion queue mask (unsigned)
+ * @param cqes the completion queue entries
+ * @param sq_ring the mapped submission ring
+ * @param sq_ring_size the size of the mapped submission ring (size_t)
+ * @param cq_ring the mapped completion ring (may be the same mapping as the submission ring)
+ * @param cq_ring_size the size of the mapped completion ring (size_t)
+ * @param sqes_size the size of the mapped submission queue entries (size_t)
+ */
+struct async_engine
+{
+    int ring_file_descriptor;
+    int fixed_buffers;
+    struct async_lane lanes[2];
+    int lanes_started;
+    int stopping;
+    pthread_mutex_t mutex;
+    pthread_cond_t changed;
+#ifdef ASYNC_IO_URING
+    unsigned *sq_head;
+    unsigned *sq_tail;
+    unsigned *sq_mask;
+    unsigned *sq_array;
+    struct io_uring_sqe *sqes;
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    unsigned *cq_mask;
+    struct io_uring_cqe *cqes;
+    void *sq_ring;
+    size_t sq_ring_size;
+    void *cq_ring;
+    size_t cq_ring_size;
+    size_t sqes_size;
+#endif
+};
+
+/**
+ * Function that sets up the io engine, it falls back to plain read/write when io_uring can not be used
+ *
+ * @param engine pointer to the engine (struct async_engine)
+ * @param buffers the buffers to register (struct iovec array)
+ * @param number_of_buffers the number of buffers (unsigned)
+ */
+static void async_engine_init(struct async_engine *engine, const struct iovec *buffers, unsigned number_of_buffers)
+{
+    memset(engine, 0, sizeof(struct async_engine));
+    engine->ring_file_descriptor = -1;
+
+#ifdef ASYNC_IO_URING
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+
+    int ring_file_descriptor = (int)syscall(__NR_io_uring_setup, ASYNC_IO_RING_ENTRIES, &params);
+
+    if (ring_file_descriptor < 0)
+    {
+        return;
+    }
+
+    // Offset -1 (current file position) is needed for pipes and to keep the reads/writes in order
+    if (!(params.features & IORING_FEAT_RW_CUR_POS))
+    {
+        close(ring_file_descriptor);
+        return;
+    }
+
+    engine->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    engine->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        if (engine->cq_ring_size > engine->sq_ring_size)
+        {
+            engine->sq_ring_size = engine->cq_ring_size;
+        }
+        engine->cq_ring_size = engine->sq_ring_size;
+    }
+
+    engine->sq_ring = mmap(NULL, engine->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_file_descriptor, IORING_OFF_SQ_RING);
+
+    if (engine->sq_ring == MAP_FAILED)
+    {
+        close(ring_file_descriptor);
+        return;
+    }
+
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        engine->cq_ring = engine->sq_ring;
+    }
+    else
+    {
+        engine->cq_ring = mmap(NULL, engine->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_file_descriptor, IORING_OFF_CQ_RING);
+
+        if (engine->cq_ring == MAP_FAILED)
+        {
+            munmap(engine->sq_ring, engine->sq_ring_size);
+            close(ring_file_descriptor);
+            return;
+        }
+    }
+
+    engine->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    engine->sqes = (struct io_uring_sqe *)mmap(NULL, engine->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_file_descriptor, IORING_OFF_SQES);
+
+    if (engine->sqes == MAP_FAILED)
+    {
+        if (engine->cq_ring != engine->sq_ring)
+        {
+            munmap(engine->cq_ring, engine->cq_ring_size);
+        }
+        munmap(engine->sq_ring, engine->sq_ring_size);
+        close(ring_file_descriptor);
+        return;
+    }
+
+    uint8_t *sq_ring = (uint8_t *)engine->sq_ring;
+    uint8_t *cq_ring = (uint8_t *)engine->cq_ring;
+
+    engine->sq_head = (unsigned *)(sq_ring + params.sq_off.head);
+    engine->sq_tail = (unsigned *)(sq_ring + params.sq_off.tail);
+    engine->sq_mask = (unsigned *)(sq_ring + params.sq_off.ring_mask);
+    engine->sq_array = (unsigned *)(sq_ring + params.sq_off.array);
+    engine->cq_head = (unsigned *)(cq_ring + params.cq_off.head);
+    engine->cq_tail = (unsigned *)(cq_ring + params.cq_off.tail);
+    engine->cq_mask = (unsigned *)(cq_ring + params.cq_off.ring_mask);
+    engine->cqes = (struct io_uring_cqe *)(cq_ring + params.cq_off.cqes);
+
+    // Registered buffers save the page pinning on every transfer, the ring still works without them (e.g. low RLIMIT_MEMLOCK)
+    engine->fixed_buffers = syscall(__NR_io_uring_register, ring_file_descriptor, IORING_REGISTER_BUFFERS, buffers, number_of_buffers) == 0;
+    engine->ring_file_descriptor = ring_file_descriptor;
+#else
+    (void)buffers;
+    (void)number_of_buffers;
+#endif
+}
+
+/**
+ * Function that tears down the io engine
+ *
+ * @param engine pointer to the engine (struct async_engine)
+ */
+static void async_engine_destroy(struct async_engine *engine)
+{
+    if (engine->lanes_started)
+    {
+        pthread_mutex_lock(&engine->mutex);
+        engine->stopping = 1;
+        pthread_cond_broadcast(&engine->changed);
+        pthread_mutex_unlock(&engine->mutex);
+
+        for (int lane = 0; lane < 2; lane++)
+        {
+            pthread_join(engine->lanes[lane].thread, NULL);
+        }
+
+        pthread_cond_destroy(&engine->changed);
+        pthread_mutex_destroy(&engine->mutex);
+        engine->lanes_started = 0;
+    }
+
+#ifdef ASYNC_IO_URING
+    if (engine->ring_file_descriptor < 0)
+    {
+        return;
+    }
+
+    munmap(engine->sqes, engine->sqes_size);
+    if (engine->cq_ring != engine->sq_ring)
+    {
+        munmap(engine->cq_ring, engine->cq_ring_size);
+    }
+    munmap(engine->sq_ring, engine->sq_ring_size);
+    close(engine->ring_file_descriptor);
+#endif
+    engine->ring_file_descriptor = -1;
+}
+
+/**
+ * Function that counts a write of 0 bytes, exits once there were too many in a row (a 0-byte read is the end of the input, a 0-byte write is only retried)
+ *
+ * @param request pointer to the write request (struct async_request)
+ */
+static void count_zero_write(struct async_request *request)
+{
+    if (++request->zero_writes > ASYNC_IO_MAX_ZERO_WRITES)
+    {
+        fprintf(stderr, "Error writing the output: no progress after %d writes\n", ASYNC_IO_MAX_ZERO_WRITES);
+        exit(1);
+    }
+}
+
+/**
+ * Function that does the transfer of a request with plain read/write calls, it returns once the request is complete or the input ended
+ *
+ * @param request pointer to the request (struct async_request)
+ */
+static void transfer_synchronously(struct async_request *request)
+{
+    while (request->done < request->size)
+    {
+        ssize_t result = request->is_write
+                             ? write(request->file_descriptor, request->buffer + request->done, request->size - request->done)
+                             : read(request->file_descriptor, request->buffer + request->done, request->size - request->done);
+
+        if (result < 0 && errno == EINTR)
+        {
+            continue;
+        }
+
+        if (result < 0)
+        {
+            perror(request->is_write ? "Error writing the output" : "Error reading the input");
+            exit(1);
+        }
+
+        if (result == 0 && request->is_write)
+        {
+            count_zero_write(request);
+            continue;
+        }
+
+        if (result == 0) // end of the input
+        {
+            break;
+        }
+
+        request->zero_writes = 0;
+        request->done += (size_t)result;
+    }
+}
+
+/**
+ * Function run by a transfer thread of the fallback, it transfers the requests handed to its lane until the engine is stopped
+ *
+ * @param argument pointer to the lane (struct async_lane)
+ */
+static void *transfer_thread(void *argument)
+{
+    struct async_lane *lane = (struct async_lane *)argument;
+    struct async_engine *engine = lane->engine;
+
+    pthread_mutex_lock(&engine->mutex);
+
+    for (;;)
+    {
+        while (lane->pending == NULL && !engine->stopping)
+        {
+            pthread_cond_wait(&engine->changed, &engine->mutex);
+        }
+
+        if (lane->pending == NULL)
+        {
+            break;
+        }
+
+        struct async_request *request = lane->pending;
+
+        pthread_mutex_unlock(&engine->mutex);
+        transfer_synchronously(request);
+        pthread_mutex_lock(&engine->mutex);
+
+        request->in_flight = 0;
+        lane->pending = NULL;
+        pthread_cond_broadcast(&engine->changed);
+    }
+
+    pthread_mutex_unlock(&engine->mutex);
+
+    return NULL;
+}
+
+/**
+ * Function that starts the transfer threads of the fallback, the reads and the writes then overlap with the cipher (and with each other) like on io_uring
+ *
+ * @param engine pointer to the engine (struct async_engine)
+ */
+static void start_lanes(struct async_engine *engine)
+{
+    pthread_mutex_init(&engine->mutex, NULL);
+    pthread_cond_init(&engine->changed, NULL);
+
+    for (int lane = 0; lane < 2; lane++)
+    {
+        engine->lanes[lane].engine = engine;
+        engine->lanes[lane].pending = NULL;
+
+        if (pthread_create(&engine->lanes[lane].thread, NULL, transfer_thread, &engine->lanes[lane]) != 0)
+        {
+            fprintf(stderr, "Error creating io transfer thread\n");
+            exit(1);
+        }
+    }
+
+    engine->lanes_started = 1;
+}
+
+/**
+ * Function that submits the rest of a request (from request->done to request->size)
+ *
+ * @param engine pointer to the engine (struct async_engine)
+ * @param request pointer to the request (struct async_request)
+ */
+static void async_submit(struct async_engine *engine, struct async_request *request)
+{
+    if (engine->ring_file_descriptor < 0)
+    {
+        if (!engine->lanes_started)
+        {
+            start_lanes(engine);
+        }
+
+        // The pipeline has at most one read and one write in flight, so a lane is always idle here
+        struct async_lane *lane = &engine->lanes[request->is_write];
+
+        pthread_mutex_lock(&engine->mutex);
+        while (lane->pending != NULL)
+        {
+            pthread_cond_wait(&engine->changed, &engine->mutex);
+        }
+        request->in_flight = 1;
+        lane->pending = request;
+        pthread_cond_broadcast(&engine->changed);
+        pthread_mutex_unlock(&engine->mutex);
+        return;
+    }
+
+#ifdef ASYNC_IO_URING
+    unsigned tail = *engine->sq_tail;
+    unsigned index = tail & *engine->sq_mask;
+    struct io_uring_sqe *sqe = &engine->sqes[index];
+
+    memset(sqe, 0, sizeof(struct io_uring_sqe));
+
+    if (engine->fixed_buffers)
+    {
+        sqe->opcode = request->is_write ? IORING_OP_WRITE_FIXED : IORING_OP_READ_FIXED;
+        sqe->buf_index = (uint16_t)request->buffer_index;
+    }
+    else
+    {
+        sqe->opcode = request->is_write ? IORING_OP_WRITE : IORING_OP_READ;
+    }
+
+    sqe->fd = request->file_descriptor;
+    sqe->addr = (uint64_t)(uintptr_t)(request->buffer + request->done);
+    sqe->len = (uint32_t)(request->size - request->done);
+    sqe->off = (uint64_t)-1; // current file position
+    sqe->user_data = (uint64_t)(uintptr_t)request;
+
+    engine->sq_array[index] = index;
+    __atomic_store_n(engine->sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+    request->in_flight = 1;
+
+    while (syscall(__NR_io_uring_enter, engine->ring_file_descriptor, 1, 0, 0, NULL, 0) < 0)
+    {
+        if (errno != EINTR && errno != EAGAIN)
+        {
+            perror("Error submitting to io_uring");
+            exit(1);
+        }
+    }
+#endif
+}
+
+/**
+ * Function that waits until a request is complete, the completions of the other requests in flight are handled on the way
+ *
+ * @param engine pointer to the engine (struct async_engine)
+ * @param request pointer to the request (struct async_request)
+ */
+static void async_wait(struct async_engine *engine, struct async_request *request)
+{
+    if (engine->ring_file_descriptor < 0)
+    {
+        if (engine->lanes_started)
+        {
+            pthread_mutex_lock(&engine->mutex);
+            while (request->in_flight)
+            {
+                pthread_cond_wait(&engine->changed, &engine->mutex);
+            }
+            pthread_mutex_unlock(&engine->mutex);
+        }
+        return;
+    }
+
+#ifdef ASYNC_IO_URING
+    while (request->in_flight)
+    {
+        unsigned head = *engine->cq_head;
+
+        if (head == __atomic_load_n(engine->cq_tail, __ATOMIC_ACQUIRE))
+        {
+            if (syscall(__NR_io_uring_enter, engine->ring_file_descriptor, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0) < 0 && errno != EINTR)
+            {
+                perror("Error waiting on io_uring");
+                exit(1);
+            }
+            continue;
+        }
+
+        struct io_uring_cqe *cqe = &engine->cqes[head & *engine->cq_mask];
+        struct async_request *completed = (struct async_request *)(uintptr_t)cqe->user_data;
+        int result = cqe->res;
+
+        __atomic_store_n(engine->cq_head, head + 1, __ATOMIC_RELEASE);
+
+        completed->in_flight = 0;
+
+        if (result == -EINTR || result == -EAGAIN)
+        {
+            async_submit(engine, completed);
+            continue;
+        }
+
+        if (result < 0)
+        {
+            errno = -result;
+            perror(completed->is_write ? "Error writing the output" : "Error reading the input");
+            exit(1);
+        }
+
+        // A write of 0 bytes is retried, a partial transfer is resubmitted
+        if (result == 0 && completed->is_write)
+        {
+            count_zero_write(completed);
+            async_submit(engine, completed);
+            continue;
+        }
+
+        // A read of 0 bytes is the end of the input
+        if (result > 0)
+        {
+            completed->zero_writes = 0;
+            completed->done += (size_t)result;
+
+            if (completed->done < completed->size)
+            {
+                async_submit(engine, completed);
+            }
+        }
+    }
+#endif
+}
+
+int async_io_uring_available(void)
+{
+    struct async_engine engine;
+    async_engine_init(&engine, NULL, 0);
+
+    int available = engine.ring_file_descriptor >= 0;
+    async_engine_destroy(&engine);
+
+    return available;
+}
+
+/**
+ * Function that runs the pipeline, chunk k is ciphered while the read of chunk k + 1 and the write of chunk k - 1 are in flight
+ *
+ * Each buffer has BLOCK_SIZE bytes before the chunk, where the block held back from the previous chunk is placed when deciphering, and BLOCK_SIZE bytes after it for the padding when ciphering
+ *
+ * @param input_file the input file descriptor (int)
+ * @param output_file the output file descriptor (int)
+ * @param block_function the function that ciphers/deciphers whole blocks (block_cipher_function)
+ * @param key the key material given to the block function
+ * @param buffer_size the size of the chunks, multiple of BLOCK_SIZE (size_t)
+ * @param decipher 1 to decipher, 0 to cipher (int)
+ */
+static void async_stream(int input_file, int output_file, block_cipher_function block_function, const void *key, size_t buffer_size, int decipher)
+{
+    uint8_t *buffers[ASYNC_IO_BUFFERS];
+    struct iovec registered_buffers[ASYNC_IO_BUFFERS];
+    struct async_request reads[ASYNC_IO_BUFFERS];
+    struct async_request writes[ASYNC_IO_BUFFERS];
+
+    for (int buffer_index = 0; buffer_index < ASYNC_IO_BUFFERS; buffer_index++)
+    {
+        if (posix_memalign((void **)&buffers[buffer_index], 4096, buffer_size + 2 * BLOCK_SIZE) != 0) // memory allocation error
+        {
+            fprintf(stderr, "Error allocating memory for io buffers\n");
+            exit(1);
+        }
+
+        registered_buffers[buffer_index].iov_base = buffers[buffer_index];
+        registered_buffers[buffer_index].iov_len = buffer_size + 2 * BLOCK_SIZE;
+
+        memset(&reads[buffer_index], 0, sizeof(struct async_request));
+        reads[buffer_index].file_descriptor = input_file;
+        reads[buffer_index].buffer = buffers[buffer_index] + BLOCK_SIZE;
+        reads[buffer_index].size = buffer_size;
+        reads[buffer_index].buffer_index = buffer_index;
+
+        memset(&writes[buffer_index], 0, sizeof(struct async_request));
+        writes[buffer_index].file_descriptor = output_file;
+        writes[buffer_index].buffer_index = buffer_index;
+        writes[buffer_index].is_write = 1;
+    }
+
+    struct async_engine engine;
+    async_engine_init(&engine, registered_buffers, ASYNC_IO_BUFFERS);
+
+    struct async_request *write_in_flight = NULL;
+    size_t number_of_held_bytes = 0;
+
+    async_submit(&engine, &reads[0]);
+
+    for (size_t chunk = 0;; chunk++)
+    {
+        int current = chunk % ASYNC_IO_BUFFERS;
+        int next = (chunk + 1) % ASYNC_IO_BUFFERS;
+
+        // With the reads and writes in flight, the read and write phases only count the time spent waiting for them
+        STATS_START(read_start);
+        async_wait(&engine, &reads[current]);
+        STATS_STOP(STATS_READ_BYTES, read_start, reads[current].done);
+
+        // Reads only stop short of the chunk size at the end of the input
+        int is_final_chunk = reads[current].done < buffer_size;
+
+        // The next buffer is free, its previous write (chunk - 2) finished before the write of chunk - 1 was submitted
+        if (!is_final_chunk)
+        {
+            reads[next].done = 0;
+            async_submit(&engine, &reads[next]);
+        }
+
+        uint8_t *data = buffers[current] + BLOCK_SIZE - number_of_held_bytes;
+        size_t number_of_bytes = number_of_held_bytes + reads[current].done;
+        size_t number_of_output_bytes;
+
+        if (!decipher)
+        {
+            if (is_final_chunk)
+            {
+                STATS_START(padding_start);
+                size_t number_of_padded_bytes = apply_padding(data, number_of_bytes);
+                STATS_STOP(STATS_ADD_PADDING, padding_start, number_of_padded_bytes - number_of_bytes);
+                number_of_bytes = number_of_padded_bytes;
+            }
+
+            STATS_START(feistel_start);
+            block_function(data, number_of_bytes, key);
+            STATS_STOP(STATS_FEISTEL, feistel_start, number_of_bytes);
+            number_of_output_bytes = number_of_bytes;
+        }
+        else if (is_final_chunk)
+        {
+            if (number_of_bytes % BLOCK_SIZE != 0)
+            {
+                fprintf(stderr, "Error: the ciphertext size is not a multiple of the block size\n");
+                exit(1);
+            }
+
+            STATS_START(feistel_start);
+            block_function(data, number_of_bytes, key);
+            STATS_STOP(STATS_FEISTEL, feistel_start, number_of_bytes);
+            number_of_output_bytes = number_of_bytes - get_padding_size(data, number_of_bytes);
+        }
+        else
+        {
+            // Hold back the last block, it may be the one with the padding
+            number_of_output_bytes = number_of_bytes - BLOCK_SIZE;
+            STATS_START(feistel_start);
+            block_function(data, number_of_output_bytes, key);
+            STATS_STOP(STATS_FEISTEL, feistel_start, number_of_output_bytes);
+
+            memcpy(buffers[next], data + number_of_output_bytes, BLOCK_SIZE);
+            number_of_held_bytes = BLOCK_SIZE;
+        }
+
+        // Only one write is in flight so the output stays in order
+        if (write_in_flight != NULL)
+        {
+            STATS_START(write_start);
+            async_wait(&engine, write_in_flight);
+            STATS_STOP(STATS_WRITE_BYTES, write_start, write_in_flight->size);
+            write_in_flight = NULL;
+        }
+
+        if (number_of_output_bytes > 0)
+        {
+            writes[current].buffer = data;
+            writes[current].size = number_of_output_bytes;
+            writes[current].done = 0;
+            async_submit(&engine, &writes[current]);
+            write_in_flight = &writes[current];
+        }
+
+        if (is_final_chunk)
+        {
+            break;
+        }
+    }
+
+    if (write_in_flight != NULL)
+    {
+        STATS_START(write_start);
+        async_wait(&engine, write_in_flight);
+        STATS_STOP(STATS_WRITE_BYTES, write_start, write_in_flight->size);
+    }
+
+    async_engine_destroy(&engine);
+
+    for (int buffer_index = 0; buffer_index < ASYNC_IO_BUFFERS; buffer_index++)
+    {
+        free(buffers[buffer_index]);
+    }
+}
+
+void async_stream_encrypt(int input_file, int output_file, block_cipher_function cipher, const void *key, size_t buffer_size)
+{
+    async_stream(input_file, output_file, cipher, key, buffer_size, 0);
+}
+
+void async_stream_decrypt(int input_file, int output_file, block_cipher_function decipher, const void *key, size_t buffer_size)
+{
+    async_stream(input_file, output_file, decipher, key, buffer_size, 1);
+}
@@ -0,0 +1,52 @@
+#ifndef __ASYNC_IO_H__
+#define __ASYNC_IO_H__
+
+/**
+ * @file async_io.h
+ * @brief Asynchronous stream pipeline (io_uring)
+ *
+ * This file contains the stream pipeline that overlaps the read of the next chunk and the write of the previous chunk with the cipher of the current chunk.
+ * On Linux the reads and writes are submitted to an io_uring with registered buffers, when io_uring is not available they are done with plain read/write calls over the same buffers by two transfer threads (one for the reads, one for the writes), so they still overlap with the cipher.
+ *
+ * @author Ana Vidal (118408)
+ * @author Simão Andrade (118345)
+ * @date 2023-10-20
+ */
+
+#include "implementation.h"
+
+// Constants for the asynchronous pipeline
+#define ASYNC_IO_BUFFERS 3 // one chunk being read, one being ciphered and one being written
+#define ASYNC_IO_RING_ENTRIES 8
+#define ASYNC_IO_MAX_ZERO_WRITES 8 // consecutive writes of 0 bytes before the output is given up on
+
+/**
+ * Function that checks if io_uring can be used by the pipeline
+ *
+ * @return 1 if io_uring is available, 0 otherwise
+ */
+int async_io_uring_available(void);
+
+/**
+ * Async Stream Encrypt Function, reads the plaintext in chunks of buffer_size bytes, ciphers them and writes them, the read of the next chunk and the write of the previous chunk are in flight while the current chunk is ciphered
+ *
+ * @param input_file the input file descriptor (int)
+ * @param output_file the output file descriptor (int)
+ * @param cipher the function that ciphers whole blocks (block_cipher_function)
+ * @param key the key material given to the cipher function
+ * @param buffer_size the size of the chunks, multiple of BLOCK_SIZE (size_t)
+ */
+void async_stream_encrypt(int input_file, int output_file, block_cipher_function cipher, const void *key, size_t buffer_size);
+
+/**
+ * Async Stream Decrypt Function, reads the ciphertext in chunks of buffer_size bytes, deciphers them and writes them, the last block of each chunk is held back until the next chunk arrives so the padding can be removed
+ *
+ * @param input_file the input file descriptor (int)
+ * @param output_file the output file descriptor (int)
+ * @param decipher the function that deciphers whole blocks (block_cipher_function)
+ * @param key the key material given to the decipher function
+ * @param buffer_size the size of the chunks, multiple of BLOCK_SIZE (size_t)
+ */
+void async_stream_decrypt(int input_file, int output_file, block_cipher_function decipher, const void *key, size_t buffer_size);
+
+#endif
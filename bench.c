@@ -0,0 +1,751 @@
+#include "implementation.h"
+#include "cbc.h"
+#include <openssl/evp.h>
+#include <limits.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAS_TSC 1
+#else
+#define HAS_TSC 0
+#endif
+
+/**
+ * @file bench.c
+ * @brief Micro-benchmark of the block cipher functions (E-DES, DES-ECB, 3DES-EDE and AES-128-ECB) over a sweep of buffer sizes
+ *
+ * @author Ana Vidal (118408)
+ * @author Simão Andrade (118345)
+ * @date 2023-10-20
+ */
+
+#define BENCH_MIN_SIZE 8                          // first size of the sweep
+#define BENCH_MAX_SIZE (1024UL * 1024 * 1024)     // last size of the sweep (1 GiB)
+#define BENCH_SIZE_FACTOR 8                       // each size of the sweep is 8 times the previous one
+#define BENCH_MIN_SAMPLE_BYTES (16 * 1024)        // small buffers are ciphered several times per sample
+#define BENCH_BYTES_PER_SIZE (64UL * 1024 * 1024) // bytes ciphered per size, function and direction
+#define BENCH_MIN_SAMPLES 5
+#define BENCH_MAX_SAMPLES 1000
+#define BENCH_WARMUP_DIVISOR 10 // the warm-up runs a tenth of the samples (at least one)
+#define BENCH_KEY_SETUP_SAMPLES 1000
+#define BENCH_KEYS_PER_SAMPLE 16 // distinct passwords derived per key setup sample
+#define BENCH_PASSWORD_LENGTH 16
+#define BENCH_CBC_STREAMS 150                // streams of the CBC batch check, more than two groups of CBC_STREAMS_PER_TASK
+#define BENCH_CBC_MAX_LENGTH (64 * 1024 + 7) // longest plaintext of the CBC batch check, the lengths are random so the streams end at different blocks
+#define BENCH_CBC_CHUNK_SIZE (4 * 1024)      // chunk size of the reference cbc_stream_encrypt/cbc_stream_decrypt, most streams span several chunks
+
+#define BENCH_CSV_PATH "performance/bench_c.csv"
+#define BENCH_JSON_PATH "performance/bench_c.json"
+
+/**
+ * Struct that represents a cipher under test
+ *
+ * @param name the name of the cipher (char array)
+ * @param encrypt the function that ciphers the blocks (block_cipher_function)
+ * @param decrypt the function that deciphers the blocks (block_cipher_function)
+ * @param encrypt_key the key of the cipher function
+ * @param decrypt_key the key of the decipher function
+ * @param block_size the block size of the cipher (size_t)
+ */
+struct bench_cipher
+{
+    const char *name;
+    block_cipher_function encrypt;
+    block_cipher_function decrypt;
+    const void *encrypt_key;
+    const void *decrypt_key;
+    size_t block_size;
+};
+
+/**
+ * Function pointer type for the functions that derive a key from a password
+ *
+ * @param password the password, BENCH_PASSWORD_LENGTH bytes and null terminated (uint8_t array)
+ * @param key the derived key
+ */
+typedef void (*key_setup_function)(const uint8_t *password, void *key);
+
+/**
+ * Struct that represents the result of a benchmark
+ *
+ * @param cipher the name of the cipher (char array)
+ * @param direction "encrypt" or "decrypt" (char array)
+ * @param size the buffer size in bytes (size_t)
+ * @param samples the number of samples (size_t)
+ * @param p50 the median time of a call in nanoseconds (double)
+ * @param p99 the 99th percentile time of a call in nanoseconds (double)
+ * @param p999 the 99.9th percentile time of a call in nanoseconds (double)
+ * @param cycles the median TSC cycles of a call, 0 without a TSC (double)
+ * @param cycles_per_byte the median TSC cycles per byte, 0 without a TSC (double)
+ * @param megabytes_per_second the throughput at the median time (double)
+ */
+struct bench_result
+{
+    const char *cipher;
+    const char *direction;
+    size_t size;
+    size_t samples;
+    double p50;
+    double p99;
+    double p999;
+    double cycles;
+    double cycles_per_byte;
+    double megabytes_per_second;
+};
+
+/**
+ * Function that returns the time of the monotonic raw clock in nanoseconds
+ *
+ * @return the time in nanoseconds (uint64_t)
+ */
+static uint64_t now_ns(void)
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &time);
+
+    return (uint64_t)time.tv_sec * 1000000000ULL + (uint64_t)time.tv_nsec;
+}
+
+/**
+ * Function that reads the time stamp counter, 0 on machines without it
+ *
+ * @return the number of cycles (uint64_t)
+ */
+static uint64_t now_cycles(void)
+{
+#if HAS_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+/**
+ * Function that fills a buffer with random data from '/dev/urandom'
+ *
+ * @param buffer pointer to the buffer (uint8_t array)
+ * @param buffer_size the buffer size (size_t)
+ */
+static void generate_random_data(uint8_t *buffer, size_t buffer_size)
+{
+    FILE *urandom = fopen("/dev/urandom", "r");
+
+    if (urandom == NULL || fread(buffer, sizeof(uint8_t), buffer_size, urandom) != buffer_size)
+    {
+        fprintf(stderr, "Error reading random data\n");
+        exit(1);
+    }
+
+    fclose(urandom);
+}
+
+/**
+ * Function that ciphers the blocks in place with AES-128-ECB (OpenSSL EVP, no padding)
+ *
+ * @param blocks the blocks (uint8_t array)
+ * @param number_of_bytes the number of bytes, multiple of 16 (size_t)
+ * @param context the EVP cipher context (EVP_CIPHER_CTX)
+ */
+static void aes_ecb_blocks(uint8_t *blocks, size_t number_of_bytes, const void *context)
+{
+    EVP_CIPHER_CTX *ctx = (EVP_CIPHER_CTX *)context;
+    int output_length;
+
+    // EVP_CipherUpdate takes an int length
+    for (size_t offset = 0; offset < number_of_bytes; offset += INT_MAX / 2 + 1)
+    {
+        size_t length = number_of_bytes - offset;
+        if (length > INT_MAX / 2 + 1)
+        {
+            length = INT_MAX / 2 + 1;
+        }
+
+        if (EVP_CipherUpdate(ctx, blocks + offset, &output_length, blocks + offset, (int)length) != 1)
+        {
+            fprintf(stderr, "Error in AES-128-ECB\n");
+            exit(1);
+        }
+    }
+}
+
+/**
+ * Function that creates an AES-128-ECB context
+ *
+ * @param key the 16 byte key (uint8_t array)
+ * @param encrypt 1 to cipher, 0 to decipher (int)
+ *
+ * @return the EVP cipher context (EVP_CIPHER_CTX)
+ */
+static EVP_CIPHER_CTX *create_aes_context(const uint8_t *key, int encrypt)
+{
+    EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
+
+    if (ctx == NULL || EVP_CipherInit_ex(ctx, EVP_aes_128_ecb(), NULL, key, NULL, encrypt) != 1)
+    {
+        fprintf(stderr, "Error creating the AES-128-ECB context\n");
+        exit(1);
+    }
+
+    EVP_CIPHER_CTX_set_padding(ctx, 0);
+
+    return ctx;
+}
+
+/**
+ * Function that derives an E-DES key context (the sboxes)
+ */
+static void edes_key_setup(const uint8_t *password, void *key)
+{
+    edes_ctx_init((struct edes_ctx *)key, password);
+}
+
+/**
+ * Function that derives a DES key and sets it on the cached EVP context of the thread (a zero length update), like aes_key_setup
+ */
+static void des_key_setup(const uint8_t *password, void *key)
+{
+    generate_des_key(password, (struct des_key *)key);
+    des_ecb_encrypt_blocks(NULL, 0, key);
+}
+
+/**
+ * Function that derives a 3DES-EDE key and sets it on the cached EVP context of the thread
+ */
+static void triple_des_key_setup(const uint8_t *password, void *key)
+{
+    generate_triple_des_key(password, (struct des_key *)key);
+    des_ecb_encrypt_blocks(NULL, 0, key);
+}
+
+/**
+ * Function that sets a new AES-128 key on an existing EVP cipher context (the password bytes are the key)
+ */
+static void aes_key_setup(const uint8_t *password, void *key)
+{
+    EVP_CipherInit_ex((EVP_CIPHER_CTX *)key, NULL, NULL, password, NULL, -1);
+}
+
+/**
+ * Function that compares two doubles (for qsort)
+ */
+static int compare_doubles(const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+
+    return (x > y) - (x < y);
+}
+
+/**
+ * Function that returns a percentile of sorted samples (nearest rank)
+ *
+ * @param samples the sorted samples (double array)
+ * @param number_of_samples the number of samples (size_t)
+ * @param percentile the percentile, between 0 and 100 (double)
+ *
+ * @return the sample at the percentile (double)
+ */
+static double percentile(const double *samples, size_t number_of_samples, double percentile)
+{
+    size_t rank = (size_t)(percentile / 100.0 * number_of_samples + 0.999999);
+
+    if (rank < 1)
+    {
+        rank = 1;
+    }
+    if (rank > number_of_samples)
+    {
+        rank = number_of_samples;
+    }
+
+    return samples[rank - 1];
+}
+
+/**
+ * Function that benchmarks a block function over a buffer size, after a warm-up
+ *
+ * @param function the block function (block_cipher_function)
+ * @param key the key of the function
+ * @param buffer the buffer (uint8_t array)
+ * @param size the buffer size (size_t)
+ * @param result pointer to the result, the cipher name and direction are left untouched (struct bench_result)
+ */
+static void bench_function(block_cipher_function function, const void *key, uint8_t *buffer, size_t size, struct bench_result *result)
+{
+    // Small buffers are ciphered several times per sample so the clock resolution does not dominate
+    size_t calls_per_sample = (BENCH_MIN_SAMPLE_BYTES + size - 1) / size;
+    size_t number_of_samples = BENCH_BYTES_PER_SIZE / (calls_per_sample * size);
+
+    if (number_of_samples < BENCH_MIN_SAMPLES)
+    {
+        number_of_samples = BENCH_MIN_SAMPLES;
+    }
+    if (number_of_samples > BENCH_MAX_SAMPLES)
+    {
+        number_of_samples = BENCH_MAX_SAMPLES;
+    }
+
+    size_t warmup_samples = number_of_samples / BENCH_WARMUP_DIVISOR > 0 ? number_of_samples / BENCH_WARMUP_DIVISOR : 1;
+    for (size_t sample = 0; sample < warmup_samples; sample++)
+    {
+        for (size_t call = 0; call < calls_per_sample; call++)
+        {
+            function(buffer, size, key);
+        }
+    }
+
+    double *times = (double *)malloc(number_of_samples * sizeof(double));
+    double *cycles = (double *)malloc(number_of_samples * sizeof(double));
+
+    if (times == NULL || cycles == NULL)
+    {
+        fprintf(stderr, "Memory allocation error\n");
+        exit(1);
+    }
+
+    for (size_t sample = 0; sample < number_of_samples; sample++)
+    {
+        uint64_t start_cycles = now_cycles();
+        uint64_t start_time = now_ns();
+
+        for (size_t call = 0; call < calls_per_sample; call++)
+        {
+            function(buffer, size, key);
+        }
+
+        uint64_t end_time = now_ns();
+        uint64_t end_cycles = now_cycles();
+
+        times[sample] = (double)(end_time - start_time) / calls_per_sample;
+        cycles[sample] = (double)(end_cycles - start_cycles) / calls_per_sample;
+    }
+
+    qsort(times, number_of_samples, sizeof(double), compare_doubles);
+    qsort(cycles, number_of_samples, sizeof(double), compare_doubles);
+
+    result->size = size;
+    result->samples = number_of_samples;
+    result->p50 = percentile(times, number_of_samples, 50.0);
+    result->p99 = percentile(times, number_of_samples, 99.0);
+    result->p999 = percentile(times, number_of_samples, 99.9);
+    result->cycles = percentile(cycles, number_of_samples, 50.0);
+    result->cycles_per_byte = result->cycles / size;
+    result->megabytes_per_second = result->p50 > 0 ? size / result->p50 * 1000.0 : 0; // bytes per ns to MB/s
+
+    free(times);
+    free(cycles);
+}
+
+/**
+ * Function that benchmarks the latency of a key setup function, after a warm-up
+ *
+ * @param function the key setup function (key_setup_function)
+ * @param key the key to derive into
+ * @param passwords the passwords, BENCH_KEYS_PER_SAMPLE of them (uint8_t array array)
+ * @param result pointer to the result, the cipher name and direction are left untouched (struct bench_result)
+ */
+static void bench_key_setup(key_setup_function function, void *key, uint8_t passwords[][BENCH_PASSWORD_LENGTH + 1], struct bench_result *result)
+{
+    double times[BENCH_KEY_SETUP_SAMPLES];
+    double cycles[BENCH_KEY_SETUP_SAMPLES];
+
+    for (size_t sample = 0; sample < BENCH_KEY_SETUP_SAMPLES / BENCH_WARMUP_DIVISOR; sample++)
+    {
+        for (int password = 0; password < BENCH_KEYS_PER_SAMPLE; password++)
+        {
+            function(passwords[password], key);
+        }
+    }
+
+    for (size_t sample = 0; sample < BENCH_KEY_SETUP_SAMPLES; sample++)
+    {
+        uint64_t start_cycles = now_cycles();
+        uint64_t start_time = now_ns();
+
+        for (int password = 0; password < BENCH_KEYS_PER_SAMPLE; password++)
+        {
+            function(passwords[password], key);
+        }
+
+        uint64_t end_time = now_ns();
+        uint64_t end_cycles = now_cycles();
+
+        times[sample] = (double)(end_time - start_time) / BENCH_KEYS_PER_SAMPLE;
+        cycles[sample] = (double)(end_cycles - start_cycles) / BENCH_KEYS_PER_SAMPLE;
+    }
+
+    qsort(times, BENCH_KEY_SETUP_SAMPLES, sizeof(double), compare_doubles);
+    qsort(cycles, BENCH_KEY_SETUP_SAMPLES, sizeof(double), compare_doubles);
+
+    result->size = 0;
+    result->samples = BENCH_KEY_SETUP_SAMPLES;
+    result->p50 = percentile(times, BENCH_KEY_SETUP_SAMPLES, 50.0);
+    result->p99 = percentile(times, BENCH_KEY_SETUP_SAMPLES, 99.0);
+    result->p999 = percentile(times, BENCH_KEY_SETUP_SAMPLES, 99.9);
+    result->cycles = percentile(cycles, BENCH_KEY_SETUP_SAMPLES, 50.0);
+    result->cycles_per_byte = 0;
+    result->megabytes_per_second = 0;
+}
+
+/**
+ * Function that writes the results as CSV
+ *
+ * @param path the output path (char array)
+ * @param results the results (struct bench_result array)
+ * @param number_of_results the number of results (size_t)
+ */
+static void write_csv(const char *path, const struct bench_result *results, size_t number_of_results)
+{
+    FILE *file = fopen(path, "w");
+
+    if (file == NULL)
+    {
+        perror(path);
+        exit(1);
+    }
+
+    fprintf(file, "cipher,direction,bytes,samples,p50_ns,p99_ns,p999_ns,cycles,cycles_per_byte,mb_per_s\n");
+    for (size_t index = 0; index < number_of_results; index++)
+    {
+        const struct bench_result *result = &results[index];
+        fprintf(file, "%s,%s,%zu,%zu,%.1f,%.1f,%.1f,%.0f,%.3f,%.2f\n", result->cipher, result->direction, result->size, result->samples, result->p50, result->p99, result->p999, result->cycles, result->cycles_per_byte, result->megabytes_per_second);
+    }
+
+    fclose(file);
+}
+
+/**
+ * Function that writes the results as JSON
+ *
+ * @param path the output path (char array)
+ * @param results the results (struct bench_result array)
+ * @param number_of_results the number of results (size_t)
+ */
+static void write_json(const char *path, const struct bench_result *results, size_t number_of_results)
+{
+    FILE *file = fopen(path, "w");
+
+    if (file == NULL)
+    {
+        perror(path);
+        exit(1);
+    }
+
+    fprintf(file, "{\n  \"timer\": \"CLOCK_MONOTONIC_RAW\",\n  \"cycles\": \"%s\",\n  \"e_des_kernel\": \"%s\",\n  \"results\": [\n", HAS_TSC ? "tsc" : "none", e_des_kernel_name());
+    for (size_t index = 0; index < number_of_results; index++)
+    {
+        const struct bench_result *result = &results[index];
+        fprintf(file, "    {\"cipher\": \"%s\", \"direction\": \"%s\", \"bytes\": %zu, \"samples\": %zu, \"p50_ns\": %.1f, \"p99_ns\": %.1f, \"p999_ns\": %.1f, \"cycles\": %.0f, \"cycles_per_byte\": %.3f, \"mb_per_s\": %.2f}%s\n",
+                result->cipher, result->direction, result->size, result->samples, result->p50, result->p99, result->p999, result->cycles, result->cycles_per_byte, result->megabytes_per_second,
+                index + 1 < number_of_results ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+
+    fclose(file);
+}
+
+/**
+ * Function that checks edes_cbc_encrypt_batch against cbc_stream_encrypt on streams of unequal length, and that cbc_stream_decrypt gives the plaintext back, it exits on a mismatch
+ *
+ * @param password the password, null terminated (uint8_t array)
+ */
+static void check_cbc_batch(const uint8_t *password)
+{
+    edes_key *key;
+    struct edes_ctx ctx;
+
+    if (edes_key_create(&key, password, strlen((const char *)password)) != EDES_OK)
+    {
+        fprintf(stderr, "Error creating the key\n");
+        exit(1);
+    }
+    edes_ctx_init(&ctx, password);
+
+    uint8_t *plaintexts[BENCH_CBC_STREAMS];
+    uint8_t ivs[BENCH_CBC_STREAMS][IV_SIZE];
+    edes_cbc_stream streams[BENCH_CBC_STREAMS];
+
+    for (size_t stream = 0; stream < BENCH_CBC_STREAMS; stream++)
+    {
+        uint32_t random_length;
+        generate_random_data((uint8_t *)&random_length, sizeof(random_length));
+        generate_random_data(ivs[stream], IV_SIZE);
+
+        // The first streams are the edge cases: empty, shorter than a block and exactly one block
+        size_t length = stream == 0 ? 0 : stream == 1 ? 1 : stream == 2 ? BLOCK_SIZE : random_length % (BENCH_CBC_MAX_LENGTH + 1);
+
+        plaintexts[stream] = (uint8_t *)malloc(length + 1);
+        streams[stream].buffer = (uint8_t *)malloc(edes_ciphertext_size(length));
+
+        if (plaintexts[stream] == NULL || streams[stream].buffer == NULL)
+        {
+            fprintf(stderr, "Memory allocation error\n");
+            exit(1);
+        }
+
+        generate_random_data(plaintexts[stream], length);
+        memcpy(streams[stream].buffer, plaintexts[stream], length);
+        streams[stream].length = length;
+        streams[stream].capacity = edes_ciphertext_size(length);
+        streams[stream].iv = ivs[stream];
+    }
+
+    if (edes_cbc_encrypt_batch(key, streams, BENCH_CBC_STREAMS) != EDES_OK)
+    {
+        fprintf(stderr, "Error in the CBC batch\n");
+        exit(1);
+    }
+
+    for (size_t stream = 0; stream < BENCH_CBC_STREAMS; stream++)
+    {
+        size_t length = streams[stream].length;
+        char *expected = NULL;
+        char *decrypted = NULL;
+        size_t expected_size = 0;
+        size_t decrypted_size = 0;
+
+        FILE *input = fmemopen(plaintexts[stream], length, "r");
+        FILE *output = open_memstream(&expected, &expected_size);
+
+        if (input == NULL || output == NULL || cbc_stream_encrypt(input, output, ctx.sboxes, ivs[stream], BENCH_CBC_CHUNK_SIZE) != EDES_OK)
+        {
+            fprintf(stderr, "Error in the CBC stream\n");
+            exit(1);
+        }
+        fclose(input);
+        fclose(output);
+
+        if (expected_size != streams[stream].ciphertext_size || memcmp(expected, streams[stream].buffer, expected_size) != 0)
+        {
+            fprintf(stderr, "CBC batch mismatch: stream %zu (%zu bytes)\n", stream, length);
+            exit(1);
+        }
+
+        input = fmemopen(streams[stream].buffer, streams[stream].ciphertext_size, "r");
+        output = open_memstream(&decrypted, &decrypted_size);
+
+        if (input == NULL || output == NULL || cbc_stream_decrypt(input, output, e_des_decrypt_blocks, ctx.sboxes, ivs[stream], BENCH_CBC_CHUNK_SIZE) != EDES_OK)
+        {
+            fprintf(stderr, "Error in the CBC stream\n");
+            exit(1);
+        }
+        fclose(input);
+        fclose(output);
+
+        if (decrypted_size != length || memcmp(decrypted, plaintexts[stream], length) != 0)
+        {
+            fprintf(stderr, "CBC round trip mismatch: stream %zu (%zu bytes)\n", stream, length);
+            exit(1);
+        }
+
+        free(expected);
+        free(decrypted);
+        free(plaintexts[stream]);
+        free(streams[stream].buffer);
+    }
+
+    printf("CBC batch check: %d streams OK\n", BENCH_CBC_STREAMS);
+
+    edes_ctx_clear(&ctx);
+    edes_key_destroy(key);
+}
+
+/**
+ * Function that prints the usage of the program
+ *
+ * @param program the name of the program (char array)
+ */
+static void usage(const char *program)
+{
+    fprintf(stderr, "Usage: %s [--check-cbc] [--key-setup] [--max-size <bytes>] [--csv <file>] [--json <file>]\n", program);
+    exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t max_size = BENCH_MAX_SIZE;
+    const char *csv_path = BENCH_CSV_PATH;
+    const char *json_path = BENCH_JSON_PATH;
+    int key_setup_only = 0;
+    int check_cbc = 0;
+
+    for (int argument = 1; argument < argc; argument++)
+    {
+        if (strcmp(argv[argument], "--check-cbc") == 0)
+        {
+            check_cbc = 1;
+        }
+        else if (strcmp(argv[argument], "--key-setup") == 0)
+        {
+            key_setup_only = 1;
+        }
+        else if (strcmp(argv[argument], "--max-size") == 0 && argument + 1 < argc)
+        {
+            max_size = strtoull(argv[++argument], NULL, 10);
+        }
+        else if (strcmp(argv[argument], "--csv") == 0 && argument + 1 < argc)
+        {
+            csv_path = argv[++argument];
+        }
+        else if (strcmp(argv[argument], "--json") == 0 && argument + 1 < argc)
+        {
+            json_path = argv[++argument];
+        }
+        else
+        {
+            usage(argv[0]);
+        }
+    }
+
+    if (max_size < BENCH_MIN_SIZE)
+    {
+        usage(argv[0]);
+    }
+
+    // Keys
+    uint8_t password[BLOCK_SIZE + 1] = {0};
+    uint8_t aes_key[16];
+    generate_random_data(password, BLOCK_SIZE);
+    generate_random_data(aes_key, sizeof(aes_key));
+
+    struct edes_ctx edes_key;
+    edes_ctx_init(&edes_key, password);
+
+    struct des_key des_key;
+    struct des_key triple_des_key;
+    generate_des_key(password, &des_key);
+    generate_triple_des_key(password, &triple_des_key);
+
+    EVP_CIPHER_CTX *aes_encrypt_ctx = create_aes_context(aes_key, 1);
+    EVP_CIPHER_CTX *aes_decrypt_ctx = create_aes_context(aes_key, 0);
+
+    // Distinct printable passwords for the key setup latency (the E-DES key derivation hashes a null terminated string)
+    uint8_t passwords[BENCH_KEYS_PER_SAMPLE][BENCH_PASSWORD_LENGTH + 1] = {{0}};
+    for (int index = 0; index < BENCH_KEYS_PER_SAMPLE; index++)
+    {
+        generate_random_data(passwords[index], BENCH_PASSWORD_LENGTH);
+
+        for (int byte = 0; byte < BENCH_PASSWORD_LENGTH; byte++)
+        {
+            passwords[index][byte] = '!' + passwords[index][byte] % ('~' - '!' + 1);
+        }
+    }
+
+    // With --check-cbc only the CBC batch is checked
+    if (check_cbc)
+    {
+        check_cbc_batch(passwords[0]);
+        return 0;
+    }
+
+    struct edes_ctx key_setup_edes;
+    struct des_key key_setup_des;
+    struct des_key key_setup_triple_des;
+    EVP_CIPHER_CTX *key_setup_aes = create_aes_context(aes_key, 1);
+
+    const struct
+    {
+        const char *name;
+        key_setup_function function;
+        void *key;
+    } key_setups[] = {
+        {"e-des", edes_key_setup, &key_setup_edes},
+        {"des-ecb", des_key_setup, &key_setup_des},
+        {"3des-ede", triple_des_key_setup, &key_setup_triple_des},
+        {"aes-128-ecb", aes_key_setup, key_setup_aes},
+    };
+    size_t number_of_key_setups = sizeof(key_setups) / sizeof(key_setups[0]);
+
+    const struct bench_cipher ciphers[] = {
+        {"e-des", e_des_encrypt_blocks, e_des_decrypt_blocks, edes_key.sboxes, edes_key.sboxes, BLOCK_SIZE},
+        {"des-ecb", des_ecb_encrypt_blocks, des_ecb_decrypt_blocks, &des_key, &des_key, BLOCK_SIZE},
+        {"3des-ede", des_ecb_encrypt_blocks, des_ecb_decrypt_blocks, &triple_des_key, &triple_des_key, BLOCK_SIZE},
+        {"aes-128-ecb", aes_ecb_blocks, aes_ecb_blocks, aes_encrypt_ctx, aes_decrypt_ctx, 16},
+    };
+    size_t number_of_ciphers = sizeof(ciphers) / sizeof(ciphers[0]);
+
+    // With --key-setup the sweep is empty
+    if (key_setup_only)
+    {
+        max_size = 0;
+    }
+
+    uint8_t *buffer = (uint8_t *)malloc(max_size > 0 ? max_size : 1);
+    size_t number_of_sizes = 0;
+    for (size_t size = BENCH_MIN_SIZE; size <= max_size; size *= BENCH_SIZE_FACTOR)
+    {
+        number_of_sizes++;
+    }
+
+    struct bench_result *results = (struct bench_result *)calloc(number_of_key_setups + number_of_sizes * number_of_ciphers * 2, sizeof(struct bench_result));
+
+    if (buffer == NULL || results == NULL)
+    {
+        fprintf(stderr, "Memory allocation error\n");
+        exit(1);
+    }
+
+    generate_random_data(buffer, max_size);
+
+    printf("E-DES kernel: %s\n", e_des_kernel_name());
+    printf("%-12s %-9s %12s %8s %12s %12s %12s %10s %10s %10s\n", "cipher", "dir", "bytes", "samples", "p50 (ns)", "p99 (ns)", "p99.9 (ns)", "cycles", "cyc/B", "MB/s");
+
+    size_t number_of_results = 0;
+    for (size_t key_setup_index = 0; key_setup_index < number_of_key_setups; key_setup_index++)
+    {
+        struct bench_result *result = &results[number_of_results++];
+        result->cipher = key_setups[key_setup_index].name;
+        result->direction = "key-setup";
+
+        bench_key_setup(key_setups[key_setup_index].function, key_setups[key_setup_index].key, passwords, result);
+
+        printf("%-12s %-9s %12zu %8zu %12.1f %12.1f %12.1f %10.0f %10.3f %10.2f\n", result->cipher, result->direction, result->size, result->samples, result->p50, result->p99, result->p999, result->cycles, result->cycles_per_byte, result->megabytes_per_second);
+        fflush(stdout);
+    }
+
+    for (size_t size = BENCH_MIN_SIZE; size <= max_size; size *= BENCH_SIZE_FACTOR)
+    {
+        for (size_t cipher_index = 0; cipher_index < number_of_ciphers; cipher_index++)
+        {
+            const struct bench_cipher *cipher = &ciphers[cipher_index];
+
+            // Sizes smaller than the block (8 bytes for AES) are skipped
+            if (size % cipher->block_size != 0)
+            {
+                continue;
+            }
+
+            for (int direction = 0; direction < 2; direction++)
+            {
+                struct bench_result *result = &results[number_of_results++];
+                result->cipher = cipher->name;
+                result->direction = direction == 0 ? "encrypt" : "decrypt";
+
+                if (direction == 0)
+                {
+                    bench_function(cipher->encrypt, cipher->encrypt_key, buffer, size, result);
+                }
+                else
+                {
+                    bench_function(cipher->decrypt, cipher->decrypt_key, buffer, size, result);
+                }
+
+                printf("%-12s %-9s %12zu %8zu %12.1f %12.1f %12.1f %10.0f %10.3f %10.2f\n", result->cipher, result->direction, result->size, result->samples, result->p50, result->p99, result->p999, result->cycles, result->cycles_per_byte, result->megabytes_per_second);
+                fflush(stdout);
+            }
+        }
+    }
+
+    write_csv(csv_path, results, number_of_results);
+    write_json(json_path, results, number_of_results);
+
+    EVP_CIPHER_CTX_free(aes_encrypt_ctx);
+    EVP_CIPHER_CTX_free(aes_decrypt_ctx);
+    EVP_CIPHER_CTX_free(key_setup_aes);
+    edes_ctx_clear(&edes_key);
+    edes_ctx_clear(&key_setup_edes);
+    free(results);
+    free(buffer);
+
+    return 0;
+}
@@ -0,0 +1,296 @@
+#include "cbc.h"
+#include "stats.h"
+
+/**
+ * Struct that represents the arguments of a cbc_encrypt_messages job
+ *
+ * @param sboxes the sboxes (struct s_box array)
+ * @param messages the streams (struct cbc_message array)
+ * @param number_of_messages the number of streams (size_t)
+ */
+struct cbc_job
+{
+    const struct s_box *sboxes;
+    struct cbc_message *messages;
+    size_t number_of_messages;
+};
+
+/**
+ * Function that xors a block into another block
+ *
+ * @param block the block that receives the xor (uint8_t array)
+ * @param other the other block (uint8_t array)
+ */
+static inline void xor_block(uint8_t *block, const uint8_t *other)
+{
+    uint64_t block_word, other_word;
+
+    memcpy(&block_word, block, BLOCK_SIZE);
+    memcpy(&other_word, other, BLOCK_SIZE);
+    block_word ^= other_word;
+    memcpy(block, &block_word, BLOCK_SIZE);
+}
+
+void cbc_encrypt_blocks(const struct s_box *sboxes, uint8_t *chain, uint8_t *blocks, size_t number_of_bytes)
+{
+    const uint8_t *previous = chain;
+
+    for (size_t block_index = 0; block_index < number_of_bytes; block_index += BLOCK_SIZE)
+    {
+        xor_block(blocks + block_index, previous);
+        feistel_network(blocks + block_index, sboxes);
+        previous = blocks + block_index;
+    }
+
+    if (number_of_bytes > 0)
+    {
+        memcpy(chain, blocks + number_of_bytes - BLOCK_SIZE, BLOCK_SIZE);
+    }
+}
+
+void cbc_decrypt_blocks(block_cipher_function decipher, const void *key, uint8_t *chain, const uint8_t *ciphertext, uint8_t *plaintext, size_t number_of_bytes)
+{
+    if (number_of_bytes == 0)
+    {
+        return;
+    }
+
+    // The blocks do not depend on each other until the final xor
+    memcpy(plaintext, ciphertext, number_of_bytes);
+    decipher(plaintext, number_of_bytes, key);
+
+    xor_block(plaintext, chain);
+
+    for (size_t block_index = BLOCK_SIZE; block_index < number_of_bytes; block_index += BLOCK_SIZE)
+    {
+        xor_block(plaintext + block_index, ciphertext + block_index - BLOCK_SIZE);
+    }
+
+    memcpy(chain, ciphertext + number_of_bytes - BLOCK_SIZE, BLOCK_SIZE);
+}
+
+/**
+ * Task of a cbc_encrypt_messages job, it ciphers one group of CBC_STREAMS_PER_TASK streams, block i of every stream at the same time
+ *
+ * @param argument the job (struct cbc_job)
+ * @param task_index the index of the group (size_t)
+ */
+static void cbc_encrypt_group(void *argument, size_t task_index)
+{
+    struct cbc_job *job = (struct cbc_job *)argument;
+    struct cbc_message *group = job->messages + task_index * CBC_STREAMS_PER_TASK;
+    size_t number_of_streams = job->number_of_messages - task_index * CBC_STREAMS_PER_TASK;
+
+    if (number_of_streams > CBC_STREAMS_PER_TASK)
+    {
+        number_of_streams = CBC_STREAMS_PER_TASK;
+    }
+
+    size_t longest_size = 0;
+
+    for (size_t stream = 0; stream < number_of_streams; stream++)
+    {
+        if (group[stream].size > longest_size)
+        {
+            longest_size = group[stream].size;
+        }
+    }
+
+    uint8_t lanes[CBC_STREAMS_PER_TASK * BLOCK_SIZE];
+
+    for (size_t offset = 0; offset < longest_size; offset += BLOCK_SIZE)
+    {
+        // Gather block i of the streams that still have one, xored with their previous ciphertext block
+        size_t number_of_lanes = 0;
+
+        for (size_t stream = 0; stream < number_of_streams; stream++)
+        {
+            if (offset < group[stream].size)
+            {
+                uint8_t *lane = lanes + number_of_lanes * BLOCK_SIZE;
+
+                memcpy(lane, group[stream].data + offset, BLOCK_SIZE);
+                xor_block(lane, offset == 0 ? group[stream].iv : group[stream].data + offset - BLOCK_SIZE);
+                number_of_lanes++;
+            }
+        }
+
+        e_des_encrypt_blocks(lanes, number_of_lanes * BLOCK_SIZE, job->sboxes);
+
+        number_of_lanes = 0;
+
+        for (size_t stream = 0; stream < number_of_streams; stream++)
+        {
+            if (offset < group[stream].size)
+            {
+                memcpy(group[stream].data + offset, lanes + number_of_lanes * BLOCK_SIZE, BLOCK_SIZE);
+                number_of_lanes++;
+            }
+        }
+    }
+}
+
+void cbc_encrypt_messages(struct thread_pool *pool, const struct s_box *sboxes, struct cbc_message *messages, size_t number_of_messages)
+{
+    struct cbc_job job;
+    job.sboxes = sboxes;
+    job.messages = messages;
+    job.number_of_messages = number_of_messages;
+
+    size_t number_of_groups = (number_of_messages + CBC_STREAMS_PER_TASK - 1) / CBC_STREAMS_PER_TASK;
+
+    if (pool == NULL)
+    {
+        for (size_t group = 0; group < number_of_groups; group++)
+        {
+            cbc_encrypt_group(&job, group);
+        }
+        return;
+    }
+
+    thread_pool_run(pool, cbc_encrypt_group, &job, number_of_groups);
+}
+
+int cbc_stream_encrypt(FILE *input, FILE *output, const struct s_box *sboxes, const uint8_t *iv, size_t buffer_size)
+{
+    // Extra block so the padding of the final chunk always fits
+    uint8_t *buffer = (uint8_t *)malloc(buffer_size + BLOCK_SIZE);
+
+    if (buffer == NULL) // memory allocation error
+    {
+        return EDES_ERROR_OUT_OF_MEMORY;
+    }
+
+    uint8_t chain[BLOCK_SIZE];
+    memcpy(chain, iv, BLOCK_SIZE);
+
+    int status = EDES_OK;
+
+    for (;;)
+    {
+        STATS_START(read_start);
+        size_t number_of_readed_bytes = fread(buffer, sizeof(uint8_t), buffer_size, input);
+        STATS_STOP(STATS_READ_BYTES, read_start, number_of_readed_bytes);
+
+        if (ferror(input))
+        {
+            status = EDES_ERROR_IO;
+            break;
+        }
+
+        size_t number_of_bytes = number_of_readed_bytes;
+        int is_final_chunk = number_of_readed_bytes < buffer_size;
+
+        if (is_final_chunk)
+        {
+            STATS_START(padding_start);
+            number_of_bytes = apply_padding(buffer, number_of_readed_bytes);
+            STATS_STOP(STATS_ADD_PADDING, padding_start, number_of_bytes - number_of_readed_bytes);
+        }
+
+        STATS_START(feistel_start);
+        cbc_encrypt_blocks(sboxes, chain, buffer, number_of_bytes);
+        STATS_STOP(STATS_FEISTEL, feistel_start, number_of_bytes);
+
+        STATS_START(write_start);
+        if (fwrite(buffer, sizeof(uint8_t), number_of_bytes, output) != number_of_bytes)
+        {
+            status = EDES_ERROR_IO;
+            break;
+        }
+        STATS_STOP(STATS_WRITE_BYTES, write_start, number_of_bytes);
+
+        if (is_final_chunk)
+        {
+            break;
+        }
+    }
+
+    free(buffer);
+
+    return status;
+}
+
+int cbc_stream_decrypt(FILE *input, FILE *output, block_cipher_function decipher, const void *key, const uint8_t *iv, size_t buffer_size)
+{
+    // Extra block for the block held back from the previous chunk, the ciphertext must be kept for the xor so the plaintext has its own buffer
+    uint8_t *ciphertext = (uint8_t *)malloc(buffer_size + BLOCK_SIZE);
+    uint8_t *plaintext = (uint8_t *)malloc(buffer_size + BLOCK_SIZE);
+
+    if (ciphertext == NULL || plaintext == NULL) // memory allocation error
+    {
+        free(ciphertext);
+        free(plaintext);
+        return EDES_ERROR_OUT_OF_MEMORY;
+    }
+
+    uint8_t chain[BLOCK_SIZE];
+    memcpy(chain, iv, BLOCK_SIZE);
+
+    size_t number_of_held_bytes = 0;
+    int status = EDES_OK;
+
+    for (;;)
+    {
+        STATS_START(read_start);
+        size_t number_of_readed_bytes = fread(ciphertext + number_of_held_bytes, sizeof(uint8_t), buffer_size, input);
+        STATS_STOP(STATS_READ_BYTES, read_start, number_of_readed_bytes);
+
+        if (ferror(input))
+        {
+            status = EDES_ERROR_IO;
+            break;
+        }
+
+        size_t number_of_bytes = number_of_held_bytes + number_of_readed_bytes;
+
+        if (number_of_readed_bytes < buffer_size) // final chunk, its last block holds the padding
+        {
+            if (number_of_bytes % BLOCK_SIZE != 0)
+            {
+                status = EDES_ERROR_INVALID_SIZE;
+                break;
+            }
+
+            STATS_START(feistel_start);
+            cbc_decrypt_blocks(decipher, key, chain, ciphertext, plaintext, number_of_bytes);
+            STATS_STOP(STATS_FEISTEL, feistel_start, number_of_bytes);
+
+            number_of_bytes -= get_padding_size(plaintext, number_of_bytes);
+
+            STATS_START(write_start);
+            if (fwrite(plaintext, sizeof(uint8_t), number_of_bytes, output) != number_of_bytes)
+            {
+                status = EDES_ERROR_IO;
+                break;
+            }
+            STATS_STOP(STATS_WRITE_BYTES, write_start, number_of_bytes);
+            break;
+        }
+
+        // Hold back the last block, it may be the one with the padding
+        size_t number_of_ready_bytes = number_of_bytes - BLOCK_SIZE;
+
+        STATS_START(feistel_start);
+        cbc_decrypt_blocks(decipher, key, chain, ciphertext, plaintext, number_of_ready_bytes);
+        STATS_STOP(STATS_FEISTEL, feistel_start, number_of_ready_bytes);
+
+        STATS_START(write_start);
+        if (fwrite(plaintext, sizeof(uint8_t), number_of_ready_bytes, output) != number_of_ready_bytes)
+        {
+            status = EDES_ERROR_IO;
+            break;
+        }
+        STATS_STOP(STATS_WRITE_BYTES, write_start, number_of_ready_bytes);
+
+        memmove(ciphertext, ciphertext + number_of_ready_bytes, BLOCK_SIZE);
+        number_of_held_bytes = BLOCK_SIZE;
+    }
+
+    free(ciphertext);
+    // The plaintext buffer is wiped before it is freed
+    memset(plaintext, 0, buffer_size + BLOCK_SIZE);
+    free(plaintext);
+
+    return status;
+}
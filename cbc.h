@@ -0,0 +1,98 @@
+#ifndef __CBC_H__
+#define __CBC_H__
+
+/**
+ * @file cbc.h
+ * @brief Cipher block chaining (CBC) mode of e-des
+ *
+ * This file contains the CBC mode of e-des: every plaintext block is xored with the previous ciphertext block (the IV for the first one) before feistel_network.
+ * Encryption is serial within a stream, but many independent streams can be ciphered together, one block of each stream per call to the block kernel.
+ * Decryption is not serial: inverse_feistel_network is run over all the blocks at once (SIMD kernel, thread pool) and only the xor with the previous ciphertext block is left.
+ *
+ * @author Ana Vidal (118408)
+ * @author Simão Andrade (118345)
+ * @date 2023-10-20
+ */
+
+#include "implementation.h"
+#include "parallel.h"
+
+// Constants for the CBC mode
+#define CBC_STREAMS_PER_TASK 64 // number of streams ciphered together by one task of cbc_encrypt_messages, one block of each per call to the block kernel
+
+/**
+ * Struct that represents one independent CBC stream of cbc_encrypt_messages
+ *
+ * @param data the padded plaintext, ciphered in place (uint8_t array)
+ * @param size the size of the data, multiple of BLOCK_SIZE (size_t)
+ * @param iv the IV of the stream, IV_SIZE bytes (uint8_t array)
+ */
+struct cbc_message
+{
+    uint8_t *data;
+    size_t size;
+    const uint8_t *iv;
+};
+
+/**
+ * Function that ciphers the blocks in place with the CBC mode (serial, one feistel_network per block)
+ *
+ * @param sboxes the sboxes (struct s_box array)
+ * @param chain the previous ciphertext block (the IV at the start of the stream), updated to the last ciphertext block (uint8_t array)
+ * @param blocks the blocks (uint8_t array)
+ * @param number_of_bytes the number of bytes to cipher, multiple of BLOCK_SIZE (size_t)
+ */
+void cbc_encrypt_blocks(const struct s_box *sboxes, uint8_t *chain, uint8_t *blocks, size_t number_of_bytes);
+
+/**
+ * Function that deciphers the blocks with the CBC mode, all the blocks are deciphered at once by the decipher function and then xored with the previous ciphertext blocks
+ *
+ * @param decipher the function that deciphers whole blocks, e_des_decrypt_blocks or parallel_cipher_blocks (block_cipher_function)
+ * @param key the key material given to the decipher function
+ * @param chain the previous ciphertext block (the IV at the start of the stream), updated to the last ciphertext block (uint8_t array)
+ * @param ciphertext the ciphertext (uint8_t array)
+ * @param plaintext the plaintext, must not overlap the ciphertext (uint8_t array)
+ * @param number_of_bytes the number of bytes to decipher, multiple of BLOCK_SIZE (size_t)
+ */
+void cbc_decrypt_blocks(block_cipher_function decipher, const void *key, uint8_t *chain, const uint8_t *ciphertext, uint8_t *plaintext, size_t number_of_bytes);
+
+/**
+ * Function that ciphers many independent streams in place with the CBC mode, the streams are split in groups of CBC_STREAMS_PER_TASK across the thread pool
+ *
+ * Within a group the block i of every stream is ciphered by the same call to e_des_encrypt_blocks, so the SIMD kernels are filled even though each stream is serial
+ *
+ * @param pool the thread pool, NULL to run on the calling thread (struct thread_pool)
+ * @param sboxes the sboxes (struct s_box array)
+ * @param messages the streams (struct cbc_message array)
+ * @param number_of_messages the number of streams (size_t)
+ */
+void cbc_encrypt_messages(struct thread_pool *pool, const struct s_box *sboxes, struct cbc_message *messages, size_t number_of_messages);
+
+/**
+ * CBC Stream Encrypt Function, reads the plaintext in chunks of buffer_size bytes, ciphers them and writes them, the padding is only added to the final block
+ *
+ * @param input the input stream (FILE)
+ * @param output the output stream (FILE)
+ * @param sboxes the sboxes (struct s_box array)
+ * @param iv the IV, IV_SIZE bytes (uint8_t array)
+ * @param buffer_size the size of the chunks, multiple of BLOCK_SIZE (size_t)
+ *
+ * @return EDES_OK, EDES_ERROR_OUT_OF_MEMORY, or EDES_ERROR_IO if the input could not be read or the output written
+ */
+int cbc_stream_encrypt(FILE *input, FILE *output, const struct s_box *sboxes, const uint8_t *iv, size_t buffer_size);
+
+/**
+ * CBC Stream Decrypt Function, reads the ciphertext in chunks of buffer_size bytes, deciphers them and writes them, the last block is held back so its padding can be removed
+ *
+ * @param input the input stream, positioned after the IV (FILE)
+ * @param output the output stream (FILE)
+ * @param decipher the function that deciphers whole blocks (block_cipher_function)
+ * @param key the key material given to the decipher function
+ * @param iv the IV, IV_SIZE bytes (uint8_t array)
+ * @param buffer_size the size of the chunks, multiple of BLOCK_SIZE (size_t)
+ *
+ * @return EDES_OK, EDES_ERROR_OUT_OF_MEMORY, EDES_ERROR_INVALID_SIZE if the ciphertext size is not a multiple of BLOCK_SIZE, or EDES_ERROR_IO
+ */
+int cbc_stream_decrypt(FILE *input, FILE *output, block_cipher_function decipher, const void *key, const uint8_t *iv, size_t buffer_size);
+
+#endif
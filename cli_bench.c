@@ -0,0 +1,387 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+/**
+ * @file cli_bench.c
+ * @brief End-to-end benchmark of the e-des binary (process startup, key derivation, stdin/stdout and padding included), with openssl enc as reference
+ *
+ * @author Ana Vidal (118408)
+ * @author Simão Andrade (118345)
+ * @date 2023-10-20
+ */
+
+#define CLI_BENCH_MIN_SIZE 1024UL                        // first size of the sweep (1 KiB)
+#define CLI_BENCH_MAX_SIZE (4UL * 1024 * 1024 * 1024)    // last size of the sweep (4 GiB)
+#define CLI_BENCH_SIZE_FACTOR 16                         // each size of the sweep is 16 times the previous one
+#define CLI_BENCH_CHUNK_SIZE (1024 * 1024)               // the input files are written 1 MiB at a time
+#define CLI_BENCH_MAX_ARGUMENTS 16
+#define CLI_BENCH_CSV_PATH "performance/cli_bench.csv"
+
+#define CLI_BENCH_PASSWORD "benchmark"
+#define CLI_BENCH_DES_KEY "62656e63686d6172"                  // hexadecimal key for openssl enc -des-ecb
+#define CLI_BENCH_AES_KEY "62656e63686d61726b62656e63686d61" // hexadecimal key for openssl enc -aes-128-ecb
+
+/**
+ * Struct that represents a command under test, both directions read stdin and write stdout
+ *
+ * @param tool the name of the program (char array)
+ * @param mode the cipher mode (char array)
+ * @param encrypt_arguments the arguments that cipher stdin to stdout, NULL terminated (char array array)
+ * @param decrypt_arguments the arguments that decipher stdin to stdout, NULL terminated (char array array)
+ */
+struct cli_command
+{
+    const char *tool;
+    const char *mode;
+    const char *encrypt_arguments[CLI_BENCH_MAX_ARGUMENTS];
+    const char *decrypt_arguments[CLI_BENCH_MAX_ARGUMENTS];
+};
+
+/**
+ * Struct that represents the measures of a run
+ *
+ * @param wall_time the wall time in seconds (double)
+ * @param user_time the user CPU time in seconds (double)
+ * @param system_time the system CPU time in seconds (double)
+ * @param max_rss the peak resident set size in KiB (long)
+ * @param read_syscalls the number of read system calls (unsigned long long)
+ * @param write_syscalls the number of write system calls (unsigned long long)
+ * @param exit_status the exit status, -1 if the process did not exit normally (int)
+ */
+struct cli_run
+{
+    double wall_time;
+    double user_time;
+    double system_time;
+    long max_rss;
+    unsigned long long read_syscalls;
+    unsigned long long write_syscalls;
+    int exit_status;
+};
+
+/**
+ * Function that returns the time of the monotonic raw clock in seconds
+ *
+ * @return the time in seconds (double)
+ */
+static double now_seconds(void)
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &time);
+
+    return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+/**
+ * Function that writes a file of random data (a random 1 MiB chunk repeated, ECB timing does not depend on the content)
+ *
+ * @param path the path of the file (char array)
+ * @param size the size of the file (size_t)
+ */
+static void generate_file(const char *path, size_t size)
+{
+    static uint8_t chunk[CLI_BENCH_CHUNK_SIZE];
+    static int chunk_ready = 0;
+
+    if (!chunk_ready)
+    {
+        FILE *urandom = fopen("/dev/urandom", "r");
+
+        if (urandom == NULL || fread(chunk, 1, sizeof(chunk), urandom) != sizeof(chunk))
+        {
+            fprintf(stderr, "Error reading random data\n");
+            exit(1);
+        }
+
+        fclose(urandom);
+        chunk_ready = 1;
+    }
+
+    FILE *file = fopen(path, "w");
+
+    if (file == NULL)
+    {
+        perror(path);
+        exit(1);
+    }
+
+    for (size_t written = 0; written < size; written += sizeof(chunk))
+    {
+        size_t length = size - written < sizeof(chunk) ? size - written : sizeof(chunk);
+
+        if (fwrite(chunk, 1, length, file) != length)
+        {
+            perror(path);
+            exit(1);
+        }
+    }
+
+    fclose(file);
+}
+
+/**
+ * Function that compares two files
+ *
+ * @param first_path the path of the first file (char array)
+ * @param second_path the path of the second file (char array)
+ *
+ * @return 1 if the files are equal, 0 otherwise (int)
+ */
+static int files_equal(const char *first_path, const char *second_path)
+{
+    static uint8_t first_chunk[CLI_BENCH_CHUNK_SIZE], second_chunk[CLI_BENCH_CHUNK_SIZE];
+    FILE *first = fopen(first_path, "r");
+    FILE *second = fopen(second_path, "r");
+    int equal = first != NULL && second != NULL;
+
+    while (equal)
+    {
+        size_t first_length = fread(first_chunk, 1, sizeof(first_chunk), first);
+        size_t second_length = fread(second_chunk, 1, sizeof(second_chunk), second);
+
+        if (first_length != second_length || memcmp(first_chunk, second_chunk, first_length) != 0)
+        {
+            equal = 0;
+        }
+
+        if (first_length == 0)
+        {
+            break;
+        }
+    }
+
+    if (first != NULL)
+    {
+        fclose(first);
+    }
+    if (second != NULL)
+    {
+        fclose(second);
+    }
+
+    return equal;
+}
+
+/**
+ * Function that reads the number of read/write system calls of an exited (not yet reaped) process from /proc/<pid>/io
+ *
+ * @param pid the process id (pid_t)
+ * @param run pointer to the run (struct cli_run)
+ */
+static void read_syscall_counts(pid_t pid, struct cli_run *run)
+{
+    char path[64];
+    char line[128];
+    snprintf(path, sizeof(path), "/proc/%d/io", (int)pid);
+
+    run->read_syscalls = 0;
+    run->write_syscalls = 0;
+
+    FILE *file = fopen(path, "r");
+
+    if (file == NULL) // not Linux, the counts are left at 0
+    {
+        return;
+    }
+
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        sscanf(line, "syscr: %llu", &run->read_syscalls);
+        sscanf(line, "syscw: %llu", &run->write_syscalls);
+    }
+
+    fclose(file);
+}
+
+/**
+ * Function that runs a command with stdin and stdout redirected to files and measures it
+ *
+ * @param arguments the command and its arguments, NULL terminated (char array array)
+ * @param input_path the path of the stdin file (char array)
+ * @param output_path the path of the stdout file (char array)
+ * @param run pointer to the measures (struct cli_run)
+ */
+static void run_command(const char *const *arguments, const char *input_path, const char *output_path, struct cli_run *run)
+{
+    double start = now_seconds();
+    pid_t pid = fork();
+
+    if (pid < 0)
+    {
+        perror("fork");
+        exit(1);
+    }
+
+    if (pid == 0)
+    {
+        int input = open(input_path, O_RDONLY);
+        int output = open(output_path, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+        int null = open("/dev/null", O_WRONLY);
+
+        if (input < 0 || output < 0 || dup2(input, STDIN_FILENO) < 0 || dup2(output, STDOUT_FILENO) < 0)
+        {
+            _exit(127);
+        }
+
+        // The errors of the command are dropped, the exit status is reported
+        if (null >= 0)
+        {
+            dup2(null, STDERR_FILENO);
+        }
+
+        execvp(arguments[0], (char *const *)arguments);
+        _exit(127);
+    }
+
+    // The process is left as a zombie so its /proc/<pid>/io can still be read
+    siginfo_t information;
+    waitid(P_PID, pid, &information, WEXITED | WNOWAIT);
+    run->wall_time = now_seconds() - start;
+    read_syscall_counts(pid, run);
+
+    int status;
+    struct rusage usage;
+    wait4(pid, &status, 0, &usage);
+
+    run->user_time = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6;
+    run->system_time = usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+    run->max_rss = usage.ru_maxrss;
+    run->exit_status = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+/**
+ * Function that prints the usage of the program
+ *
+ * @param program the name of the program (char array)
+ */
+static void usage(const char *program)
+{
+    fprintf(stderr, "Usage: %s [--max-size <bytes>] [--binary <e-des path>] [--csv <file>]\n", program);
+    exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t max_size = CLI_BENCH_MAX_SIZE;
+    const char *binary = "./e-des";
+    const char *csv_path = CLI_BENCH_CSV_PATH;
+
+    for (int argument = 1; argument < argc; argument++)
+    {
+        if (strcmp(argv[argument], "--max-size") == 0 && argument + 1 < argc)
+        {
+            max_size = strtoull(argv[++argument], NULL, 10);
+        }
+        else if (strcmp(argv[argument], "--binary") == 0 && argument + 1 < argc)
+        {
+            binary = argv[++argument];
+        }
+        else if (strcmp(argv[argument], "--csv") == 0 && argument + 1 < argc)
+        {
+            csv_path = argv[++argument];
+        }
+        else
+        {
+            usage(argv[0]);
+        }
+    }
+
+    if (max_size < CLI_BENCH_MIN_SIZE)
+    {
+        usage(argv[0]);
+    }
+
+    const struct cli_command commands[] = {
+        {"e-des", "e-des", {binary, "e-des", "-e", CLI_BENCH_PASSWORD, NULL}, {binary, "e-des", "-d", CLI_BENCH_PASSWORD, NULL}},
+        {"e-des", "des-ecb", {binary, "des-ecb", "-e", CLI_BENCH_PASSWORD, NULL}, {binary, "des-ecb", "-d", CLI_BENCH_PASSWORD, NULL}},
+        {"openssl", "des-ecb", {"openssl", "enc", "-des-ecb", "-provider", "legacy", "-provider", "default", "-K", CLI_BENCH_DES_KEY, NULL}, {"openssl", "enc", "-d", "-des-ecb", "-provider", "legacy", "-provider", "default", "-K", CLI_BENCH_DES_KEY, NULL}},
+        {"openssl", "aes-128-ecb", {"openssl", "enc", "-aes-128-ecb", "-K", CLI_BENCH_AES_KEY, NULL}, {"openssl", "enc", "-d", "-aes-128-ecb", "-K", CLI_BENCH_AES_KEY, NULL}},
+    };
+    size_t number_of_commands = sizeof(commands) / sizeof(commands[0]);
+
+    // Temporary directory for the generated files
+    const char *temporary_root = getenv("TMPDIR") != NULL ? getenv("TMPDIR") : "/tmp";
+    char directory[4096];
+    snprintf(directory, sizeof(directory), "%s/e-des-cli-bench-XXXXXX", temporary_root);
+
+    if (mkdtemp(directory) == NULL)
+    {
+        perror(directory);
+        exit(1);
+    }
+
+    char plaintext_path[4200], ciphertext_path[4200], decrypted_path[4200];
+    snprintf(plaintext_path, sizeof(plaintext_path), "%s/plaintext", directory);
+    snprintf(ciphertext_path, sizeof(ciphertext_path), "%s/ciphertext", directory);
+    snprintf(decrypted_path, sizeof(decrypted_path), "%s/decrypted", directory);
+
+    FILE *csv = fopen(csv_path, "w");
+
+    if (csv == NULL)
+    {
+        perror(csv_path);
+        exit(1);
+    }
+
+    fprintf(csv, "tool,mode,direction,bytes,wall_s,mb_per_s,user_s,sys_s,max_rss_kib,read_syscalls,write_syscalls,status\n");
+    printf("%-8s %-12s %-8s %12s %10s %10s %9s %9s %10s %10s %10s %s\n", "tool", "mode", "dir", "bytes", "wall (s)", "MB/s", "user (s)", "sys (s)", "RSS (KiB)", "reads", "writes", "status");
+
+    // The sweep always ends with the maximum size, even if it is not a power of the factor
+    for (size_t size = CLI_BENCH_MIN_SIZE; size <= max_size; size = size < max_size && size * CLI_BENCH_SIZE_FACTOR > max_size ? max_size : size * CLI_BENCH_SIZE_FACTOR)
+    {
+        generate_file(plaintext_path, size);
+
+        for (size_t command_index = 0; command_index < number_of_commands; command_index++)
+        {
+            const struct cli_command *command = &commands[command_index];
+
+            for (int direction = 0; direction < 2; direction++)
+            {
+                struct cli_run run;
+                const char *status;
+
+                if (direction == 0)
+                {
+                    run_command(command->encrypt_arguments, plaintext_path, ciphertext_path, &run);
+                    status = run.exit_status == 0 ? "ok" : "failed";
+                }
+                else
+                {
+                    run_command(command->decrypt_arguments, ciphertext_path, decrypted_path, &run);
+                    status = run.exit_status != 0 ? "failed" : files_equal(plaintext_path, decrypted_path) ? "ok" : "mismatch";
+                }
+
+                const char *direction_name = direction == 0 ? "encrypt" : "decrypt";
+                double throughput = run.wall_time > 0 ? size / run.wall_time / 1e6 : 0;
+
+                printf("%-8s %-12s %-8s %12zu %10.4f %10.2f %9.3f %9.3f %10ld %10llu %10llu %s\n", command->tool, command->mode, direction_name, size, run.wall_time, throughput, run.user_time, run.system_time, run.max_rss, run.read_syscalls, run.write_syscalls, status);
+                fprintf(csv, "%s,%s,%s,%zu,%.6f,%.2f,%.6f,%.6f,%ld,%llu,%llu,%s\n", command->tool, command->mode, direction_name, size, run.wall_time, throughput, run.user_time, run.system_time, run.max_rss, run.read_syscalls, run.write_syscalls, status);
+                fflush(stdout);
+
+                // A failed cipher leaves nothing to decipher
+                if (direction == 0 && run.exit_status != 0)
+                {
+                    break;
+                }
+            }
+        }
+    }
+
+    fclose(csv);
+
+    unlink(plaintext_path);
+    unlink(ciphertext_path);
+    unlink(decrypted_path);
+    rmdir(directory);
+
+    return 0;
+}
@@ -0,0 +1,771 @@
+#include "container.h"
+
+/**
+ * Struct that represents one chunk of a batch
+ *
+ * @param data the ciphertext/plaintext of the chunk (uint8_t array)
+ * @param length the length of the chunk (size_t)
+ * @param checksum the CRC-32 of the ciphertext (uint32_t)
+ * @param corrupted set by the reader when the checksum does not match (int)
+ */
+struct container_chunk
+{
+    uint8_t *data;
+    size_t length;
+    uint32_t checksum;
+    int corrupted;
+};
+
+/**
+ * Struct that represents the arguments of a batch job, one task per chunk
+ *
+ * @param chunks the chunks of the batch (struct container_chunk array)
+ * @param function the function that ciphers/deciphers whole blocks (block_cipher_function)
+ * @param key the key material given to the function
+ * @param deciphering 1 to check and decipher the chunks, 0 to cipher them and compute their checksum (int)
+ */
+struct container_job
+{
+    struct container_chunk *chunks;
+    block_cipher_function function;
+    const void *key;
+    int deciphering;
+};
+
+static uint32_t crc32_table[256];
+static pthread_once_t crc32_table_once = PTHREAD_ONCE_INIT;
+
+/**
+ * Function that fills the CRC-32 table (reflected polynomial 0xEDB88320), it runs once (pthread_once)
+ */
+static void build_crc32_table(void)
+{
+    for (uint32_t byte = 0; byte < 256; byte++)
+    {
+        uint32_t value = byte;
+
+        for (int bit = 0; bit < 8; bit++)
+        {
+            value = (value >> 1) ^ (value & 1 ? 0xEDB88320u : 0);
+        }
+
+        crc32_table[byte] = value;
+    }
+}
+
+/**
+ * Function that stores a little-endian number
+ *
+ * @param bytes the bytes (uint8_t array)
+ * @param value the number (uint64_t)
+ * @param size the number of bytes (int)
+ */
+static void store_little_endian(uint8_t *bytes, uint64_t value, int size)
+{
+    for (int byte = 0; byte < size; byte++)
+    {
+        bytes[byte] = (uint8_t)(value >> (8 * byte));
+    }
+}
+
+/**
+ * Function that loads a little-endian number
+ *
+ * @param bytes the bytes (uint8_t array)
+ * @param size the number of bytes (int)
+ *
+ * @return the number (uint64_t)
+ */
+static uint64_t load_little_endian(const uint8_t *bytes, int size)
+{
+    uint64_t value = 0;
+
+    for (int byte = size - 1; byte >= 0; byte--)
+    {
+        value = (value << 8) | bytes[byte];
+    }
+
+    return value;
+}
+
+/**
+ * Function that writes bytes to the output stream
+ *
+ * @param output the output stream (FILE)
+ * @param bytes the bytes (uint8_t array)
+ * @param size the number of bytes (size_t)
+ *
+ * @return EDES_OK or EDES_ERROR_IO
+ */
+static int write_exactly(FILE *output, const uint8_t *bytes, size_t size)
+{
+    if (fwrite(bytes, sizeof(uint8_t), size, output) != size)
+    {
+        return EDES_ERROR_IO;
+    }
+
+    return EDES_OK;
+}
+
+/**
+ * Function that reads bytes from the input stream
+ *
+ * @param input the input stream (FILE)
+ * @param bytes the bytes (uint8_t array)
+ * @param size the number of bytes (size_t)
+ *
+ * @return EDES_OK, EDES_ERROR_IO, or EDES_ERROR_CORRUPTED if the container ends before them
+ */
+static int read_exactly(FILE *input, uint8_t *bytes, size_t size)
+{
+    if (fread(bytes, sizeof(uint8_t), size, input) != size)
+    {
+        return ferror(input) ? EDES_ERROR_IO : EDES_ERROR_CORRUPTED;
+    }
+
+    return EDES_OK;
+}
+
+/**
+ * Function that serializes an index entry
+ *
+ * @param bytes the CONTAINER_INDEX_ENTRY_SIZE bytes (uint8_t array)
+ * @param entry the entry (struct container_index_entry)
+ */
+static void store_index_entry(uint8_t *bytes, const struct container_index_entry *entry)
+{
+    store_little_endian(bytes, entry->offset, 8);
+    store_little_endian(bytes + 8, entry->length, 4);
+    store_little_endian(bytes + 12, entry->checksum, 4);
+}
+
+/**
+ * Function that deserializes an index entry
+ *
+ * @param bytes the CONTAINER_INDEX_ENTRY_SIZE bytes (uint8_t array)
+ * @param entry pointer to the entry (struct container_index_entry)
+ */
+static void load_index_entry(const uint8_t *bytes, struct container_index_entry *entry)
+{
+    entry->offset = load_little_endian(bytes, 8);
+    entry->length = (uint32_t)load_little_endian(bytes + 8, 4);
+    entry->checksum = (uint32_t)load_little_endian(bytes + 12, 4);
+}
+
+/**
+ * Function that appends an entry to the index, growing it when needed
+ *
+ * @param entries pointer to the index (struct container_index_entry array)
+ * @param number_of_entries pointer to the number of entries (size_t)
+ * @param capacity pointer to the capacity of the index (size_t)
+ * @param entry the entry (struct container_index_entry)
+ *
+ * @return EDES_OK or EDES_ERROR_OUT_OF_MEMORY, the index is left as it was on error
+ */
+static int append_index_entry(struct container_index_entry **entries, size_t *number_of_entries, size_t *capacity, const struct container_index_entry *entry)
+{
+    if (*number_of_entries == *capacity)
+    {
+        size_t new_capacity = *capacity == 0 ? 64 : *capacity * 2;
+        struct container_index_entry *new_entries = (struct container_index_entry *)realloc(*entries, new_capacity * sizeof(struct container_index_entry));
+
+        if (new_entries == NULL) // memory allocation error
+        {
+            return EDES_ERROR_OUT_OF_MEMORY;
+        }
+
+        *entries = new_entries;
+        *capacity = new_capacity;
+    }
+
+    (*entries)[(*number_of_entries)++] = *entry;
+
+    return EDES_OK;
+}
+
+/**
+ * Task of a batch job, it ciphers one chunk and computes its checksum, or checks the checksum of one chunk and deciphers it
+ *
+ * @param argument the job (struct container_job)
+ * @param task_index the index of the chunk in the batch (size_t)
+ */
+static void process_chunk(void *argument, size_t task_index)
+{
+    struct container_job *job = (struct container_job *)argument;
+    struct container_chunk *chunk = &job->chunks[task_index];
+
+    if (job->deciphering)
+    {
+        if (container_crc32(chunk->data, chunk->length) != chunk->checksum)
+        {
+            chunk->corrupted = 1;
+            return;
+        }
+
+        job->function(chunk->data, chunk->length, job->key);
+    }
+    else
+    {
+        job->function(chunk->data, chunk->length, job->key);
+        chunk->checksum = container_crc32(chunk->data, chunk->length);
+    }
+}
+
+/**
+ * Function that runs a batch job on the thread pool, or on the calling thread when there is no pool
+ *
+ * @param pool the thread pool, NULL for none (struct thread_pool)
+ * @param job the job (struct container_job)
+ * @param number_of_chunks the number of chunks of the batch (size_t)
+ */
+static void run_batch(struct thread_pool *pool, struct container_job *job, size_t number_of_chunks)
+{
+    if (pool == NULL)
+    {
+        for (size_t chunk = 0; chunk < number_of_chunks; chunk++)
+        {
+            process_chunk(job, chunk);
+        }
+        return;
+    }
+
+    thread_pool_run(pool, process_chunk, job, number_of_chunks);
+}
+
+/**
+ * Function that allocates the chunk buffers of a batch
+ *
+ * @param pool the thread pool, NULL for none (struct thread_pool)
+ * @param chunk_size the size of each chunk (size_t)
+ * @param batch_size pointer to the number of chunks of a batch (size_t)
+ * @param chunks pointer to the chunks (struct container_chunk array)
+ * @param buffers pointer to the buffers of the chunks (uint8_t array)
+ *
+ * @return EDES_OK or EDES_ERROR_OUT_OF_MEMORY
+ */
+static int allocate_batch(struct thread_pool *pool, size_t chunk_size, size_t *batch_size, struct container_chunk **chunks, uint8_t **buffers)
+{
+    *batch_size = pool == NULL ? 1 : pool->number_of_threads * CONTAINER_CHUNKS_PER_THREAD;
+
+    *buffers = (uint8_t *)malloc(*batch_size * chunk_size);
+    *chunks = (struct container_chunk *)calloc(*batch_size, sizeof(struct container_chunk));
+
+    if (*buffers == NULL || *chunks == NULL) // memory allocation error
+    {
+        free(*buffers);
+        free(*chunks);
+        return EDES_ERROR_OUT_OF_MEMORY;
+    }
+
+    return EDES_OK;
+}
+
+uint32_t container_crc32(const uint8_t *data, size_t size)
+{
+    pthread_once(&crc32_table_once, build_crc32_table);
+
+    uint32_t crc = 0xFFFFFFFFu;
+
+    for (size_t index = 0; index < size; index++)
+    {
+        crc = (crc >> 8) ^ crc32_table[(crc ^ data[index]) & 0xFF];
+    }
+
+    return crc ^ 0xFFFFFFFFu;
+}
+
+void container_key_check_value(block_cipher_function cipher, const void *key, uint8_t *key_check_value)
+{
+    memset(key_check_value, 0, BLOCK_SIZE);
+    cipher(key_check_value, BLOCK_SIZE, key);
+}
+
+int container_encrypt(FILE *input, FILE *output, block_cipher_function cipher, const void *key, const uint8_t *key_check_value, struct thread_pool *pool, size_t chunk_size)
+{
+    size_t batch_size;
+    struct container_chunk *chunks;
+    uint8_t *buffers;
+    int status = allocate_batch(pool, chunk_size, &batch_size, &chunks, &buffers);
+
+    if (status != EDES_OK)
+    {
+        return status;
+    }
+
+    struct container_index_entry *entries = NULL;
+    size_t number_of_entries = 0;
+    size_t capacity = 0;
+
+    // Header
+    uint8_t header[CONTAINER_HEADER_SIZE];
+    memcpy(header, CONTAINER_MAGIC, CONTAINER_MAGIC_SIZE);
+    store_little_endian(header + CONTAINER_MAGIC_SIZE, CONTAINER_VERSION, 4);
+    store_little_endian(header + CONTAINER_MAGIC_SIZE + 4, chunk_size, 4);
+    memcpy(header + CONTAINER_MAGIC_SIZE + 8, key_check_value, BLOCK_SIZE);
+    status = write_exactly(output, header, CONTAINER_HEADER_SIZE);
+
+    uint64_t offset = CONTAINER_HEADER_SIZE;
+    uint64_t plaintext_size = 0;
+    int is_final_chunk = 0;
+
+    struct container_job job;
+    job.chunks = chunks;
+    job.function = cipher;
+    job.key = key;
+    job.deciphering = 0;
+
+    while (status == EDES_OK && !is_final_chunk)
+    {
+        // Read a batch, only the last chunk of the input is shorter than chunk_size and padded
+        size_t number_of_chunks = 0;
+
+        while (number_of_chunks < batch_size && !is_final_chunk)
+        {
+            struct container_chunk *chunk = &chunks[number_of_chunks++];
+            chunk->data = buffers + (number_of_chunks - 1) * chunk_size;
+            chunk->length = fread(chunk->data, sizeof(uint8_t), chunk_size, input);
+
+            if (ferror(input))
+            {
+                status = EDES_ERROR_IO;
+                break;
+            }
+
+            plaintext_size += chunk->length;
+
+            if (chunk->length < chunk_size)
+            {
+                chunk->length = apply_padding(chunk->data, chunk->length);
+                is_final_chunk = 1;
+            }
+        }
+
+        if (status != EDES_OK)
+        {
+            break;
+        }
+
+        // The chunks are ciphered in any order and committed in order
+        run_batch(pool, &job, number_of_chunks);
+
+        for (size_t chunk_index = 0; status == EDES_OK && chunk_index < number_of_chunks; chunk_index++)
+        {
+            struct container_chunk *chunk = &chunks[chunk_index];
+            struct container_index_entry entry = {offset, (uint32_t)chunk->length, chunk->checksum};
+            uint8_t chunk_header[CONTAINER_CHUNK_HEADER_SIZE];
+
+            store_little_endian(chunk_header, number_of_entries, 4);
+            store_little_endian(chunk_header + 4, chunk->length, 4);
+            store_little_endian(chunk_header + 8, is_final_chunk && chunk_index == number_of_chunks - 1 ? CONTAINER_FLAG_FINAL : 0, 4);
+            store_little_endian(chunk_header + 12, chunk->checksum, 4);
+
+            status = write_exactly(output, chunk_header, CONTAINER_CHUNK_HEADER_SIZE);
+
+            if (status == EDES_OK)
+            {
+                status = write_exactly(output, chunk->data, chunk->length);
+            }
+
+            if (status == EDES_OK)
+            {
+                status = append_index_entry(&entries, &number_of_entries, &capacity, &entry);
+            }
+
+            offset += CONTAINER_CHUNK_HEADER_SIZE + chunk->length;
+        }
+    }
+
+    // Index and footer
+    for (size_t entry_index = 0; status == EDES_OK && entry_index < number_of_entries; entry_index++)
+    {
+        uint8_t entry_bytes[CONTAINER_INDEX_ENTRY_SIZE];
+
+        store_index_entry(entry_bytes, &entries[entry_index]);
+        status = write_exactly(output, entry_bytes, CONTAINER_INDEX_ENTRY_SIZE);
+    }
+
+    if (status == EDES_OK)
+    {
+        uint8_t footer[CONTAINER_FOOTER_SIZE];
+        store_little_endian(footer, offset, 8);
+        store_little_endian(footer + 8, number_of_entries, 8);
+        store_little_endian(footer + 16, plaintext_size, 8);
+        memcpy(footer + 24, CONTAINER_INDEX_MAGIC, CONTAINER_MAGIC_SIZE);
+        status = write_exactly(output, footer, CONTAINER_FOOTER_SIZE);
+    }
+
+    free(entries);
+    free(chunks);
+    free(buffers);
+
+    return status;
+}
+
+int container_decrypt(FILE *input, FILE *output, block_cipher_function decipher, const void *key, const uint8_t *key_check_value, struct thread_pool *pool)
+{
+    // Header
+    uint8_t header[CONTAINER_HEADER_SIZE];
+    int status = read_exactly(input, header, CONTAINER_HEADER_SIZE);
+
+    if (status != EDES_OK)
+    {
+        return status;
+    }
+
+    uint64_t version = load_little_endian(header + CONTAINER_MAGIC_SIZE, 4);
+    size_t chunk_size = (size_t)load_little_endian(header + CONTAINER_MAGIC_SIZE + 4, 4);
+
+    if (memcmp(header, CONTAINER_MAGIC, CONTAINER_MAGIC_SIZE) != 0 || version != CONTAINER_VERSION || chunk_size == 0 || chunk_size % BLOCK_SIZE != 0 || chunk_size > CONTAINER_MAX_CHUNK_SIZE)
+    {
+        return EDES_ERROR_CORRUPTED;
+    }
+
+    if (memcmp(header + CONTAINER_MAGIC_SIZE + 8, key_check_value, BLOCK_SIZE) != 0)
+    {
+        return EDES_ERROR_KEY_MISMATCH;
+    }
+
+    size_t batch_size;
+    struct container_chunk *chunks;
+    uint8_t *buffers;
+    status = allocate_batch(pool, chunk_size, &batch_size, &chunks, &buffers);
+
+    if (status != EDES_OK)
+    {
+        return status;
+    }
+
+    struct container_index_entry *entries = NULL;
+    size_t number_of_entries = 0;
+    size_t capacity = 0;
+
+    uint64_t offset = CONTAINER_HEADER_SIZE;
+    uint64_t plaintext_size = 0;
+    int is_final_chunk = 0;
+
+    struct container_job job;
+    job.chunks = chunks;
+    job.function = decipher;
+    job.key = key;
+    job.deciphering = 1;
+
+    while (status == EDES_OK && !is_final_chunk)
+    {
+        // Read a batch, the memory used is bounded by the batch whatever the container size
+        size_t number_of_chunks = 0;
+
+        while (status == EDES_OK && number_of_chunks < batch_size && !is_final_chunk)
+        {
+            uint8_t chunk_header[CONTAINER_CHUNK_HEADER_SIZE];
+            status = read_exactly(input, chunk_header, CONTAINER_CHUNK_HEADER_SIZE);
+
+            if (status != EDES_OK)
+            {
+                break;
+            }
+
+            uint64_t sequence = load_little_endian(chunk_header, 4);
+            size_t length = (size_t)load_little_endian(chunk_header + 4, 4);
+            uint64_t flags = load_little_endian(chunk_header + 8, 4);
+
+            is_final_chunk = (flags & CONTAINER_FLAG_FINAL) != 0;
+
+            if (sequence != (uint32_t)number_of_entries || length == 0 || length % BLOCK_SIZE != 0 || length > chunk_size || (!is_final_chunk && length != chunk_size))
+            {
+                status = EDES_ERROR_CORRUPTED;
+                break;
+            }
+
+            struct container_chunk *chunk = &chunks[number_of_chunks++];
+            chunk->data = buffers + (number_of_chunks - 1) * chunk_size;
+            chunk->length = length;
+            chunk->checksum = (uint32_t)load_little_endian(chunk_header + 12, 4);
+            chunk->corrupted = 0;
+            status = read_exactly(input, chunk->data, length);
+
+            if (status == EDES_OK)
+            {
+                struct container_index_entry entry = {offset, (uint32_t)length, chunk->checksum};
+                status = append_index_entry(&entries, &number_of_entries, &capacity, &entry);
+                offset += CONTAINER_CHUNK_HEADER_SIZE + length;
+            }
+        }
+
+        if (status != EDES_OK)
+        {
+            break;
+        }
+
+        run_batch(pool, &job, number_of_chunks);
+
+        for (size_t chunk_index = 0; status == EDES_OK && chunk_index < number_of_chunks; chunk_index++)
+        {
+            struct container_chunk *chunk = &chunks[chunk_index];
+
+            if (chunk->corrupted)
+            {
+                status = EDES_ERROR_CORRUPTED;
+                break;
+            }
+
+            size_t length = chunk->length;
+
+            if (is_final_chunk && chunk_index == number_of_chunks - 1)
+            {
+                length -= get_padding_size(chunk->data, length);
+            }
+
+            status = write_exactly(output, chunk->data, length);
+            plaintext_size += length;
+        }
+    }
+
+    // Index and footer, they must describe the chunks that were read
+    for (size_t entry_index = 0; status == EDES_OK && entry_index < number_of_entries; entry_index++)
+    {
+        uint8_t entry_bytes[CONTAINER_INDEX_ENTRY_SIZE];
+        struct container_index_entry entry;
+
+        status = read_exactly(input, entry_bytes, CONTAINER_INDEX_ENTRY_SIZE);
+        load_index_entry(entry_bytes, &entry);
+
+        if (status == EDES_OK && (entry.offset != entries[entry_index].offset || entry.length != entries[entry_index].length || entry.checksum != entries[entry_index].checksum))
+        {
+            status = EDES_ERROR_CORRUPTED;
+        }
+    }
+
+    if (status == EDES_OK)
+    {
+        uint8_t footer[CONTAINER_FOOTER_SIZE];
+        status = read_exactly(input, footer, CONTAINER_FOOTER_SIZE);
+
+        if (status == EDES_OK && (load_little_endian(footer, 8) != offset || load_little_endian(footer + 8, 8) != number_of_entries || load_little_endian(footer + 16, 8) != plaintext_size ||
+                                  memcmp(footer + 24, CONTAINER_INDEX_MAGIC, CONTAINER_MAGIC_SIZE) != 0))
+        {
+            status = EDES_ERROR_CORRUPTED;
+        }
+    }
+
+    free(entries);
+    free(chunks);
+    free(buffers);
+
+    return status;
+}
+
+/**
+ * Function that reads exactly size bytes at the given offset of a file (pread), retrying the short reads
+ *
+ * @param file_descriptor the file descriptor (int)
+ * @param bytes the bytes (uint8_t array)
+ * @param size the number of bytes (size_t)
+ * @param offset the offset in the file (uint64_t)
+ *
+ * @return EDES_OK, or EDES_ERROR_IO on error or end of file
+ */
+static int read_exactly_at(int file_descriptor, uint8_t *bytes, size_t size, uint64_t offset)
+{
+    while (size > 0)
+    {
+        ssize_t number_of_readed_bytes = pread(file_descriptor, bytes, size, (off_t)offset);
+
+        if (number_of_readed_bytes <= 0)
+        {
+            return EDES_ERROR_IO;
+        }
+
+        bytes += number_of_readed_bytes;
+        size -= (size_t)number_of_readed_bytes;
+        offset += (uint64_t)number_of_readed_bytes;
+    }
+
+    return EDES_OK;
+}
+
+int container_read_index(int file_descriptor, struct container_info *info, struct container_index_entry **entries)
+{
+    struct stat file_status;
+    uint8_t header[CONTAINER_HEADER_SIZE];
+    uint8_t footer[CONTAINER_FOOTER_SIZE];
+
+    *entries = NULL;
+
+    if (fstat(file_descriptor, &file_status) != 0)
+    {
+        return EDES_ERROR_IO;
+    }
+
+    uint64_t file_size = (uint64_t)file_status.st_size;
+
+    if (file_size < CONTAINER_HEADER_SIZE + CONTAINER_FOOTER_SIZE)
+    {
+        return EDES_ERROR_CORRUPTED;
+    }
+
+    if (read_exactly_at(file_descriptor, header, CONTAINER_HEADER_SIZE, 0) != EDES_OK || read_exactly_at(file_descriptor, footer, CONTAINER_FOOTER_SIZE, file_size - CONTAINER_FOOTER_SIZE) != EDES_OK)
+    {
+        return EDES_ERROR_IO;
+    }
+
+    uint64_t index_offset = load_little_endian(footer, 8);
+    info->number_of_chunks = load_little_endian(footer + 8, 8);
+    info->plaintext_size = load_little_endian(footer + 16, 8);
+    info->chunk_size = (uint32_t)load_little_endian(header + CONTAINER_MAGIC_SIZE + 4, 4);
+    memcpy(info->key_check_value, header + CONTAINER_MAGIC_SIZE + 8, BLOCK_SIZE);
+
+    // The index must sit right before the footer
+    if (memcmp(header, CONTAINER_MAGIC, CONTAINER_MAGIC_SIZE) != 0 || memcmp(footer + 24, CONTAINER_INDEX_MAGIC, CONTAINER_MAGIC_SIZE) != 0 ||
+        load_little_endian(header + CONTAINER_MAGIC_SIZE, 4) != CONTAINER_VERSION || info->number_of_chunks == 0 ||
+        info->chunk_size == 0 || info->chunk_size % BLOCK_SIZE != 0 || info->chunk_size > CONTAINER_MAX_CHUNK_SIZE ||
+        index_offset < CONTAINER_HEADER_SIZE || index_offset > file_size - CONTAINER_FOOTER_SIZE ||
+        (file_size - CONTAINER_FOOTER_SIZE - index_offset) / CONTAINER_INDEX_ENTRY_SIZE != info->number_of_chunks ||
+        (file_size - CONTAINER_FOOTER_SIZE - index_offset) % CONTAINER_INDEX_ENTRY_SIZE != 0)
+    {
+        return EDES_ERROR_CORRUPTED;
+    }
+
+    size_t index_size = (size_t)(info->number_of_chunks * CONTAINER_INDEX_ENTRY_SIZE);
+    uint8_t *index_bytes = (uint8_t *)malloc(index_size);
+    *entries = (struct container_index_entry *)malloc((size_t)info->number_of_chunks * sizeof(struct container_index_entry));
+
+    if (index_bytes == NULL || *entries == NULL) // memory allocation error
+    {
+        free(index_bytes);
+        free(*entries);
+        *entries = NULL;
+        return EDES_ERROR_OUT_OF_MEMORY;
+    }
+
+    if (read_exactly_at(file_descriptor, index_bytes, index_size, index_offset) != EDES_OK)
+    {
+        free(index_bytes);
+        free(*entries);
+        *entries = NULL;
+        return EDES_ERROR_IO;
+    }
+
+    // The chunks must follow each other from the header to the index, all full but the last one
+    uint64_t offset = CONTAINER_HEADER_SIZE;
+    uint64_t last_chunk = info->number_of_chunks - 1;
+    int status = EDES_OK;
+
+    for (uint64_t entry_index = 0; entry_index < info->number_of_chunks; entry_index++)
+    {
+        struct container_index_entry *entry = &(*entries)[entry_index];
+
+        load_index_entry(index_bytes + entry_index * CONTAINER_INDEX_ENTRY_SIZE, entry);
+
+        if (entry->offset != offset || entry->length == 0 || entry->length % BLOCK_SIZE != 0 || entry->length > info->chunk_size ||
+            (entry_index != last_chunk && entry->length != info->chunk_size))
+        {
+            status = EDES_ERROR_CORRUPTED;
+            break;
+        }
+
+        offset += CONTAINER_CHUNK_HEADER_SIZE + entry->length;
+    }
+
+    // The padding of the last chunk is 1 to BLOCK_SIZE bytes
+    uint64_t padded_size = last_chunk * info->chunk_size + (*entries)[last_chunk].length;
+
+    if (status == EDES_OK && (offset != index_offset || info->plaintext_size >= padded_size || info->plaintext_size + BLOCK_SIZE < padded_size))
+    {
+        status = EDES_ERROR_CORRUPTED;
+    }
+
+    free(index_bytes);
+
+    if (status != EDES_OK)
+    {
+        free(*entries);
+        *entries = NULL;
+    }
+
+    return status;
+}
+
+int container_decrypt_range(int file_descriptor, FILE *output, block_cipher_function decipher, const void *key, const uint8_t *key_check_value, uint64_t offset, uint64_t length)
+{
+    struct container_info info;
+    struct container_index_entry *entries;
+    int status = container_read_index(file_descriptor, &info, &entries);
+
+    if (status != EDES_OK)
+    {
+        return status;
+    }
+
+    if (memcmp(info.key_check_value, key_check_value, BLOCK_SIZE) != 0)
+    {
+        free(entries);
+        return EDES_ERROR_KEY_MISMATCH;
+    }
+
+    // The range is clipped to the plaintext
+    uint64_t end = offset < info.plaintext_size && length < info.plaintext_size - offset ? offset + length : info.plaintext_size;
+    uint8_t *buffer = NULL;
+
+    if (offset < end && (buffer = (uint8_t *)malloc(CONTAINER_CHUNK_HEADER_SIZE + info.chunk_size)) == NULL) // memory allocation error
+    {
+        free(entries);
+        return EDES_ERROR_OUT_OF_MEMORY;
+    }
+
+    // Only the chunks that cover the range are read
+    for (uint64_t chunk_index = offset < end ? offset / info.chunk_size : info.number_of_chunks; chunk_index < info.number_of_chunks && chunk_index * info.chunk_size < end; chunk_index++)
+    {
+        const struct container_index_entry *entry = &entries[chunk_index];
+        int is_final_chunk = chunk_index == info.number_of_chunks - 1;
+
+        status = read_exactly_at(file_descriptor, buffer, CONTAINER_CHUNK_HEADER_SIZE + entry->length, entry->offset);
+
+        if (status != EDES_OK)
+        {
+            break;
+        }
+
+        // The chunk header must agree with the index
+        uint8_t *data = buffer + CONTAINER_CHUNK_HEADER_SIZE;
+
+        if (load_little_endian(buffer, 4) != (uint32_t)chunk_index || load_little_endian(buffer + 4, 4) != entry->length ||
+            ((load_little_endian(buffer + 8, 4) & CONTAINER_FLAG_FINAL) != 0) != is_final_chunk ||
+            load_little_endian(buffer + 12, 4) != entry->checksum || container_crc32(data, entry->length) != entry->checksum)
+        {
+            status = EDES_ERROR_CORRUPTED;
+            break;
+        }
+
+        decipher(data, entry->length, key);
+
+        uint64_t chunk_start = chunk_index * info.chunk_size;
+        uint64_t chunk_end = chunk_start + entry->length;
+
+        if (is_final_chunk)
+        {
+            chunk_end -= get_padding_size(data, entry->length);
+
+            // The footer must agree with the padding
+            if (chunk_end != info.plaintext_size)
+            {
+                status = EDES_ERROR_CORRUPTED;
+                break;
+            }
+        }
+
+        size_t first = (size_t)(offset > chunk_start ? offset - chunk_start : 0);
+        size_t last = (size_t)((end < chunk_end ? end : chunk_end) - chunk_start);
+
+        status = write_exactly(output, data + first, last - first);
+
+        if (status != EDES_OK)
+        {
+            break;
+        }
+    }
+
+    free(buffer);
+    free(entries);
+
+    return status;
+}
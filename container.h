@@ -0,0 +1,149 @@
+#ifndef __CONTAINER_H__
+#define __CONTAINER_H__
+
+/**
+ * @file container.h
+ * @brief Chunked and indexed container format of the ECB modes
+ *
+ * This file contains an optional container around the ECB ciphertext, so it can be processed in parallel while it is still arriving, checked for corruption and truncation, and read from any chunk.
+ * All the numbers are little-endian:
+ *  - header: the magic "EDESCONT", the version (u32), the chunk size (u32) and the key check value (the cipher of a zero block, 8 bytes);
+ *  - chunks: the sequence number (u32), the ciphertext length (u32), the flags (u32, CONTAINER_FLAG_FINAL on the last chunk) and the CRC-32 of the ciphertext (u32), then the ciphertext.
+ *    Every chunk but the last one holds chunk size bytes, only the last one is padded, so each chunk can be deciphered on its own;
+ *  - index: the offset (u64), length (u32) and CRC-32 (u32) of every chunk;
+ *  - footer: the offset of the index (u64), the number of chunks (u64), the plaintext size (u64) and the magic "EDESINDX".
+ *
+ * The writer ciphers a batch of chunks on the thread pool (in any order) and commits them in order, the reader does the same with bounded memory and checks the index at the end.
+ * A container file can also be read from its index, only the chunks that cover a range of the plaintext are read (container_decrypt_range).
+ *
+ * @author Ana Vidal (118408)
+ * @author Simão Andrade (118345)
+ * @date 2023-10-20
+ */
+
+#include "implementation.h"
+#include "parallel.h"
+
+// Constants for the container format
+#define CONTAINER_MAGIC "EDESCONT"
+#define CONTAINER_INDEX_MAGIC "EDESINDX"
+#define CONTAINER_MAGIC_SIZE 8
+#define CONTAINER_VERSION 1
+#define CONTAINER_CHUNK_SIZE (1024 * 1024) // 1MiB of plaintext per chunk, must be a multiple of BLOCK_SIZE
+#define CONTAINER_MAX_CHUNK_SIZE (256 * 1024 * 1024) // bigger chunk sizes are rejected by the reader
+#define CONTAINER_HEADER_SIZE (CONTAINER_MAGIC_SIZE + 4 + 4 + BLOCK_SIZE) // 24 bytes
+#define CONTAINER_CHUNK_HEADER_SIZE 16
+#define CONTAINER_INDEX_ENTRY_SIZE 16
+#define CONTAINER_FOOTER_SIZE (8 + 8 + 8 + CONTAINER_MAGIC_SIZE) // 32 bytes
+#define CONTAINER_FLAG_FINAL 1
+#define CONTAINER_CHUNKS_PER_THREAD 2 // chunks in flight per thread of the pool
+
+/**
+ * Struct that represents one entry of the index of a container
+ *
+ * @param offset the offset of the chunk header in the container (uint64_t)
+ * @param length the ciphertext length of the chunk (uint32_t)
+ * @param checksum the CRC-32 of the ciphertext of the chunk (uint32_t)
+ */
+struct container_index_entry
+{
+    uint64_t offset;
+    uint32_t length;
+    uint32_t checksum;
+};
+
+/**
+ * Struct that represents the header and footer of a container
+ *
+ * @param chunk_size the plaintext size of every chunk but the last one (uint32_t)
+ * @param key_check_value the cipher of a zero block (uint8_t array)
+ * @param number_of_chunks the number of chunks (uint64_t)
+ * @param plaintext_size the plaintext size (uint64_t)
+ */
+struct container_info
+{
+    uint32_t chunk_size;
+    uint8_t key_check_value[BLOCK_SIZE];
+    uint64_t number_of_chunks;
+    uint64_t plaintext_size;
+};
+
+/**
+ * Function that computes the CRC-32 (IEEE) of a buffer
+ *
+ * @param data the buffer (uint8_t array)
+ * @param size the size of the buffer (size_t)
+ *
+ * @return the CRC-32 (uint32_t)
+ */
+uint32_t container_crc32(const uint8_t *data, size_t size);
+
+/**
+ * Function that computes the key check value stored in the header, the cipher of a zero block
+ *
+ * @param cipher the function that ciphers whole blocks, not the parallel wrapper (block_cipher_function)
+ * @param key the key material given to the cipher function
+ * @param key_check_value the key check value, BLOCK_SIZE bytes (uint8_t array)
+ */
+void container_key_check_value(block_cipher_function cipher, const void *key, uint8_t *key_check_value);
+
+/**
+ * Container Encrypt Function, reads the plaintext in chunks of chunk_size bytes and writes the header, the ciphered chunks, the index and the footer
+ *
+ * @param input the input stream (FILE)
+ * @param output the output stream (FILE)
+ * @param cipher the function that ciphers whole blocks (block_cipher_function)
+ * @param key the key material given to the cipher function
+ * @param key_check_value the key check value (uint8_t array)
+ * @param pool the thread pool that ciphers the chunks of a batch, NULL for none (struct thread_pool)
+ * @param chunk_size the plaintext size of the chunks, non-zero multiple of BLOCK_SIZE (size_t)
+ *
+ * @return EDES_OK, EDES_ERROR_OUT_OF_MEMORY or EDES_ERROR_IO
+ */
+int container_encrypt(FILE *input, FILE *output, block_cipher_function cipher, const void *key, const uint8_t *key_check_value, struct thread_pool *pool, size_t chunk_size);
+
+/**
+ * Container Decrypt Function, reads the container chunk by chunk, checks and deciphers them and writes the plaintext, it stops with an error if the key check value,
+ * a checksum, the order of the chunks or the index do not match, or if the container is truncated
+ *
+ * @param input the input stream (FILE)
+ * @param output the output stream (FILE)
+ * @param decipher the function that deciphers whole blocks (block_cipher_function)
+ * @param key the key material given to the decipher function
+ * @param key_check_value the key check value of the password (uint8_t array)
+ * @param pool the thread pool that deciphers the chunks of a batch, NULL for none (struct thread_pool)
+ *
+ * @return EDES_OK, EDES_ERROR_KEY_MISMATCH, EDES_ERROR_CORRUPTED, EDES_ERROR_OUT_OF_MEMORY or EDES_ERROR_IO
+ */
+int container_decrypt(FILE *input, FILE *output, block_cipher_function decipher, const void *key, const uint8_t *key_check_value, struct thread_pool *pool);
+
+/**
+ * Function that reads the header, the footer and the index of a container file, so its chunks can be read in any order (pread at entries[i].offset)
+ *
+ * The index is checked against the header and the footer: the chunks must follow each other from the header up to the index offset, all of chunk_size bytes but the last one,
+ * and the plaintext size must fit the padding of the last chunk
+ *
+ * @param file_descriptor the container file, must support pread (int)
+ * @param info pointer to the header and footer (struct container_info)
+ * @param entries pointer to the index, allocated with malloc (struct container_index_entry array)
+ *
+ * @return EDES_OK, EDES_ERROR_CORRUPTED if the file is not a valid container, EDES_ERROR_OUT_OF_MEMORY or EDES_ERROR_IO
+ */
+int container_read_index(int file_descriptor, struct container_info *info, struct container_index_entry **entries);
+
+/**
+ * Container Range Decrypt Function, reads the index of a container file and writes the plaintext from offset, only the chunks that cover the range are read (pread), checked and deciphered
+ *
+ * @param file_descriptor the container file, must support pread (int)
+ * @param output the output stream (FILE)
+ * @param decipher the function that deciphers whole blocks (block_cipher_function)
+ * @param key the key material given to the decipher function
+ * @param key_check_value the key check value of the password (uint8_t array)
+ * @param offset the offset in the plaintext (uint64_t)
+ * @param length the number of plaintext bytes, clipped to the end of the plaintext (uint64_t)
+ *
+ * @return EDES_OK, EDES_ERROR_KEY_MISMATCH, EDES_ERROR_CORRUPTED, EDES_ERROR_OUT_OF_MEMORY or EDES_ERROR_IO
+ */
+int container_decrypt_range(int file_descriptor, FILE *output, block_cipher_function decipher, const void *key, const uint8_t *key_check_value, uint64_t offset, uint64_t length);
+
+#endif
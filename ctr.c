@@ -0,0 +1,365 @@
+#include "ctr.h"
+#include "stats.h"
+
+/**
+ * Struct that represents the arguments of a ctr_crypt_parallel job
+ *
+ * @param key the key material (struct ctr_key)
+ * @param offset the byte offset of the data in the stream (uint64_t)
+ * @param data the data (uint8_t array)
+ * @param size the size of the data (size_t)
+ */
+struct ctr_job
+{
+    const struct ctr_key *key;
+    uint64_t offset;
+    uint8_t *data;
+    size_t size;
+};
+
+/**
+ * Function that loads a big-endian 64-bit number
+ *
+ * @param bytes the 8 bytes (uint8_t array)
+ *
+ * @return the number (uint64_t)
+ */
+static inline uint64_t load_big_endian_64(const uint8_t *bytes)
+{
+    uint64_t value = 0;
+
+    for (int byte = 0; byte < 8; byte++)
+    {
+        value = (value << 8) | bytes[byte];
+    }
+
+    return value;
+}
+
+/**
+ * Function that stores a big-endian 64-bit number
+ *
+ * @param bytes the 8 bytes (uint8_t array)
+ * @param value the number (uint64_t)
+ */
+static inline void store_big_endian_64(uint8_t *bytes, uint64_t value)
+{
+    for (int byte = 7; byte >= 0; byte--)
+    {
+        bytes[byte] = (uint8_t)value;
+        value >>= 8;
+    }
+}
+
+/**
+ * Function that xors the keystream into the data, 8 bytes at a time
+ *
+ * @param data the data (uint8_t array)
+ * @param keystream the keystream (uint8_t array)
+ * @param size the number of bytes (size_t)
+ */
+static void xor_keystream(uint8_t *data, const uint8_t *keystream, size_t size)
+{
+    size_t index = 0;
+
+    for (; index + sizeof(uint64_t) <= size; index += sizeof(uint64_t))
+    {
+        uint64_t data_word, keystream_word;
+
+        memcpy(&data_word, data + index, sizeof(uint64_t));
+        memcpy(&keystream_word, keystream + index, sizeof(uint64_t));
+        data_word ^= keystream_word;
+        memcpy(data + index, &data_word, sizeof(uint64_t));
+    }
+
+    for (; index < size; index++)
+    {
+        data[index] ^= keystream[index];
+    }
+}
+
+void ctr_key_init(struct ctr_key *key, const struct edes_ctx *ctx, const uint8_t *iv)
+{
+    key->sboxes = ctx->sboxes;
+    memcpy(key->iv, iv, CTR_IV_SIZE);
+}
+
+void ctr_keystream_blocks(const struct ctr_key *key, uint64_t first_block, uint8_t *keystream, size_t number_of_blocks)
+{
+    // The counter wraps around modulo 2^64
+    uint64_t counter = load_big_endian_64(key->iv) + first_block;
+
+    for (size_t block = 0; block < number_of_blocks; block++)
+    {
+        store_big_endian_64(keystream + block * BLOCK_SIZE, counter + block);
+    }
+
+    e_des_encrypt_blocks(keystream, number_of_blocks * BLOCK_SIZE, key->sboxes);
+}
+
+void ctr_crypt(const struct ctr_key *key, uint64_t offset, uint8_t *data, size_t size)
+{
+    uint8_t keystream[CTR_KEYSTREAM_CHUNK_SIZE];
+    uint64_t block = offset / BLOCK_SIZE;
+    size_t skipped_bytes = offset % BLOCK_SIZE; // bytes of the first block before the offset
+    size_t done = 0;
+
+    while (done < size)
+    {
+        size_t number_of_bytes = skipped_bytes + (size - done);
+
+        if (number_of_bytes > CTR_KEYSTREAM_CHUNK_SIZE)
+        {
+            number_of_bytes = CTR_KEYSTREAM_CHUNK_SIZE;
+        }
+
+        size_t number_of_blocks = (number_of_bytes + BLOCK_SIZE - 1) / BLOCK_SIZE;
+        size_t used_bytes = number_of_bytes - skipped_bytes;
+
+        ctr_keystream_blocks(key, block, keystream, number_of_blocks);
+        xor_keystream(data + done, keystream + skipped_bytes, used_bytes);
+
+        done += used_bytes;
+        block += number_of_blocks;
+        skipped_bytes = 0;
+    }
+}
+
+/**
+ * Task of a ctr_crypt_parallel job, it processes one chunk of PARALLEL_CHUNK_SIZE bytes
+ *
+ * @param argument the job (struct ctr_job)
+ * @param task_index the index of the chunk (size_t)
+ */
+static void ctr_crypt_chunk(void *argument, size_t task_index)
+{
+    struct ctr_job *job = (struct ctr_job *)argument;
+
+    size_t chunk_start = task_index * PARALLEL_CHUNK_SIZE;
+    size_t chunk_size = job->size - chunk_start;
+
+    if (chunk_size > PARALLEL_CHUNK_SIZE)
+    {
+        chunk_size = PARALLEL_CHUNK_SIZE;
+    }
+
+    ctr_crypt(job->key, job->offset + chunk_start, job->data + chunk_start, chunk_size);
+}
+
+void ctr_crypt_parallel(struct thread_pool *pool, const struct ctr_key *key, uint64_t offset, uint8_t *data, size_t size)
+{
+    if (pool == NULL)
+    {
+        ctr_crypt(key, offset, data, size);
+        return;
+    }
+
+    struct ctr_job job;
+    job.key = key;
+    job.offset = offset;
+    job.data = data;
+    job.size = size;
+
+    size_t number_of_chunks = (size + PARALLEL_CHUNK_SIZE - 1) / PARALLEL_CHUNK_SIZE;
+
+    thread_pool_run(pool, ctr_crypt_chunk, &job, number_of_chunks);
+}
+
+/**
+ * Function run by the helper thread of the keystream ring, it fills the free slots in order until the ring is stopped
+ *
+ * @param argument the ring (struct ctr_keystream_ring)
+ *
+ * @return NULL
+ */
+static void *keystream_helper_thread(void *argument)
+{
+    struct ctr_keystream_ring *ring = (struct ctr_keystream_ring *)argument;
+
+    pthread_mutex_lock(&ring->mutex);
+    for (;;)
+    {
+        while (!ring->shutdown && ring->filled_slots - ring->consumed_slots == CTR_RING_SLOTS)
+        {
+            pthread_cond_wait(&ring->slot_freed, &ring->mutex);
+        }
+
+        if (ring->shutdown)
+        {
+            break;
+        }
+
+        uint8_t *slot = ring->slots + (ring->filled_slots % CTR_RING_SLOTS) * ring->slot_size;
+        uint64_t offset = ring->next_offset;
+
+        // The slot is not visible to the caller until filled_slots is incremented
+        pthread_mutex_unlock(&ring->mutex);
+        memset(slot, 0, ring->slot_size);
+        ctr_crypt_parallel(ring->pool, ring->key, offset, slot, ring->slot_size);
+        pthread_mutex_lock(&ring->mutex);
+
+        ring->next_offset += ring->slot_size;
+        ring->filled_slots++;
+        pthread_cond_signal(&ring->slot_filled);
+    }
+    pthread_mutex_unlock(&ring->mutex);
+
+    return NULL;
+}
+
+int ctr_ring_start(struct ctr_keystream_ring *ring, const struct ctr_key *key, struct thread_pool *pool, uint64_t offset, size_t slot_size)
+{
+    ring->key = key;
+    ring->pool = pool;
+    ring->slot_size = slot_size;
+    ring->next_offset = offset;
+    ring->filled_slots = 0;
+    ring->consumed_slots = 0;
+    ring->shutdown = 0;
+    ring->slots = (uint8_t *)malloc(CTR_RING_SLOTS * slot_size);
+
+    if (ring->slots == NULL) // memory allocation error
+    {
+        return EDES_ERROR_OUT_OF_MEMORY;
+    }
+
+    pthread_mutex_init(&ring->mutex, NULL);
+    pthread_cond_init(&ring->slot_filled, NULL);
+    pthread_cond_init(&ring->slot_freed, NULL);
+
+    if (pthread_create(&ring->helper, NULL, keystream_helper_thread, ring) != 0)
+    {
+        pthread_mutex_destroy(&ring->mutex);
+        pthread_cond_destroy(&ring->slot_filled);
+        pthread_cond_destroy(&ring->slot_freed);
+        free(ring->slots);
+        return EDES_ERROR_OUT_OF_MEMORY;
+    }
+
+    return EDES_OK;
+}
+
+const uint8_t *ctr_ring_acquire(struct ctr_keystream_ring *ring)
+{
+    pthread_mutex_lock(&ring->mutex);
+
+    while (ring->filled_slots == ring->consumed_slots)
+    {
+        pthread_cond_wait(&ring->slot_filled, &ring->mutex);
+    }
+
+    const uint8_t *slot = ring->slots + (ring->consumed_slots % CTR_RING_SLOTS) * ring->slot_size;
+
+    pthread_mutex_unlock(&ring->mutex);
+
+    return slot;
+}
+
+void ctr_ring_release(struct ctr_keystream_ring *ring)
+{
+    pthread_mutex_lock(&ring->mutex);
+    ring->consumed_slots++;
+    pthread_cond_signal(&ring->slot_freed);
+    pthread_mutex_unlock(&ring->mutex);
+}
+
+void ctr_ring_stop(struct ctr_keystream_ring *ring)
+{
+    pthread_mutex_lock(&ring->mutex);
+    ring->shutdown = 1;
+    pthread_cond_signal(&ring->slot_freed);
+    pthread_mutex_unlock(&ring->mutex);
+
+    pthread_join(ring->helper, NULL);
+
+    pthread_mutex_destroy(&ring->mutex);
+    pthread_cond_destroy(&ring->slot_filled);
+    pthread_cond_destroy(&ring->slot_freed);
+
+    // The slots hold keystream
+    memset(ring->slots, 0, CTR_RING_SLOTS * ring->slot_size);
+    free(ring->slots);
+}
+
+int ctr_stream(FILE *input, FILE *output, const struct ctr_key *key, struct thread_pool *pool, size_t buffer_size, int prefetch)
+{
+    uint8_t *buffer = (uint8_t *)malloc(buffer_size);
+
+    if (buffer == NULL) // memory allocation error
+    {
+        return EDES_ERROR_OUT_OF_MEMORY;
+    }
+
+    struct ctr_keystream_ring ring;
+
+    if (prefetch)
+    {
+        int status = ctr_ring_start(&ring, key, pool, 0, buffer_size);
+
+        if (status != EDES_OK)
+        {
+            free(buffer);
+            return status;
+        }
+    }
+
+    uint64_t offset = 0;
+    int status = EDES_OK;
+
+    for (;;)
+    {
+        STATS_START(read_start);
+        size_t number_of_readed_bytes = fread(buffer, sizeof(uint8_t), buffer_size, input);
+        STATS_STOP(STATS_READ_BYTES, read_start, number_of_readed_bytes);
+
+        if (ferror(input))
+        {
+            status = EDES_ERROR_IO;
+            break;
+        }
+
+        if (number_of_readed_bytes == 0)
+        {
+            break;
+        }
+
+        // Every chunk but the last one is buffer_size bytes, so the chunks line up with the slots of the ring
+        STATS_START(feistel_start);
+        if (prefetch)
+        {
+            xor_keystream(buffer, ctr_ring_acquire(&ring), number_of_readed_bytes);
+            ctr_ring_release(&ring);
+        }
+        else
+        {
+            ctr_crypt_parallel(pool, key, offset, buffer, number_of_readed_bytes);
+        }
+        STATS_STOP(STATS_FEISTEL, feistel_start, number_of_readed_bytes);
+
+        STATS_START(write_start);
+        if (fwrite(buffer, sizeof(uint8_t), number_of_readed_bytes, output) != number_of_readed_bytes)
+        {
+            status = EDES_ERROR_IO;
+            break;
+        }
+        STATS_STOP(STATS_WRITE_BYTES, write_start, number_of_readed_bytes);
+
+        offset += number_of_readed_bytes;
+
+        if (number_of_readed_bytes < buffer_size)
+        {
+            break;
+        }
+    }
+
+    if (prefetch)
+    {
+        ctr_ring_stop(&ring);
+    }
+
+    // The buffer holds plaintext
+    memset(buffer, 0, buffer_size);
+    free(buffer);
+
+    return status;
+}
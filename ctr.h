@@ -0,0 +1,158 @@
+#ifndef __CTR_H__
+#define __CTR_H__
+
+/**
+ * @file ctr.h
+ * @brief Counter (CTR) mode of e-des
+ *
+ * This file contains the CTR mode of e-des: the counter blocks IV, IV + 1, IV + 2, ... are ciphered with the e-des block kernel and the resulting keystream is xored with the data.
+ * Encrypt and decrypt are the same operation, no padding is needed and the keystream of any byte offset can be generated directly, so the data can be processed in parallel and from any position.
+ *
+ * @author Ana Vidal (118408)
+ * @author Simão Andrade (118345)
+ * @date 2023-10-20
+ */
+
+#include "implementation.h"
+#include "parallel.h"
+
+// Constants for the CTR mode
+#define CTR_IV_SIZE IV_SIZE // the IV is the first counter block, it is written before the ciphertext
+#define CTR_KEYSTREAM_CHUNK_SIZE (4 * 1024) // 4KiB of keystream generated per call to the block kernel
+#define CTR_RING_SLOTS 4 // number of keystream chunks pregenerated by the helper thread
+
+/**
+ * Struct that represents the key material of the CTR mode
+ *
+ * @param sboxes the sboxes (struct s_box array)
+ * @param iv the first counter block, a big-endian 64-bit number (uint8_t array)
+ */
+struct ctr_key
+{
+    const struct s_box *sboxes;
+    uint8_t iv[CTR_IV_SIZE];
+};
+
+/**
+ * Struct that represents a ring of keystream chunks, a helper thread fills the free slots while the caller waits for I/O
+ *
+ * @param key the key material (struct ctr_key)
+ * @param pool the thread pool used to generate each slot, NULL to generate it on the helper thread only (struct thread_pool)
+ * @param slots the keystream slots (uint8_t array)
+ * @param slot_size the size of each slot (size_t)
+ * @param next_offset the byte offset of the keystream of the next slot to fill (uint64_t)
+ * @param filled_slots the number of slots filled since the start (size_t)
+ * @param consumed_slots the number of slots given back by the caller since the start (size_t)
+ * @param helper the helper thread (pthread_t)
+ * @param mutex the mutex that protects the state of the ring (pthread_mutex_t)
+ * @param slot_filled condition signaled when the helper fills a slot (pthread_cond_t)
+ * @param slot_freed condition signaled when the caller gives back a slot or the ring is stopped (pthread_cond_t)
+ * @param shutdown set when the ring is being stopped (int)
+ */
+struct ctr_keystream_ring
+{
+    const struct ctr_key *key;
+    struct thread_pool *pool;
+    uint8_t *slots;
+    size_t slot_size;
+    uint64_t next_offset;
+    size_t filled_slots;
+    size_t consumed_slots;
+    pthread_t helper;
+    pthread_mutex_t mutex;
+    pthread_cond_t slot_filled;
+    pthread_cond_t slot_freed;
+    int shutdown;
+};
+
+/**
+ * Function that initializes the key material of the CTR mode
+ *
+ * @param key pointer to the key material (struct ctr_key)
+ * @param ctx the key context, it must outlive the key material (struct edes_ctx)
+ * @param iv the IV (uint8_t array)
+ */
+void ctr_key_init(struct ctr_key *key, const struct edes_ctx *ctx, const uint8_t *iv);
+
+/**
+ * Function that generates whole keystream blocks, the block i is the counter block IV + first_block + i ciphered with e-des
+ *
+ * @param key the key material (struct ctr_key)
+ * @param first_block the index of the first block (uint64_t)
+ * @param keystream the keystream (uint8_t array)
+ * @param number_of_blocks the number of blocks (size_t)
+ */
+void ctr_keystream_blocks(const struct ctr_key *key, uint64_t first_block, uint8_t *keystream, size_t number_of_blocks);
+
+/**
+ * Function that ciphers/deciphers the data in place, the data is the part of the stream that starts at the given byte offset (any offset and size, no alignment needed)
+ *
+ * @param key the key material (struct ctr_key)
+ * @param offset the byte offset of the data in the stream (uint64_t)
+ * @param data the data (uint8_t array)
+ * @param size the size of the data (size_t)
+ */
+void ctr_crypt(const struct ctr_key *key, uint64_t offset, uint8_t *data, size_t size);
+
+/**
+ * Function that ciphers/deciphers the data in place, splitting it in chunks of PARALLEL_CHUNK_SIZE bytes across the thread pool, the output is byte-identical to ctr_crypt
+ *
+ * @param pool the thread pool, NULL to run ctr_crypt on the calling thread (struct thread_pool)
+ * @param key the key material (struct ctr_key)
+ * @param offset the byte offset of the data in the stream (uint64_t)
+ * @param data the data (uint8_t array)
+ * @param size the size of the data (size_t)
+ */
+void ctr_crypt_parallel(struct thread_pool *pool, const struct ctr_key *key, uint64_t offset, uint8_t *data, size_t size);
+
+/**
+ * Function that starts the helper thread of the keystream ring, it pregenerates CTR_RING_SLOTS slots of slot_size bytes from the given offset
+ *
+ * @param ring pointer to the ring (struct ctr_keystream_ring)
+ * @param key the key material (struct ctr_key)
+ * @param pool the thread pool used to generate each slot, NULL for none (struct thread_pool)
+ * @param offset the byte offset of the first slot (uint64_t)
+ * @param slot_size the size of each slot (size_t)
+ *
+ * @return EDES_OK, or EDES_ERROR_OUT_OF_MEMORY if the slots or the helper thread could not be created (nothing to stop then)
+ */
+int ctr_ring_start(struct ctr_keystream_ring *ring, const struct ctr_key *key, struct thread_pool *pool, uint64_t offset, size_t slot_size);
+
+/**
+ * Function that waits for the next slot of keystream, the slots are given in order and each one follows the previous in the stream
+ *
+ * @param ring pointer to the ring (struct ctr_keystream_ring)
+ *
+ * @return the keystream of the slot, slot_size bytes (uint8_t array)
+ */
+const uint8_t *ctr_ring_acquire(struct ctr_keystream_ring *ring);
+
+/**
+ * Function that gives back the slot returned by the last ctr_ring_acquire, so the helper thread can fill it again
+ *
+ * @param ring pointer to the ring (struct ctr_keystream_ring)
+ */
+void ctr_ring_release(struct ctr_keystream_ring *ring);
+
+/**
+ * Function that stops the helper thread and frees the slots of the ring
+ *
+ * @param ring pointer to the ring (struct ctr_keystream_ring)
+ */
+void ctr_ring_stop(struct ctr_keystream_ring *ring);
+
+/**
+ * CTR Stream Function, reads the data in chunks of buffer_size bytes, xors them with the keystream and writes them (encrypt and decrypt are the same operation)
+ *
+ * @param input the input stream, positioned after the IV (FILE)
+ * @param output the output stream (FILE)
+ * @param key the key material (struct ctr_key)
+ * @param pool the thread pool, NULL for none (struct thread_pool)
+ * @param buffer_size the size of the chunks (size_t)
+ * @param prefetch 1 to pregenerate the keystream on a helper thread while the chunks are read and written (int)
+ *
+ * @return EDES_OK, EDES_ERROR_OUT_OF_MEMORY, or EDES_ERROR_IO if the input could not be read or the output written
+ */
+int ctr_stream(FILE *input, FILE *output, const struct ctr_key *key, struct thread_pool *pool, size_t buffer_size, int prefetch);
+
+#endif
@@ -1,4 +1,11 @@
 #include "implementation.h"
+#include "parallel.h"
+#include "async_io.h"
+#include "ctr.h"
+#include "cbc.h"
+#include "container.h"
+#include "server.h"
+#include "stats.h"
 
 /**
  * @file e-des.c
@@ -12,7 +19,71 @@
  */
 
 /**
- * Main function, it receives the arguments and calls the encrypt or decrypt function
+ * Function that prints the usage of the program and exits
+ *
+ * @param program_name the name of the program (char array)
+ */
+static void usage(const char *program_name)
+{
+    fprintf(stderr, "Usage: %s [-j <threads>] [--stats] [--io-uring | -i <file> (-o <file> | --in-place) | --prefetch | [-i <file>] --offset <bytes> [--length <bytes>] [--container] | --container [--chunk-size <bytes>] | --connect <socket>] <mode> <-e/-d> <password>\n", program_name);
+    fprintf(stderr, "       %s [-j <threads>] --serve <socket>\n", program_name);
+    fprintf(stderr, "  <mode>        e-des, e-des-ctr, e-des-cbc, des-ecb or 3des-ede\n");
+    fprintf(stderr, "  -j <threads>  number of threads to use, 0 uses all the cores (default 1, at most 4 per core)\n");
+    fprintf(stderr, "  -i <file>     memory map the input file instead of reading stdin\n");
+    fprintf(stderr, "  -o <file>     memory map the output file instead of writing stdout\n");
+    fprintf(stderr, "  --in-place    cipher/decipher the input file in place\n");
+    fprintf(stderr, "  --io-uring    overlap the stdin reads and stdout writes with the cipher (io_uring, read/write on helper threads if unavailable)\n");
+    fprintf(stderr, "  --prefetch    e-des-ctr only, pregenerate the keystream on a helper thread while stdin/stdout are pending\n");
+    fprintf(stderr, "  --offset <n>  e-des/des-ecb/3des-ede -d only, decipher only the plaintext from byte n (the input file or stdin must be seekable)\n");
+    fprintf(stderr, "  --length <n>  number of plaintext bytes to decipher from the offset (default up to the end)\n");
+    fprintf(stderr, "                with --container the input is a container file, only the chunks that cover the range are read\n");
+    fprintf(stderr, "  --container   e-des/des-ecb/3des-ede only, write (-e) or read (-d) the chunked container format with checksums and an index\n");
+    fprintf(stderr, "  --chunk-size <n>  plaintext bytes per container chunk, multiple of 8 (default 1MiB)\n");
+    fprintf(stderr, "  --serve <socket>    run a server on a Unix domain socket that keeps the sboxes resident, -j workers (default all the cores),\n");
+    fprintf(stderr, "                      each worker serves one connection until it is closed, further clients wait\n");
+    fprintf(stderr, "  --connect <socket>  e-des/des-ecb only, send stdin to the server and write the answer to stdout\n");
+    fprintf(stderr, "  --stats       print a JSON summary to stderr: time, bytes and blocks of each phase, throughput, peak memory, kernel and threads\n");
+    exit(1);
+}
+
+/**
+ * Function that parses a non-negative number of bytes, prints the usage and exits if it is not valid
+ *
+ * @param text the number (char array)
+ * @param program_name the name of the program (char array)
+ *
+ * @return the number (uint64_t)
+ */
+static uint64_t parse_size(const char *text, const char *program_name)
+{
+    char *end;
+    unsigned long long value = strtoull(text, &end, 10);
+
+    if (*end != '\0' || end == text || text[0] == '-')
+    {
+        usage(program_name);
+    }
+
+    return (uint64_t)value;
+}
+
+/**
+ * Function that exits with an error message if a status of the library is not EDES_OK
+ *
+ * @param status the status (int)
+ * @param what what failed, for the message (char array)
+ */
+static void check_status(int status, const char *what)
+{
+    if (status != EDES_OK)
+    {
+        fprintf(stderr, "Error in %s: %s\n", what, edes_strerror(status));
+        exit(1);
+    }
+}
+
+/**
+ * Main function, it receives the arguments and streams stdin through the encrypt or decrypt pipeline to stdout
  *
  * @param argc number of arguments
  * @param argv arguments
@@ -21,90 +92,423 @@
  */
 int main(int argc, char **argv)
 {
-    if (argc != 4)
+    uint64_t run_start = stats_now();
+
+    // Split the options from the positional arguments (<mode> <-e/-d> <password>)
+    char *positional_arguments[3];
+    int number_of_positional_arguments = 0;
+    size_t number_of_threads = 1;
+    const char *input_path = NULL;
+    const char *output_path = NULL;
+    int in_place = 0;
+    int use_io_uring = 0;
+    int prefetch = 0;
+    int threads_given = 0;
+    const char *serve_path = NULL;
+    const char *connect_path = NULL;
+    int range_mode = 0;
+    uint64_t range_offset = 0;
+    uint64_t range_length = SIZE_MAX;
+    int container_mode = 0;
+    uint64_t container_chunk_size = CONTAINER_CHUNK_SIZE;
+    int stats_mode = 0;
+
+    for (int argument_index = 1; argument_index < argc; argument_index++)
     {
-        fprintf(stderr, "Usage: %s <mode> <-e/-d> <password>\n", argv[0]);
-        exit(1);
+        if (strcmp(argv[argument_index], "-j") == 0 && argument_index + 1 < argc)
+        {
+            char *end;
+            long value = strtol(argv[++argument_index], &end, 10);
+
+            if (*end != '\0' || value < 0)
+            {
+                usage(argv[0]);
+            }
+
+            number_of_threads = value == 0 ? get_number_of_cores() : (size_t)value;
+
+            // The buffers are sized per thread, so an absurd count would only end in an allocation failure
+            size_t max_threads = MAX_THREADS_PER_CORE * get_number_of_cores();
+            if (number_of_threads > max_threads)
+            {
+                fprintf(stderr, "Warning: -j %ld is more than %d threads per core, using %zu threads\n", value, MAX_THREADS_PER_CORE, max_threads);
+                number_of_threads = max_threads;
+            }
+
+            threads_given = 1;
+        }
+        else if (strcmp(argv[argument_index], "-i") == 0 && argument_index + 1 < argc)
+        {
+            input_path = argv[++argument_index];
+        }
+        else if (strcmp(argv[argument_index], "-o") == 0 && argument_index + 1 < argc)
+        {
+            output_path = argv[++argument_index];
+        }
+        else if (strcmp(argv[argument_index], "--in-place") == 0)
+        {
+            in_place = 1;
+        }
+        else if (strcmp(argv[argument_index], "--io-uring") == 0)
+        {
+            use_io_uring = 1;
+        }
+        else if (strcmp(argv[argument_index], "--prefetch") == 0)
+        {
+            prefetch = 1;
+        }
+        else if (strcmp(argv[argument_index], "--offset") == 0 && argument_index + 1 < argc)
+        {
+            range_offset = parse_size(argv[++argument_index], argv[0]);
+            range_mode = 1;
+        }
+        else if (strcmp(argv[argument_index], "--length") == 0 && argument_index + 1 < argc)
+        {
+            range_length = parse_size(argv[++argument_index], argv[0]);
+            range_mode = 1;
+        }
+        else if (strcmp(argv[argument_index], "--container") == 0)
+        {
+            container_mode = 1;
+        }
+        else if (strcmp(argv[argument_index], "--chunk-size") == 0 && argument_index + 1 < argc)
+        {
+            container_chunk_size = parse_size(argv[++argument_index], argv[0]);
+
+            if (container_chunk_size == 0 || container_chunk_size % BLOCK_SIZE != 0 || container_chunk_size > CONTAINER_MAX_CHUNK_SIZE)
+            {
+                usage(argv[0]);
+            }
+        }
+        else if (strcmp(argv[argument_index], "--stats") == 0)
+        {
+            stats_mode = 1;
+        }
+        else if (strcmp(argv[argument_index], "--serve") == 0 && argument_index + 1 < argc)
+        {
+            serve_path = argv[++argument_index];
+        }
+        else if (strcmp(argv[argument_index], "--connect") == 0 && argument_index + 1 < argc)
+        {
+            connect_path = argv[++argument_index];
+        }
+        else if (number_of_positional_arguments < 3)
+        {
+            positional_arguments[number_of_positional_arguments++] = argv[argument_index];
+        }
+        else
+        {
+            usage(argv[0]);
+        }
     }
 
-    // Read the password
-    uint8_t *password = (uint8_t *)argv[3];
+    // The server takes the mode, operation and password from each request
+    if (serve_path != NULL)
+    {
+        if (number_of_positional_arguments != 0 || connect_path != NULL || input_path != NULL || output_path != NULL || in_place || use_io_uring || prefetch || range_mode || container_mode || stats_mode)
+        {
+            usage(argv[0]);
+        }
 
-    // Read the bytes from stdin
-    uint8_t *readed_bytes = (uint8_t *)malloc(sizeof(uint8_t) * MAX_BYTES);
+        server_run(serve_path, threads_given ? number_of_threads : get_number_of_cores());
+        return 0;
+    }
+
+    if (number_of_positional_arguments != 3)
+    {
+        usage(argv[0]);
+    }
 
-    if (readed_bytes == NULL) // memory allocation error
+    if (stats_mode && !EDES_STATS)
     {
-        printf("Error allocating memory for readed bytes\n");
+        fprintf(stderr, "Error: --stats is not available, the program was compiled with EDES_STATS=0\n");
         exit(1);
     }
 
-    size_t number_of_readed_bytes;
-    read_bytes(readed_bytes, &number_of_readed_bytes);
+    stats_enabled = stats_mode;
+
+    // The client only streams stdin to the server and the answer to stdout
+    if (connect_path != NULL && (input_path != NULL || output_path != NULL || in_place || use_io_uring || prefetch || range_mode || container_mode))
+    {
+        usage(argv[0]);
+    }
+
+    // The range mode reads the input file (or stdin) at the offset and writes the plaintext to stdout
+    if (range_mode && (output_path != NULL || in_place || use_io_uring || prefetch))
+    {
+        usage(argv[0]);
+    }
+
+    // The container is streamed from stdin to stdout, or read from its index with --offset/--length
+    if (container_mode && ((input_path != NULL && !range_mode) || output_path != NULL || in_place || use_io_uring || prefetch))
+    {
+        usage(argv[0]);
+    }
+
+    // The file mode needs an input file and either an output file or the in-place option
+    int file_mode = !range_mode && (input_path != NULL || output_path != NULL || in_place);
+
+    if (file_mode && (input_path == NULL || (output_path == NULL) == !in_place || use_io_uring))
+    {
+        usage(argv[0]);
+    }
+
+    char *mode = positional_arguments[0];
+    char *operation = positional_arguments[1];
+
+    // Read the password
+    uint8_t *password = (uint8_t *)positional_arguments[2];
 
     // Encrypt or decrypt
-    int cipher = strcmp(argv[2], "-e") == 0;
-    int decipher = strcmp(argv[2], "-d") == 0;
+    int cipher = strcmp(operation, "-e") == 0;
+    int decipher = strcmp(operation, "-d") == 0;
 
-    // E-Des or DES-ECB mode
-    int e_des_mode = strcmp(argv[1], "e-des") == 0;
-    int ecb_des_mode = strcmp(argv[1], "des-ecb") == 0;
+    if (!cipher && !decipher)
+    {
+        fprintf(stderr, "Usage: The only valid modes are -e and -d\n");
+        exit(1);
+    }
 
-    if (cipher)
-    { // Encrypt
-        uint8_t *ciphertext;
-        size_t ciphertext_size;
+    // E-Des, E-Des CTR, E-Des CBC, DES-ECB or 3DES-EDE (ECB) mode
+    int e_des_mode = strcmp(mode, "e-des") == 0;
+    int ctr_mode = strcmp(mode, "e-des-ctr") == 0;
+    int cbc_mode = strcmp(mode, "e-des-cbc") == 0;
+    int ecb_des_mode = strcmp(mode, "des-ecb") == 0;
+    int triple_des_mode = strcmp(mode, "3des-ede") == 0;
+
+    // The CTR and CBC modes only stream stdin to stdout, and only the CTR mode has a keystream to prefetch
+    if (((ctr_mode || cbc_mode) && (file_mode || use_io_uring)) || (prefetch && !ctr_mode))
+    {
+        usage(argv[0]);
+    }
+
+    // Only the ECB modes are deciphered block by block from any offset
+    if (range_mode && (cipher || !(e_des_mode || ecb_des_mode || triple_des_mode)))
+    {
+        fprintf(stderr, "Usage: --offset/--length only decipher (-d) the e-des, des-ecb and 3des-ede modes\n");
+        exit(1);
+    }
 
-        if (e_des_mode)
+    if (connect_path != NULL)
+    {
+        if (!(e_des_mode || ecb_des_mode))
         {
-            encrypt(readed_bytes, password, &ciphertext, &ciphertext_size);
+            fprintf(stderr, "Usage: --connect only serves the e-des and des-ecb modes\n");
+            exit(1);
         }
-        else if (ecb_des_mode)
+
+        // The sboxes are derived (once) by the server, not here
+        client_stream(connect_path, stdin, stdout, e_des_mode ? SERVER_MODE_E_DES : SERVER_MODE_DES_ECB, cipher ? SERVER_OPERATION_ENCRYPT : SERVER_OPERATION_DECRYPT, password, STREAM_BUFFER_SIZE);
+
+        if (stats_mode)
         {
-            ecb_encrypt(readed_bytes, password, &ciphertext, &ciphertext_size);
+            stats_print(stderr, mode, cipher ? "encrypt" : "decrypt", number_of_threads, run_start);
         }
-        else
+        return 0;
+    }
+
+    if (container_mode && !(e_des_mode || ecb_des_mode || triple_des_mode))
+    {
+        fprintf(stderr, "Usage: --container only holds the e-des, des-ecb and 3des-ede modes\n");
+        exit(1);
+    }
+
+    // Key material of the selected mode
+    struct edes_ctx ctx;
+    struct des_key des_key;
+    const void *key;
+    block_cipher_function block_function;
+
+    // The key derivation is the generate_sboxes phase (the DES key schedule for des-ecb and 3des-ede)
+    STATS_START(key_start);
+
+    if (e_des_mode || cbc_mode)
+    {
+        edes_ctx_init(&ctx, password);
+        key = ctx.sboxes;
+        block_function = cipher ? e_des_encrypt_blocks : e_des_decrypt_blocks;
+    }
+    else if (ctr_mode)
+    {
+        edes_ctx_init(&ctx, password);
+        key = ctx.sboxes;
+        block_function = e_des_encrypt_blocks; // only the keystream is ciphered, by ctr_stream
+    }
+    else if (ecb_des_mode || triple_des_mode)
+    {
+        int status = ecb_des_mode ? generate_des_key(password, &des_key) : generate_triple_des_key(password, &des_key);
+
+        if (status != EDES_OK)
         {
-            fprintf(stderr, "Usage: The only valid modes are e-des and des-ecb\n");
+            fprintf(stderr, "Error generating the %s key: %s\n", mode, edes_strerror(status));
             exit(1);
         }
 
-        // Write the ciphertext to stdout
-        write_bytes(ciphertext, ciphertext_size);
+        key = &des_key;
+        block_function = cipher ? des_ecb_encrypt_blocks : des_ecb_decrypt_blocks;
+    }
+    else
+    {
+        fprintf(stderr, "Usage: The only valid modes are e-des, e-des-ctr, e-des-cbc, des-ecb and 3des-ede\n");
+        exit(1);
+    }
+
+    STATS_STOP(STATS_GENERATE_SBOXES, key_start, 0);
+
+    // The container spreads whole chunks across the thread pool and checks the key with the cipher of a zero block
+    block_cipher_function chunk_function = block_function;
+    const void *chunk_key = key;
+    uint8_t key_check_value[BLOCK_SIZE];
+
+    if (container_mode)
+    {
+        container_key_check_value(ecb_des_mode || triple_des_mode ? des_ecb_encrypt_blocks : e_des_encrypt_blocks, key, key_check_value);
+    }
+
+    // Spread the blocks of each chunk across the thread pool, all the workers share the same key material
+    struct thread_pool *pool = NULL;
+    struct parallel_cipher parallel_cipher;
+
+    if (number_of_threads > 1)
+    {
+        pool = thread_pool_create(number_of_threads);
+
+        parallel_cipher.pool = pool;
+        parallel_cipher.function = block_function;
+        parallel_cipher.key = key;
 
-        // Free memory
-        free(ciphertext);
+        block_function = parallel_cipher_blocks;
+        key = &parallel_cipher;
     }
-    else if (decipher)
-    { // Decrypt
-        uint8_t *plaintext;
-        size_t plaintext_size;
 
-        if (e_des_mode)
+    // The random IV of the CTR and CBC modes is the first block of the ciphertext
+    uint8_t iv[IV_SIZE];
+
+    if ((ctr_mode || cbc_mode) && cipher)
+    {
+        generate_iv(iv);
+
+        if (fwrite(iv, sizeof(uint8_t), IV_SIZE, stdout) != IV_SIZE)
         {
-            decrypt(readed_bytes, number_of_readed_bytes, password, &plaintext, &plaintext_size);
+            fprintf(stderr, "Error writing the output stream\n");
+            exit(1);
         }
-        else if (ecb_des_mode)
+    }
+    else if ((ctr_mode || cbc_mode) && fread(iv, sizeof(uint8_t), IV_SIZE, stdin) != IV_SIZE)
+    {
+        fprintf(stderr, "Error: the ciphertext is shorter than the IV\n");
+        exit(1);
+    }
+
+    if (container_mode && cipher)
+    {
+        check_status(container_encrypt(stdin, stdout, chunk_function, chunk_key, key_check_value, pool, (size_t)container_chunk_size), "the container");
+    }
+    else if (container_mode && !range_mode)
+    {
+        check_status(container_decrypt(stdin, stdout, chunk_function, chunk_key, key_check_value, pool), "the container");
+    }
+    else if (range_mode)
+    {
+        // Only the blocks that cover the range are read, the memory used does not depend on the file size
+        int file_descriptor = STDIN_FILENO;
+
+        if (input_path != NULL && (file_descriptor = open(input_path, O_RDONLY)) < 0)
         {
-            ecb_decrypt(readed_bytes, number_of_readed_bytes, password, &plaintext, &plaintext_size);
+            fprintf(stderr, "Error opening %s\n", input_path);
+            exit(1);
         }
-        else
+
+        struct stat file_status;
+
+        if (fstat(file_descriptor, &file_status) != 0 || !S_ISREG(file_status.st_mode))
         {
-            fprintf(stderr, "Usage: The only valid modes are e-des and des-ecb\n");
+            fprintf(stderr, "Error: --offset/--length need a regular file as input (-i <file> or stdin redirected from a file)\n");
             exit(1);
         }
 
-        // Write the plaintext to stdout
-        write_bytes(plaintext, plaintext_size);
+        if (container_mode)
+        {
+            // The blocks of each chunk are spread across the thread pool
+            check_status(container_decrypt_range(file_descriptor, stdout, block_function, key, key_check_value, range_offset, range_length), "the container");
+        }
+        else
+        {
+            size_t length = range_length > SIZE_MAX ? SIZE_MAX : (size_t)range_length;
+
+            file_decrypt_range(file_descriptor, stdout, block_function, key, range_offset, length, STREAM_BUFFER_SIZE * number_of_threads);
+        }
+
+        if (input_path != NULL)
+        {
+            close(file_descriptor);
+        }
+    }
+    else if (ctr_mode)
+    {
+        // The rest of the ciphertext is the data xored with the keystream
+        struct ctr_key ctr_key;
 
-        // Free memory
-        free(plaintext);
+        ctr_key_init(&ctr_key, &ctx, iv);
+        check_status(ctr_stream(stdin, stdout, &ctr_key, pool, STREAM_BUFFER_SIZE * number_of_threads, prefetch), "the CTR stream");
+    }
+    else if (cbc_mode && cipher)
+    {
+        // Each block depends on the previous one, the encryption of a stream is serial
+        check_status(cbc_stream_encrypt(stdin, stdout, ctx.sboxes, iv, STREAM_BUFFER_SIZE), "the CBC stream");
+    }
+    else if (cbc_mode)
+    {
+        // The blocks are deciphered by the SIMD kernel (and the thread pool) before the chain xor
+        check_status(cbc_stream_decrypt(stdin, stdout, block_function, key, iv, STREAM_BUFFER_SIZE * number_of_threads), "the CBC stream");
+    }
+    else if (file_mode)
+    {
+        // Cipher the mapped files directly, only a few chunks are resident at a time
+        size_t chunk_size = FILE_CHUNK_SIZE * number_of_threads;
+
+        if (cipher)
+        {
+            file_encrypt(input_path, output_path, block_function, key, chunk_size);
+        }
+        else
+        {
+            file_decrypt(input_path, output_path, block_function, key, chunk_size);
+        }
     }
     else
     {
-        fprintf(stderr, "Usage: The only valid modes are -e and -d\n");
-        exit(1);
+        // Stream stdin to stdout, the memory used does not depend on the input size
+        size_t buffer_size = STREAM_BUFFER_SIZE * number_of_threads;
+
+        if (use_io_uring && cipher)
+        {
+            async_stream_encrypt(STDIN_FILENO, STDOUT_FILENO, block_function, key, buffer_size);
+        }
+        else if (use_io_uring)
+        {
+            async_stream_decrypt(STDIN_FILENO, STDOUT_FILENO, block_function, key, buffer_size);
+        }
+        else if (cipher)
+        {
+            stream_encrypt(stdin, stdout, block_function, key, buffer_size);
+        }
+        else
+        {
+            stream_decrypt(stdin, stdout, block_function, key, buffer_size);
+        }
+    }
+
+    if (pool != NULL)
+    {
+        thread_pool_destroy(pool);
+    }
+
+    if (stats_mode)
+    {
+        fflush(stdout);
+        stats_print(stderr, mode, cipher ? "encrypt" : "decrypt", number_of_threads, run_start);
     }
 
     return 0;
-}
\ No newline at end of file
+}
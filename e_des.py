@@ -8,6 +8,7 @@
 
 import hashlib
 import argparse
+import os
 import sys
 
 # For Implementation
@@ -18,6 +19,9 @@ HALF_BLOCK_SIZE = 4 # bytes
 S_BOX_SIZE = 256 # bytes
 SHA_256_SIZE = 32 # bytes
 
+# Environment variable that forces the pure Python implementation instead of the native one
+PURE_PYTHON_VARIABLE = "E_DES_PURE_PYTHON"
+
 # For Performance Testing
 NUMBER_OF_RUNS = 100000
 BUFFER_SIZE = 4 * 1024 # 4 KiB
@@ -105,7 +109,8 @@ def add_padding(plaintext : bytearray) -> bytearray:
 
     number_of_padding_bytes = BLOCK_SIZE - (plaintext_size % BLOCK_SIZE)
 
-    padding_byte = number_of_padding_bytes.to_bytes(1, byteorder='big')
+    # The padding byte is the ASCII digit of the number of padding bytes, as in the C implementation and remove_padding
+    padding_byte = str(number_of_padding_bytes).encode('ascii')
     padded_data = bytearray(plaintext + padding_byte * number_of_padding_bytes)
 
     return padded_data
@@ -119,6 +124,10 @@ def remove_padding(padded_plaintext: bytearray) -> bytearray:
     @return The unpadded plaintext.
     """
 
+    # An empty ciphertext has no padding block, the plaintext is empty (as in the C implementation)
+    if len(padded_plaintext) == 0:
+        return bytearray()
+
     last_byte = bytes([padded_plaintext[-1]]).decode('utf-8')
     if not last_byte.isdigit():
         return padded_plaintext
@@ -226,13 +235,23 @@ def encrypt(plaintext : bytearray, password : bytearray) -> bytearray:
     @return The encrypted ciphertext.
     """
 
+    return encrypt_with_sboxes(plaintext, python_generate_sboxes(password))
+
+def encrypt_with_sboxes(plaintext : bytearray, sboxes : list) -> bytearray:
+    """!
+    @brief This function encrypts the plaintext with S-Boxes already generated.
+
+    @param plaintext The plaintext to be encrypted.
+    @param sboxes The S-Boxes generated from the password.
+
+    @return The encrypted ciphertext.
+    """
+
     ciphertext = bytearray()
 
     padded_plaintext = add_padding(plaintext)
     padded_plaintext_size = len(padded_plaintext)
 
-    sboxes = generate_sboxes(password)
-
     for block_index in range(0, padded_plaintext_size, BLOCK_SIZE):
 
         block = padded_plaintext[block_index:block_index + BLOCK_SIZE]
@@ -252,12 +271,22 @@ def decrypt(ciphertext : bytearray, password : bytearray) -> bytearray:
     :return: The decrypted plaintext.
     """
 
+    return decrypt_with_sboxes(ciphertext, python_generate_sboxes(password))
+
+def decrypt_with_sboxes(ciphertext : bytearray, sboxes : list) -> bytearray:
+    """!
+    @brief This function decrypts the ciphertext with S-Boxes already generated.
+
+    @param ciphertext The ciphertext to be decrypted.
+    @param sboxes The S-Boxes generated from the password.
+
+    @return The decrypted plaintext.
+    """
+
     ciphertext_size = len(ciphertext)
 
     padded_plaintext = bytearray()
 
-    sboxes = generate_sboxes(password)
-
     for block_index in range(0, ciphertext_size, BLOCK_SIZE):
 
         block = ciphertext[block_index:block_index + BLOCK_SIZE]
@@ -269,6 +298,77 @@ def decrypt(ciphertext : bytearray, password : bytearray) -> bytearray:
 
     return plaintext
 
+class PythonKey:
+    """!
+    @brief This class is the key context of the pure Python implementation, the S-Boxes are generated once from the password.
+    """
+
+    def __init__(self, password : bytearray):
+        """!
+        @brief This function generates the S-Boxes of the key.
+
+        @param password The password used to generate the S-Boxes.
+        """
+
+        self.sboxes = python_generate_sboxes(password)
+
+    def encrypt(self, plaintext : bytearray) -> bytearray:
+        """!
+        @brief This function encrypts the plaintext.
+
+        @param plaintext The plaintext to be encrypted.
+
+        @return The encrypted ciphertext.
+        """
+
+        return encrypt_with_sboxes(plaintext, self.sboxes)
+
+    def decrypt(self, ciphertext : bytearray) -> bytearray:
+        """!
+        @brief This function decrypts the ciphertext.
+
+        @param ciphertext The ciphertext to be decrypted.
+
+        @return The decrypted plaintext.
+        """
+
+        return decrypt_with_sboxes(ciphertext, self.sboxes)
+
+    def encrypt_blocks(self, buffer : bytearray) -> None:
+        """!
+        @brief This function encrypts the blocks of a writable buffer in place, without padding.
+
+        @param buffer The buffer, its size must be a multiple of BLOCK_SIZE.
+        """
+
+        for block_index in range(0, len(buffer), BLOCK_SIZE):
+            buffer[block_index:block_index + BLOCK_SIZE] = feistel_network(buffer[block_index:block_index + BLOCK_SIZE], self.sboxes)
+
+    def decrypt_blocks(self, buffer : bytearray) -> None:
+        """!
+        @brief This function decrypts the blocks of a writable buffer in place, without padding.
+
+        @param buffer The buffer, its size must be a multiple of BLOCK_SIZE.
+        """
+
+        for block_index in range(0, len(buffer), BLOCK_SIZE):
+            buffer[block_index:block_index + BLOCK_SIZE] = inverse_feistel_network(buffer[block_index:block_index + BLOCK_SIZE], self.sboxes)
+
+# The pure Python implementation stays available (and is the fallback of the native one)
+python_generate_sboxes = generate_sboxes
+python_encrypt = encrypt
+python_decrypt = decrypt
+Key = PythonKey
+
+# The native extension (make python) replaces generate_sboxes, encrypt, decrypt and Key when it is available
+NATIVE = False
+if not os.environ.get(PURE_PYTHON_VARIABLE):
+    try:
+        from _e_des import Key, generate_sboxes, encrypt, decrypt
+        NATIVE = True
+    except ImportError:
+        pass
+
 if __name__ == "__main__":
     """!
     @brief This is the main function of the program.
@@ -0,0 +1,427 @@
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include "implementation.h"
+
+/**
+ * @file e_des_module.c
+ * @brief Native CPython extension (_e_des) of the e_des Python module
+ *
+ * This file contains the _e_des extension module, backed by the C implementation, that e_des.py imports when it is available (the pure Python code stays as the fallback).
+ * The functions accept any object with the buffer protocol (bytes, bytearray, memoryview, mmap, ...) without copying it, and release the GIL while the sboxes are derived
+ * and while the blocks are ciphered, so several Python threads can cipher at the same time.
+ *
+ * The results are the same as the pure Python module and the e-des binary: encrypt/decrypt return a bytearray, generate_sboxes returns a list of NUMBER_OF_S_BOXES bytearrays.
+ *
+ * @author Ana Vidal (118408)
+ * @author Simão Andrade (118345)
+ * @date 2023-10-20
+ */
+
+/**
+ * Struct that represents the Key object, a precomputed key context
+ *
+ * @param ctx the key context, the sboxes derived from the password (struct edes_ctx)
+ */
+typedef struct
+{
+    PyObject_HEAD
+    struct edes_ctx ctx;
+} KeyObject;
+
+/**
+ * Function that derives a key context from a password buffer, with the GIL released
+ *
+ * @param password the password buffer, it must not contain zero bytes (Py_buffer)
+ * @param ctx pointer to the key context (struct edes_ctx)
+ *
+ * @return 0, or -1 with a Python exception set
+ */
+static int init_ctx_from_buffer(const Py_buffer *password, struct edes_ctx *ctx)
+{
+    // The sboxes are derived from a NUL-terminated password, so a zero byte would silently cut it
+    if (memchr(password->buf, 0, password->len) != NULL)
+    {
+        PyErr_SetString(PyExc_ValueError, "the password must not contain zero bytes");
+        return -1;
+    }
+
+    uint8_t *terminated_password = (uint8_t *)PyMem_Malloc(password->len + 1);
+
+    if (terminated_password == NULL)
+    {
+        PyErr_NoMemory();
+        return -1;
+    }
+
+    memcpy(terminated_password, password->buf, password->len);
+    terminated_password[password->len] = '\0';
+
+    Py_BEGIN_ALLOW_THREADS
+    edes_ctx_init(ctx, terminated_password);
+    Py_END_ALLOW_THREADS
+
+    memset(terminated_password, 0, password->len);
+    PyMem_Free(terminated_password);
+
+    return 0;
+}
+
+/**
+ * Function that pads and ciphers a buffer into a new bytearray, with the GIL released
+ *
+ * @param ctx the key context (struct edes_ctx)
+ * @param plaintext the plaintext buffer (Py_buffer)
+ *
+ * @return the ciphertext (bytearray), or NULL with a Python exception set
+ */
+static PyObject *encrypt_buffer(const struct edes_ctx *ctx, const Py_buffer *plaintext)
+{
+    size_t plaintext_size = (size_t)plaintext->len;
+    size_t capacity = plaintext_size + BLOCK_SIZE - (plaintext_size % BLOCK_SIZE);
+    PyObject *ciphertext = PyByteArray_FromStringAndSize(NULL, (Py_ssize_t)capacity);
+
+    if (ciphertext == NULL)
+    {
+        return NULL;
+    }
+
+    // The plaintext is padded and ciphered directly in the bytearray
+    uint8_t *output = (uint8_t *)PyByteArray_AS_STRING(ciphertext);
+    size_t ciphertext_size;
+    int status;
+
+    Py_BEGIN_ALLOW_THREADS
+    status = edes_encrypt_into(ctx, (const uint8_t *)plaintext->buf, plaintext_size, output, capacity, &ciphertext_size);
+    Py_END_ALLOW_THREADS
+
+    if (status != EDES_OK)
+    {
+        Py_DECREF(ciphertext);
+        PyErr_SetString(PyExc_RuntimeError, "error ciphering the plaintext");
+        return NULL;
+    }
+
+    return ciphertext;
+}
+
+/**
+ * Function that deciphers a buffer into a new bytearray and removes the padding, with the GIL released
+ *
+ * @param ctx the key context (struct edes_ctx)
+ * @param ciphertext the ciphertext buffer, multiple of BLOCK_SIZE bytes, an empty one gives an empty plaintext like python_decrypt and the e-des binary (Py_buffer)
+ *
+ * @return the plaintext (bytearray), or NULL with a Python exception set
+ */
+static PyObject *decrypt_buffer(const struct edes_ctx *ctx, const Py_buffer *ciphertext)
+{
+    size_t ciphertext_size = (size_t)ciphertext->len;
+
+    if (ciphertext_size == 0)
+    {
+        return PyByteArray_FromStringAndSize(NULL, 0);
+    }
+
+    if (ciphertext_size % BLOCK_SIZE != 0)
+    {
+        PyErr_SetString(PyExc_ValueError, "the ciphertext size is not a multiple of the block size");
+        return NULL;
+    }
+
+    PyObject *plaintext = PyByteArray_FromStringAndSize(NULL, (Py_ssize_t)ciphertext_size);
+
+    if (plaintext == NULL)
+    {
+        return NULL;
+    }
+
+    uint8_t *output = (uint8_t *)PyByteArray_AS_STRING(plaintext);
+    size_t plaintext_size;
+    int status;
+
+    Py_BEGIN_ALLOW_THREADS
+    status = edes_decrypt_into(ctx, (const uint8_t *)ciphertext->buf, ciphertext_size, output, ciphertext_size, &plaintext_size);
+    Py_END_ALLOW_THREADS
+
+    // Only the padding is dropped, the bytearray shrinks in place
+    if (status != EDES_OK || PyByteArray_Resize(plaintext, (Py_ssize_t)plaintext_size) != 0)
+    {
+        Py_DECREF(plaintext);
+
+        if (!PyErr_Occurred())
+        {
+            PyErr_SetString(PyExc_RuntimeError, "error deciphering the ciphertext");
+        }
+        return NULL;
+    }
+
+    return plaintext;
+}
+
+/**
+ * Function that ciphers/deciphers the whole blocks of a writable buffer in place, without padding, with the GIL released
+ *
+ * @param ctx the key context (struct edes_ctx)
+ * @param arguments the arguments, a writable buffer (PyObject)
+ * @param function e_des_encrypt_blocks or e_des_decrypt_blocks (block_cipher_function)
+ *
+ * @return None, or NULL with a Python exception set
+ */
+static PyObject *blocks_in_place(const struct edes_ctx *ctx, PyObject *arguments, block_cipher_function function)
+{
+    Py_buffer blocks;
+
+    if (!PyArg_ParseTuple(arguments, "w*", &blocks))
+    {
+        return NULL;
+    }
+
+    if (blocks.len % BLOCK_SIZE != 0)
+    {
+        PyBuffer_Release(&blocks);
+        PyErr_SetString(PyExc_ValueError, "the buffer size is not a multiple of the block size");
+        return NULL;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    function((uint8_t *)blocks.buf, (size_t)blocks.len, ctx->sboxes);
+    Py_END_ALLOW_THREADS
+
+    PyBuffer_Release(&blocks);
+    Py_RETURN_NONE;
+}
+
+/**
+ * Function that creates a Key object, the key context is derived here and never changed afterwards (there is no __init__), so a Key is never used
+ * before its sboxes exist and they cannot be replaced while another thread ciphers with the GIL released
+ *
+ * @param type the Key type (PyTypeObject)
+ * @param arguments the arguments, the password (PyObject)
+ * @param keywords the keyword arguments (PyObject)
+ *
+ * @return the Key object, or NULL with a Python exception set
+ */
+static PyObject *Key_new(PyTypeObject *type, PyObject *arguments, PyObject *keywords)
+{
+    static char *keyword_list[] = {"password", NULL};
+    Py_buffer password;
+
+    if (!PyArg_ParseTupleAndKeywords(arguments, keywords, "y*", keyword_list, &password))
+    {
+        return NULL;
+    }
+
+    // tp_alloc zeroes the object, so the dealloc of a failed Key only clears zeros
+    KeyObject *self = (KeyObject *)type->tp_alloc(type, 0);
+
+    if (self != NULL && init_ctx_from_buffer(&password, &self->ctx) != 0)
+    {
+        Py_DECREF(self);
+        self = NULL;
+    }
+
+    PyBuffer_Release(&password);
+
+    return (PyObject *)self;
+}
+
+static void Key_dealloc(KeyObject *self)
+{
+    edes_ctx_clear(&self->ctx);
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static PyObject *Key_encrypt(KeyObject *self, PyObject *arguments)
+{
+    Py_buffer plaintext;
+
+    if (!PyArg_ParseTuple(arguments, "y*", &plaintext))
+    {
+        return NULL;
+    }
+
+    PyObject *ciphertext = encrypt_buffer(&self->ctx, &plaintext);
+    PyBuffer_Release(&plaintext);
+
+    return ciphertext;
+}
+
+static PyObject *Key_decrypt(KeyObject *self, PyObject *arguments)
+{
+    Py_buffer ciphertext;
+
+    if (!PyArg_ParseTuple(arguments, "y*", &ciphertext))
+    {
+        return NULL;
+    }
+
+    PyObject *plaintext = decrypt_buffer(&self->ctx, &ciphertext);
+    PyBuffer_Release(&ciphertext);
+
+    return plaintext;
+}
+
+static PyObject *Key_encrypt_blocks(KeyObject *self, PyObject *arguments)
+{
+    return blocks_in_place(&self->ctx, arguments, e_des_encrypt_blocks);
+}
+
+static PyObject *Key_decrypt_blocks(KeyObject *self, PyObject *arguments)
+{
+    return blocks_in_place(&self->ctx, arguments, e_des_decrypt_blocks);
+}
+
+static PyMethodDef Key_methods[] = {
+    {"encrypt", (PyCFunction)Key_encrypt, METH_VARARGS, "encrypt(plaintext) -> bytearray, pads and ciphers the plaintext"},
+    {"decrypt", (PyCFunction)Key_decrypt, METH_VARARGS, "decrypt(ciphertext) -> bytearray, deciphers the ciphertext and removes the padding"},
+    {"encrypt_blocks", (PyCFunction)Key_encrypt_blocks, METH_VARARGS, "encrypt_blocks(buffer) -> None, ciphers the blocks of a writable buffer in place (no padding)"},
+    {"decrypt_blocks", (PyCFunction)Key_decrypt_blocks, METH_VARARGS, "decrypt_blocks(buffer) -> None, deciphers the blocks of a writable buffer in place (no padding)"},
+    {NULL, NULL, 0, NULL},
+};
+
+static PyTypeObject KeyType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "_e_des.Key",
+    .tp_doc = "Key(password), the sboxes derived once from the password, can be shared between threads",
+    .tp_basicsize = sizeof(KeyObject),
+    .tp_itemsize = 0,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_new = Key_new,
+    .tp_dealloc = (destructor)Key_dealloc,
+    .tp_methods = Key_methods,
+};
+
+static PyObject *module_generate_sboxes(PyObject *module, PyObject *arguments)
+{
+    Py_buffer password;
+    struct edes_ctx ctx;
+
+    if (!PyArg_ParseTuple(arguments, "y*", &password))
+    {
+        return NULL;
+    }
+
+    int result = init_ctx_from_buffer(&password, &ctx);
+    PyBuffer_Release(&password);
+
+    if (result != 0)
+    {
+        return NULL;
+    }
+
+    PyObject *sboxes = PyList_New(NUMBER_OF_S_BOXES);
+
+    for (int index = 0; sboxes != NULL && index < NUMBER_OF_S_BOXES; index++)
+    {
+        PyObject *sbox = PyByteArray_FromStringAndSize((const char *)ctx.sboxes[index].sbox, S_BOX_SIZE);
+
+        if (sbox == NULL)
+        {
+            Py_CLEAR(sboxes);
+            break;
+        }
+
+        PyList_SET_ITEM(sboxes, index, sbox);
+    }
+
+    edes_ctx_clear(&ctx);
+
+    return sboxes;
+}
+
+/**
+ * Function that parses the (data, password) arguments of encrypt/decrypt and runs the operation with a temporary key context
+ *
+ * @param arguments the arguments (PyObject)
+ * @param operation encrypt_buffer or decrypt_buffer (function)
+ *
+ * @return the result (bytearray), or NULL with a Python exception set
+ */
+static PyObject *with_password(PyObject *arguments, PyObject *(*operation)(const struct edes_ctx *, const Py_buffer *))
+{
+    Py_buffer data, password;
+
+    if (!PyArg_ParseTuple(arguments, "y*y*", &data, &password))
+    {
+        return NULL;
+    }
+
+    // The key context is 4KiB, on the heap so the stack of small threads is not an issue
+    struct edes_ctx *ctx = (struct edes_ctx *)PyMem_Malloc(sizeof(struct edes_ctx));
+    PyObject *result = NULL;
+
+    if (ctx == NULL)
+    {
+        PyErr_NoMemory();
+    }
+    else if (init_ctx_from_buffer(&password, ctx) == 0)
+    {
+        result = operation(ctx, &data);
+    }
+
+    if (ctx != NULL)
+    {
+        edes_ctx_clear(ctx);
+        PyMem_Free(ctx);
+    }
+
+    PyBuffer_Release(&data);
+    PyBuffer_Release(&password);
+
+    return result;
+}
+
+static PyObject *module_encrypt(PyObject *module, PyObject *arguments)
+{
+    return with_password(arguments, encrypt_buffer);
+}
+
+static PyObject *module_decrypt(PyObject *module, PyObject *arguments)
+{
+    return with_password(arguments, decrypt_buffer);
+}
+
+static PyObject *module_kernel_name(PyObject *module, PyObject *unused)
+{
+    return PyUnicode_FromString(e_des_kernel_name());
+}
+
+static PyMethodDef module_methods[] = {
+    {"generate_sboxes", module_generate_sboxes, METH_VARARGS, "generate_sboxes(password) -> list, the sboxes derived from the password"},
+    {"encrypt", module_encrypt, METH_VARARGS, "encrypt(plaintext, password) -> bytearray, pads and ciphers the plaintext"},
+    {"decrypt", module_decrypt, METH_VARARGS, "decrypt(ciphertext, password) -> bytearray, deciphers the ciphertext and removes the padding"},
+    {"kernel_name", module_kernel_name, METH_NOARGS, "kernel_name() -> str, the block kernel picked for this CPU"},
+    {NULL, NULL, 0, NULL},
+};
+
+static struct PyModuleDef e_des_module = {
+    PyModuleDef_HEAD_INIT,
+    .m_name = "_e_des",
+    .m_doc = "Native E-DES, backed by the C implementation",
+    .m_size = -1,
+    .m_methods = module_methods,
+};
+
+PyMODINIT_FUNC PyInit__e_des(void)
+{
+    if (PyType_Ready(&KeyType) < 0)
+    {
+        return NULL;
+    }
+
+    PyObject *module = PyModule_Create(&e_des_module);
+
+    if (module == NULL)
+    {
+        return NULL;
+    }
+
+    Py_INCREF(&KeyType);
+    if (PyModule_AddObject(module, "Key", (PyObject *)&KeyType) < 0 || PyModule_AddIntConstant(module, "BLOCK_SIZE", BLOCK_SIZE) < 0)
+    {
+        Py_DECREF(&KeyType);
+        Py_DECREF(module);
+        return NULL;
+    }
+
+    return module;
+}
@@ -1,24 +1,36 @@
 #include "implementation.h"
+#include "simd.h"
+#include "stats.h"
+#include <pthread.h>
+#include <openssl/provider.h>
+
+// The lane loops must be unrolled so the state of the independent lanes stays in registers
+#if defined(__clang__)
+#define UNROLL_LANES _Pragma("unroll")
+#elif defined(__GNUC__)
+#define UNROLL_LANES _Pragma("GCC unroll 16")
+#else
+#define UNROLL_LANES
+#endif
 
 void read_bytes(uint8_t *readed_bytes, size_t *number_of_readed_bytes)
 {
-    uint8_t byte;
-    *number_of_readed_bytes = 0;
-
-    size_t IS_READED = 1;
-    while (fread(&byte, sizeof(uint8_t), 1, stdin) == IS_READED)
-    {
-        readed_bytes[*number_of_readed_bytes] = byte;
-        *number_of_readed_bytes = *number_of_readed_bytes + 1;
-    }
+    STATS_START(start);
+    *number_of_readed_bytes = fread(readed_bytes, sizeof(uint8_t), MAX_BYTES, stdin);
+    STATS_STOP(STATS_READ_BYTES, start, *number_of_readed_bytes);
 }
 
 void write_bytes(const uint8_t *bytes_to_write, const size_t number_of_bytes_to_write)
 {
-    for (size_t byte_writed = 0; byte_writed < number_of_bytes_to_write; byte_writed++)
+    STATS_START(start);
+
+    if (fwrite(bytes_to_write, sizeof(uint8_t), number_of_bytes_to_write, stdout) != number_of_bytes_to_write)
     {
-        fwrite(&bytes_to_write[byte_writed], sizeof(uint8_t), 1, stdout);
+        fprintf(stderr, "Error writing to stdout\n");
+        exit(1);
     }
+
+    STATS_STOP(STATS_WRITE_BYTES, start, number_of_bytes_to_write);
 }
 
 void feistel_function(const uint8_t *input_block, const uint8_t *s_box, uint8_t *output_block)
@@ -36,44 +48,105 @@ void feistel_function(const uint8_t *input_block, const uint8_t *s_box, uint8_t
     output_block[3] = s_box[index];
 }
 
-void feistel_network(uint8_t *block, const struct s_box *sboxes)
+/**
+ * Function that loads a half block as a 32-bit word (byte 0 in the low bits, on any endianness)
+ *
+ * @param half_block the half block (uint8_t array)
+ *
+ * @return the half block (uint32_t)
+ */
+static inline uint32_t load_half_block(const uint8_t *half_block)
 {
-    uint8_t *L = block;
-    uint8_t *R = block + HALF_BLOCK_SIZE;
-    uint8_t *feistel_result = (uint8_t *)malloc(HALF_BLOCK_SIZE);
-
-    for (int round = 0; round < NUMBER_OF_ROUNDS; round++)
-    {
-        feistel_function(R, sboxes[round].sbox, feistel_result);
+    return (uint32_t)half_block[0] | ((uint32_t)half_block[1] << 8) | ((uint32_t)half_block[2] << 16) | ((uint32_t)half_block[3] << 24);
+}
 
-        for (int index = 0; index < HALF_BLOCK_SIZE; index++)
-        {
-            uint8_t temp = L[index] ^ feistel_result[index];
-            L[index] = R[index];
-            R[index] = temp;
-        }
-    }
-    free(feistel_result);
+/**
+ * Function that stores a 32-bit word as a half block (byte 0 from the low bits)
+ *
+ * @param half_block the half block (uint8_t array)
+ * @param value the half block (uint32_t)
+ */
+static inline void store_half_block(uint8_t *half_block, uint32_t value)
+{
+    half_block[0] = (uint8_t)value;
+    half_block[1] = (uint8_t)(value >> 8);
+    half_block[2] = (uint8_t)(value >> 16);
+    half_block[3] = (uint8_t)(value >> 24);
 }
 
-void inverse_feistel_network(const uint8_t *block, const struct s_box *sboxes)
+/**
+ * Function that does the feistel function on a 32-bit half block, the same operation as feistel_function with the indexes kept in registers
+ *
+ * @param input_block the input half block (uint32_t)
+ * @param s_box the sbox (uint8_t array)
+ *
+ * @return the output half block (uint32_t)
+ */
+static inline uint32_t feistel_function_32(uint32_t input_block, const uint8_t *s_box)
 {
-    uint8_t *L = block;
-    uint8_t *R = block + HALF_BLOCK_SIZE;
-    uint8_t *feistel_result = (uint8_t *)malloc(HALF_BLOCK_SIZE);
+    uint8_t index = (uint8_t)(input_block >> 24);
+    uint32_t output_block = s_box[index];
 
-    for (int round = NUMBER_OF_ROUNDS - 1; round >= 0; round--)
-    {
-        feistel_function(L, sboxes[round].sbox, feistel_result);
+    index = (uint8_t)(index + (input_block >> 16));
+    output_block |= (uint32_t)s_box[index] << 8;
 
-        for (int index = 0; index < HALF_BLOCK_SIZE; index++)
-        {
-            uint8_t temp = R[index] ^ feistel_result[index];
-            R[index] = L[index];
-            L[index] = temp;
-        }
-    }
-    free(feistel_result);
+    index = (uint8_t)(index + (input_block >> 8));
+    output_block |= (uint32_t)s_box[index] << 16;
+
+    index = (uint8_t)(index + input_block);
+    output_block |= (uint32_t)s_box[index] << 24;
+
+    return output_block;
+}
+
+#if NUMBER_OF_ROUNDS != 16
+#error "feistel_network and inverse_feistel_network are unrolled for 16 rounds"
+#endif
+
+// Two rounds of the feistel network, the halves are updated in place instead of being swapped
+#define FEISTEL_ROUND_PAIR(L, R, sboxes, round)                 \
+    L ^= feistel_function_32(R, (sboxes)[(round)].sbox);        \
+    R ^= feistel_function_32(L, (sboxes)[(round) + 1].sbox);
+
+// Two rounds of the inverse feistel network, from the round + 1 to the round
+#define INVERSE_FEISTEL_ROUND_PAIR(L, R, sboxes, round)         \
+    R ^= feistel_function_32(L, (sboxes)[(round) + 1].sbox);    \
+    L ^= feistel_function_32(R, (sboxes)[(round)].sbox);
+
+void feistel_network(uint8_t *block, const struct s_box *sboxes)
+{
+    uint32_t L = load_half_block(block);
+    uint32_t R = load_half_block(block + HALF_BLOCK_SIZE);
+
+    FEISTEL_ROUND_PAIR(L, R, sboxes, 0)
+    FEISTEL_ROUND_PAIR(L, R, sboxes, 2)
+    FEISTEL_ROUND_PAIR(L, R, sboxes, 4)
+    FEISTEL_ROUND_PAIR(L, R, sboxes, 6)
+    FEISTEL_ROUND_PAIR(L, R, sboxes, 8)
+    FEISTEL_ROUND_PAIR(L, R, sboxes, 10)
+    FEISTEL_ROUND_PAIR(L, R, sboxes, 12)
+    FEISTEL_ROUND_PAIR(L, R, sboxes, 14)
+
+    store_half_block(block, L);
+    store_half_block(block + HALF_BLOCK_SIZE, R);
+}
+
+void inverse_feistel_network(uint8_t *block, const struct s_box *sboxes)
+{
+    uint32_t L = load_half_block(block);
+    uint32_t R = load_half_block(block + HALF_BLOCK_SIZE);
+
+    INVERSE_FEISTEL_ROUND_PAIR(L, R, sboxes, 14)
+    INVERSE_FEISTEL_ROUND_PAIR(L, R, sboxes, 12)
+    INVERSE_FEISTEL_ROUND_PAIR(L, R, sboxes, 10)
+    INVERSE_FEISTEL_ROUND_PAIR(L, R, sboxes, 8)
+    INVERSE_FEISTEL_ROUND_PAIR(L, R, sboxes, 6)
+    INVERSE_FEISTEL_ROUND_PAIR(L, R, sboxes, 4)
+    INVERSE_FEISTEL_ROUND_PAIR(L, R, sboxes, 2)
+    INVERSE_FEISTEL_ROUND_PAIR(L, R, sboxes, 0)
+
+    store_half_block(block, L);
+    store_half_block(block + HALF_BLOCK_SIZE, R);
 }
 
 void generate_key(const uint8_t *password, uint8_t *key)
@@ -95,9 +168,9 @@ void generate_single_sbox(const uint8_t *password, uint8_t *single_sbox)
         single_sbox[index] = index;
     }
 
-    for (int currentIndex = 0; currentIndex < S_BOX_SIZE; currentIndex++)
+    for (unsigned int currentIndex = 0; currentIndex < S_BOX_SIZE; currentIndex++)
     {
-        int newIndex = (currentIndex + key[currentIndex % SHA256_DIGEST_LENGTH]) % S_BOX_SIZE;
+        unsigned int newIndex = (currentIndex + key[currentIndex % SHA256_DIGEST_LENGTH]) % S_BOX_SIZE;
         uint8_t currentByte = single_sbox[currentIndex];
 
         single_sbox[currentIndex] = single_sbox[newIndex];
@@ -107,21 +180,18 @@ void generate_single_sbox(const uint8_t *password, uint8_t *single_sbox)
     memset(key, 0, SHA256_DIGEST_LENGTH);
 }
 
-void round_robin_shuffle(uint8_t *array, size_t size)
+int round_robin_shuffle_into(const uint8_t *array, uint8_t *shuffled_array, size_t size)
 {
-    uint8_t *shuffledArray = (uint8_t *)malloc(size);
-
-    if (shuffledArray == NULL)
+    if (array == shuffled_array)
     {
-        fprintf(stderr, "Memory allocation error\n");
-        exit(1);
+        return EDES_ERROR_INVALID_ARGUMENT;
     }
 
     size_t shift = 1;
     size_t new_index = 0;
     for (size_t index = 0; index < size; index++)
     {
-        shuffledArray[new_index] = array[index];
+        shuffled_array[new_index] = array[index];
         new_index = (new_index + shift) % size;
 
         shift++;
@@ -131,55 +201,100 @@ void round_robin_shuffle(uint8_t *array, size_t size)
         }
     }
 
-    for (size_t index = 0; index < size; index++)
+    return EDES_OK;
+}
+
+void round_robin_shuffle(uint8_t *array, size_t size)
+{
+    uint8_t *shuffledArray = (uint8_t *)malloc(size);
+
+    if (shuffledArray == NULL)
     {
-        array[index] = shuffledArray[index];
+        fprintf(stderr, "Memory allocation error\n");
+        exit(1);
     }
 
+    round_robin_shuffle_into(array, shuffledArray, size);
+    memcpy(array, shuffledArray, size);
+
     free(shuffledArray);
 }
 
+#define SBOX_DERIVATION_LANES 4
+
+#if (NUMBER_OF_BYTES_IN_ALL_S_BOXES & (NUMBER_OF_BYTES_IN_ALL_S_BOXES - 1)) != 0 || (NUMBER_OF_BYTES_IN_ALL_S_BOXES / SBOX_DERIVATION_LANES) % S_BOX_SIZE != 0
+#error "generate_sboxes needs NUMBER_OF_BYTES_IN_ALL_S_BOXES to be a power of two split in lanes of whole sboxes"
+#endif
+
 void generate_sboxes(const uint8_t *password, struct s_box *sboxes)
 {
-    uint8_t *single_sbox = (uint8_t *)malloc(S_BOX_SIZE);
+    uint8_t single_sbox[S_BOX_SIZE];
+    generate_single_sbox(password, single_sbox);
 
-    if (single_sbox == NULL) // memory allocation error
+    // Same result as round_robin_shuffle over NUMBER_OF_S_BOXES copies of the single sbox, written directly in the
+    // (contiguous) sboxes: the byte at index goes to index * (index + 1) / 2, built incrementally and masked.
+    // The indexes are split in SBOX_DERIVATION_LANES independent ranges so the stores do not wait on one chain
+    uint8_t *all_sboxes = (uint8_t *)sboxes;
+    const size_t lane_size = NUMBER_OF_BYTES_IN_ALL_S_BOXES / SBOX_DERIVATION_LANES;
+    size_t new_index[SBOX_DERIVATION_LANES];
+
+    for (int lane = 0; lane < SBOX_DERIVATION_LANES; lane++)
     {
-        printf("Error allocating memory for single sbox\n");
-        exit(1);
+        size_t first_index = lane * lane_size;
+        new_index[lane] = (first_index * (first_index + 1) / 2) & (NUMBER_OF_BYTES_IN_ALL_S_BOXES - 1);
     }
 
-    generate_single_sbox(password, single_sbox);
+    for (size_t index = 0; index < lane_size; index++)
+    {
+        uint8_t byte = single_sbox[index & (S_BOX_SIZE - 1)]; // lane_size is a multiple of S_BOX_SIZE
+
+        UNROLL_LANES
+        for (int lane = 0; lane < SBOX_DERIVATION_LANES; lane++)
+        {
+            all_sboxes[new_index[lane]] = byte;
+            new_index[lane] = (new_index[lane] + lane * lane_size + index + 1) & (NUMBER_OF_BYTES_IN_ALL_S_BOXES - 1);
+        }
+    }
 
-    uint8_t *random_bytes = (uint8_t *)malloc(NUMBER_OF_BYTES_IN_ALL_S_BOXES);
+    memset(single_sbox, 0, S_BOX_SIZE);
+}
 
-    if (random_bytes == NULL) // memory allocation error
+void generate_iv(uint8_t *iv)
+{
+    if (RAND_bytes(iv, IV_SIZE) != 1)
     {
-        printf("Error allocating memory for random bytes\n");
+        fprintf(stderr, "Error generating the IV\n");
         exit(1);
     }
+}
+
+size_t apply_padding(uint8_t *buffer, size_t plaintext_length)
+{
+    size_t padding_bytes = BLOCK_SIZE - (plaintext_length % BLOCK_SIZE);
 
-    for (int index = 0; index < NUMBER_OF_S_BOXES; index++)
+    for (size_t index = plaintext_length; index < plaintext_length + padding_bytes; index++)
     {
-        for (int item_index = 0; item_index < S_BOX_SIZE; item_index++)
-        {
-            random_bytes[index * S_BOX_SIZE + item_index] = single_sbox[item_index];
-        }
+        buffer[index] = padding_bytes + '0';
     }
 
-    free(single_sbox);
+    return plaintext_length + padding_bytes;
+}
+
+size_t get_padding_size(const uint8_t *padded_plaintext, size_t padded_length)
+{
+    if (padded_length == 0)
+    {
+        return 0;
+    }
 
-    round_robin_shuffle(random_bytes, NUMBER_OF_BYTES_IN_ALL_S_BOXES);
+    size_t padding_bytes = padded_plaintext[padded_length - 1] - '0';
 
-    for (int sbox_index = 0; sbox_index < NUMBER_OF_S_BOXES; sbox_index++)
+    if (padding_bytes > BLOCK_SIZE || padding_bytes > padded_length)
     {
-        for (int item_index = 0; item_index < S_BOX_SIZE; item_index++)
-        {
-            sboxes[sbox_index].sbox[item_index] = random_bytes[sbox_index * S_BOX_SIZE + item_index];
-        }
+        padding_bytes = 0;
     }
 
-    free(random_bytes);
+    return padding_bytes;
 }
 
 void add_padding(const uint8_t *plaintext, size_t plaintext_length, uint8_t **padded_plaintext, size_t *padded_length)
@@ -197,27 +312,14 @@ void add_padding(const uint8_t *plaintext, size_t plaintext_length, uint8_t **pa
         exit(1);
     }
 
-    // Copy the original plaintext
-    for (size_t index = 0; index < plaintext_length; index++)
-    {
-        (*padded_plaintext)[index] = plaintext[index];
-    }
-
-    // Add padding before the null terminator
-    for (size_t index = plaintext_length; index < *padded_length; index++)
-    {
-        (*padded_plaintext)[index] = padding_bytes + '0';
-    }
+    // Copy the original plaintext and add the padding after it
+    memcpy(*padded_plaintext, plaintext, plaintext_length);
+    apply_padding(*padded_plaintext, plaintext_length);
 }
 
 void remove_padding(const uint8_t *padded_plaintext, size_t padded_length, uint8_t **plaintext, size_t *plaintext_length)
 {
-    size_t padding_bytes = padded_plaintext[padded_length - 1] - '0';
-
-    if (padding_bytes > BLOCK_SIZE)
-    {
-        padding_bytes = 0;
-    }
+    size_t padding_bytes = get_padding_size(padded_plaintext, padded_length);
 
     *plaintext_length = padded_length - padding_bytes;
 
@@ -236,152 +338,1419 @@ void remove_padding(const uint8_t *padded_plaintext, size_t padded_length, uint8
     }
 }
 
-void encrypt(const uint8_t *plaintext, const uint8_t *password, uint8_t **ciphertext, size_t *ciphertext_size)
+int add_padding_into(const uint8_t *plaintext, size_t plaintext_length, uint8_t *padded_plaintext, size_t padded_capacity, size_t *padded_length)
 {
-    size_t plaintext_size = strlen((char *)plaintext);
+    size_t padding_bytes = BLOCK_SIZE - (plaintext_length % BLOCK_SIZE);
+
+    if (padded_capacity < plaintext_length + padding_bytes)
+    {
+        return EDES_ERROR_BUFFER_TOO_SMALL;
+    }
+
+    memmove(padded_plaintext, plaintext, plaintext_length);
+    *padded_length = apply_padding(padded_plaintext, plaintext_length);
 
-    uint8_t *padded_plaintext;
-    size_t padded_plaintext_size;
-    add_padding(plaintext, plaintext_size, &padded_plaintext, &padded_plaintext_size);
+    return EDES_OK;
+}
 
-    struct s_box *sboxes = (struct s_box *)malloc(sizeof(struct s_box) * NUMBER_OF_ROUNDS);
+int remove_padding_into(const uint8_t *padded_plaintext, size_t padded_length, uint8_t *plaintext, size_t plaintext_capacity, size_t *plaintext_length)
+{
+    size_t length = padded_length - get_padding_size(padded_plaintext, padded_length);
 
-    if (sboxes == NULL) // memory allocation error
+    if (plaintext_capacity < length)
     {
-        printf("Error allocating memory for sboxes\n");
-        exit(1);
+        return EDES_ERROR_BUFFER_TOO_SMALL;
+    }
+
+    memmove(plaintext, padded_plaintext, length);
+    *plaintext_length = length;
+
+    return EDES_OK;
+}
+
+void edes_arena_init(struct edes_arena *arena, void *memory, size_t size)
+{
+    arena->memory = (uint8_t *)memory;
+    arena->size = size;
+    arena->used = 0;
+}
+
+void *edes_arena_alloc(struct edes_arena *arena, size_t size)
+{
+    // Every allocation starts on an EDES_ARENA_ALIGNMENT boundary
+    size_t start = (arena->used + EDES_ARENA_ALIGNMENT - 1) & ~(size_t)(EDES_ARENA_ALIGNMENT - 1);
+
+    if (start > arena->size || size > arena->size - start)
+    {
+        return NULL;
     }
 
-    generate_sboxes(password, sboxes);
+    arena->used = start + size;
 
-    *ciphertext = (uint8_t *)malloc(padded_plaintext_size);
+    return arena->memory + start;
+}
+
+void edes_arena_reset(struct edes_arena *arena)
+{
+    arena->used = 0;
+}
 
-    if (*ciphertext == NULL) // Check for memory allocation error
+int edes_encrypt_into(const struct edes_ctx *ctx, const uint8_t *plaintext, size_t plaintext_size, uint8_t *ciphertext, size_t ciphertext_capacity, size_t *ciphertext_size)
+{
+    int status = add_padding_into(plaintext, plaintext_size, ciphertext, ciphertext_capacity, ciphertext_size);
+
+    if (status != EDES_OK)
     {
-        printf("Error allocating memory for ciphertext\n");
-        exit(1);
+        return status;
     }
 
-    for (size_t block_index = 0; block_index < padded_plaintext_size; block_index += BLOCK_SIZE)
+    e_des_encrypt_blocks(ciphertext, *ciphertext_size, ctx->sboxes);
+
+    return EDES_OK;
+}
+
+int edes_decrypt_into(const struct edes_ctx *ctx, const uint8_t *ciphertext, size_t ciphertext_size, uint8_t *plaintext, size_t plaintext_capacity, size_t *plaintext_size)
+{
+    if (ciphertext_size == 0 || ciphertext_size % BLOCK_SIZE != 0)
     {
+        return EDES_ERROR_INVALID_SIZE;
+    }
 
-        feistel_network((uint8_t *) (padded_plaintext + block_index), sboxes);
+    // The last block is deciphered first, on the stack, to know the plaintext size before writing the output
+    uint8_t last_block[BLOCK_SIZE];
+    size_t full_blocks_size = ciphertext_size - BLOCK_SIZE;
 
-        for (int index = 0; index < BLOCK_SIZE; index++)
-        {
-            (*ciphertext)[block_index + index] = padded_plaintext[block_index + index];
-        }
+    memcpy(last_block, ciphertext + full_blocks_size, BLOCK_SIZE);
+    e_des_decrypt_blocks(last_block, BLOCK_SIZE, ctx->sboxes);
+
+    size_t last_block_size = BLOCK_SIZE - get_padding_size(last_block, BLOCK_SIZE);
+
+    if (plaintext_capacity < full_blocks_size + last_block_size)
+    {
+        memset(last_block, 0, BLOCK_SIZE);
+        return EDES_ERROR_BUFFER_TOO_SMALL;
     }
 
-    // Update the ciphertext size
-    *ciphertext_size = padded_plaintext_size;
+    memmove(plaintext, ciphertext, full_blocks_size);
+    e_des_decrypt_blocks(plaintext, full_blocks_size, ctx->sboxes);
+    memcpy(plaintext + full_blocks_size, last_block, last_block_size);
+
+    *plaintext_size = full_blocks_size + last_block_size;
+    memset(last_block, 0, BLOCK_SIZE);
 
-    // Free memory
-    free(sboxes);
+    return EDES_OK;
 }
 
-void decrypt(const uint8_t *ciphertext, const size_t ciphertext_size, const uint8_t *password, uint8_t **plaintext, size_t *plaintext_size)
+int edes_encrypt_arena(const struct edes_ctx *ctx, struct edes_arena *arena, const uint8_t *plaintext, size_t plaintext_size, uint8_t **ciphertext, size_t *ciphertext_size)
 {
-    struct s_box *sboxes = (struct s_box *)malloc(sizeof(struct s_box) * NUMBER_OF_ROUNDS);
+    size_t capacity = plaintext_size + BLOCK_SIZE - (plaintext_size % BLOCK_SIZE);
+    *ciphertext = (uint8_t *)edes_arena_alloc(arena, capacity);
 
-    if (sboxes == NULL) // memory allocation error
+    if (*ciphertext == NULL)
     {
-        printf("Error allocating memory for sboxes\n");
-        exit(1);
+        return EDES_ERROR_BUFFER_TOO_SMALL;
     }
 
-    generate_sboxes(password, sboxes);
+    return edes_encrypt_into(ctx, plaintext, plaintext_size, *ciphertext, capacity, ciphertext_size);
+}
 
-    size_t padded_plaintext_size = ciphertext_size;
-    uint8_t *padded_plaintext = (uint8_t *)malloc(padded_plaintext_size);
+int edes_decrypt_arena(const struct edes_ctx *ctx, struct edes_arena *arena, const uint8_t *ciphertext, size_t ciphertext_size, uint8_t **plaintext, size_t *plaintext_size)
+{
+    *plaintext = (uint8_t *)edes_arena_alloc(arena, ciphertext_size);
 
-    if (padded_plaintext == NULL) // memory allocation error
+    if (*plaintext == NULL)
     {
-        printf("Error allocating memory for padded plaintext\n");
-        exit(1);
+        return EDES_ERROR_BUFFER_TOO_SMALL;
+    }
+
+    return edes_decrypt_into(ctx, ciphertext, ciphertext_size, *plaintext, ciphertext_size, plaintext_size);
+}
+
+void edes_ctx_init(struct edes_ctx *ctx, const uint8_t *password)
+{
+    generate_sboxes(password, ctx->sboxes);
+}
+
+void edes_ctx_clear(struct edes_ctx *ctx)
+{
+    // Volatile pointer so the compiler does not drop the wipe of the key material
+    volatile uint8_t *bytes = (volatile uint8_t *)ctx;
+
+    for (size_t index = 0; index < sizeof(struct edes_ctx); index++)
+    {
+        bytes[index] = 0;
+    }
+}
+
+int edes_encrypt(const struct edes_ctx *ctx, const uint8_t *plaintext, size_t plaintext_size, uint8_t **ciphertext, size_t *ciphertext_size)
+{
+    // The plaintext is padded and ciphered directly in the ciphertext buffer
+    *ciphertext = (uint8_t *)malloc(plaintext_size + BLOCK_SIZE);
+
+    if (*ciphertext == NULL) // memory allocation error
+    {
+        *ciphertext_size = 0;
+        return EDES_ERROR_OUT_OF_MEMORY;
+    }
+
+    memcpy(*ciphertext, plaintext, plaintext_size);
+
+    return edes_encrypt_in_place(ctx, *ciphertext, plaintext_size, plaintext_size + BLOCK_SIZE, ciphertext_size);
+}
+
+int edes_decrypt(const struct edes_ctx *ctx, const uint8_t *ciphertext, size_t ciphertext_size, uint8_t **plaintext, size_t *plaintext_size)
+{
+    // The kernels only work on whole blocks, so a partial block would be read and written past the buffer
+    if (ciphertext_size == 0 || ciphertext_size % BLOCK_SIZE != 0)
+    {
+        *plaintext = NULL;
+        *plaintext_size = 0;
+        return EDES_ERROR_INVALID_SIZE;
+    }
+
+    // The ciphertext is left untouched, the blocks are deciphered in the plaintext buffer
+    *plaintext = (uint8_t *)malloc(ciphertext_size);
+
+    if (*plaintext == NULL) // memory allocation error
+    {
+        *plaintext_size = 0;
+        return EDES_ERROR_OUT_OF_MEMORY;
     }
 
-    for (size_t block_index = 0; block_index < ciphertext_size; block_index += BLOCK_SIZE)
+    memcpy(*plaintext, ciphertext, ciphertext_size);
+    e_des_decrypt_blocks(*plaintext, ciphertext_size, ctx->sboxes);
+
+    *plaintext_size = ciphertext_size - get_padding_size(*plaintext, ciphertext_size);
+
+    return EDES_OK;
+}
+
+size_t edes_encrypt_batch_size(const struct edes_message *messages, size_t number_of_messages)
+{
+    size_t batch_size = 0;
+
+    for (size_t message_index = 0; message_index < number_of_messages; message_index++)
     {
+        size_t size = messages[message_index].size;
+
+        // A size that does not fit saturates at SIZE_MAX, so the comparison with the arena size fails instead of wrapping
+        if (size > SIZE_MAX - BLOCK_SIZE)
+        {
+            return SIZE_MAX;
+        }
 
-        inverse_feistel_network((uint8_t *) (ciphertext + block_index), sboxes);
+        size_t padded_size = size + BLOCK_SIZE - (size % BLOCK_SIZE);
 
-        for (int index = 0; index < BLOCK_SIZE; index++)
+        if (padded_size > SIZE_MAX - batch_size)
         {
-            padded_plaintext[block_index + index] = ciphertext[block_index + index];
+            return SIZE_MAX;
         }
+
+        batch_size += padded_size;
+    }
+
+    return batch_size;
+}
+
+int edes_encrypt_batch(const struct edes_ctx *ctx, const struct edes_message *messages, size_t number_of_messages, uint8_t *arena, size_t arena_size, size_t *offsets)
+{
+    // SIZE_MAX is never a real batch size (it is not a multiple of BLOCK_SIZE), it means the sum overflowed
+    size_t batch_size = edes_encrypt_batch_size(messages, number_of_messages);
+
+    if (batch_size == SIZE_MAX || batch_size > arena_size)
+    {
+        return EDES_ERROR_BUFFER_TOO_SMALL;
+    }
+
+    // Pack the padded messages one after the other
+    size_t offset = 0;
+
+    for (size_t message_index = 0; message_index < number_of_messages; message_index++)
+    {
+        offsets[message_index] = offset;
+
+        memcpy(arena + offset, messages[message_index].data, messages[message_index].size);
+        offset += apply_padding(arena + offset, messages[message_index].size);
     }
 
-    remove_padding(padded_plaintext, padded_plaintext_size, plaintext, plaintext_size);
+    offsets[number_of_messages] = offset;
+
+    // The blocks of all the messages are ciphered as a single stream
+    e_des_encrypt_blocks(arena, offset, ctx->sboxes);
 
-    // Free memory
-    free(sboxes);
-    free(padded_plaintext);
+    return EDES_OK;
 }
 
-void ecb_encrypt(const uint8_t *plaintext, const uint8_t *password, uint8_t **ciphertext, size_t *ciphertext_size)
+int edes_decrypt_batch(const struct edes_ctx *ctx, const struct edes_message *messages, size_t number_of_messages, uint8_t *arena, size_t arena_size, size_t *offsets, size_t *plaintext_sizes)
 {
-    // Declare key schedule
-    DES_cblock des_key;
-    DES_key_schedule schedule;
-    memcpy(des_key, password, BLOCK_SIZE);
+    // Pack the ciphertexts one after the other
+    size_t offset = 0;
 
-    DES_set_odd_parity(&des_key);
-    DES_set_key_checked(&des_key, &schedule);
+    for (size_t message_index = 0; message_index < number_of_messages; message_index++)
+    {
+        size_t size = messages[message_index].size;
+
+        if (size == 0 || size % BLOCK_SIZE != 0)
+        {
+            return EDES_ERROR_INVALID_SIZE;
+        }
 
-    // Add padding
-    size_t plaintext_len = strlen((char *)plaintext);
-    size_t padded_len;
-    uint8_t *padded_plaintext;
-    add_padding(plaintext, plaintext_len, &padded_plaintext, &padded_len);
+        if (size > arena_size - offset)
+        {
+            return EDES_ERROR_BUFFER_TOO_SMALL;
+        }
 
-    // Declare ciphertext
-    *ciphertext = (uint8_t *)malloc(padded_len);
-    *ciphertext_size = padded_len;
+        offsets[message_index] = offset;
+        memcpy(arena + offset, messages[message_index].data, size);
+        offset += size;
+    }
 
-    if (*ciphertext == NULL) // memory allocation error
+    offsets[number_of_messages] = offset;
+
+    // The blocks of all the messages are deciphered as a single stream, then each message is unpadded
+    e_des_decrypt_blocks(arena, offset, ctx->sboxes);
+
+    for (size_t message_index = 0; message_index < number_of_messages; message_index++)
     {
-        printf("Error allocating memory for ciphertext\n");
-        exit(1);
+        size_t size = offsets[message_index + 1] - offsets[message_index];
+        plaintext_sizes[message_index] = size - get_padding_size(arena + offsets[message_index], size);
+    }
+
+    return EDES_OK;
+}
+
+int encrypt(const uint8_t *plaintext, size_t plaintext_size, const uint8_t *password, uint8_t **ciphertext, size_t *ciphertext_size)
+{
+    struct edes_ctx ctx;
+    edes_ctx_init(&ctx, password);
+
+    int status = edes_encrypt(&ctx, plaintext, plaintext_size, ciphertext, ciphertext_size);
+
+    edes_ctx_clear(&ctx);
+
+    return status;
+}
+
+int decrypt(const uint8_t *ciphertext, const size_t ciphertext_size, const uint8_t *password, uint8_t **plaintext, size_t *plaintext_size)
+{
+    struct edes_ctx ctx;
+    edes_ctx_init(&ctx, password);
+
+    int status = edes_decrypt(&ctx, ciphertext, ciphertext_size, plaintext, plaintext_size);
+
+    edes_ctx_clear(&ctx);
+
+    return status;
+}
+
+int ecb_encrypt(const uint8_t *plaintext, size_t plaintext_size, const uint8_t *password, uint8_t **ciphertext, size_t *ciphertext_size)
+{
+    *ciphertext = NULL;
+
+    // Generate the key
+    struct des_key key;
+    int status = generate_des_key(password, &key);
+
+    if (status != EDES_OK)
+    {
+        return status;
     }
 
-    // Encrypt
-    for (size_t block_index = 0; block_index < padded_len; block_index += BLOCK_SIZE)
+    // The plaintext is padded and ciphered directly in the ciphertext buffer
+    size_t capacity = plaintext_size + BLOCK_SIZE;
+    *ciphertext = (uint8_t *)malloc(capacity);
+
+    if (*ciphertext == NULL) // memory allocation error
     {
-        DES_ecb_encrypt((DES_cblock *)(padded_plaintext + block_index), (DES_cblock *)(*ciphertext + block_index), &schedule, DES_ENCRYPT);
+        des_key_clear(&key);
+        return EDES_ERROR_OUT_OF_MEMORY;
     }
 
-    free(padded_plaintext);
+    memcpy(*ciphertext, plaintext, plaintext_size);
+    encrypt_in_place(des_ecb_encrypt_blocks, &key, *ciphertext, plaintext_size, capacity, ciphertext_size);
+    des_key_clear(&key);
+
+    return EDES_OK;
 }
 
-void ecb_decrypt(const uint8_t *ciphertext, const size_t ciphertext_size, const uint8_t *password, uint8_t **plaintext, size_t *plaintext_size)
+int ecb_decrypt(const uint8_t *ciphertext, const size_t ciphertext_size, const uint8_t *password, uint8_t **plaintext, size_t *plaintext_size)
 {
-    // Declare key schedule
-    DES_cblock des_key;
-    DES_key_schedule schedule;
-    memcpy(des_key, password, BLOCK_SIZE);
+    *plaintext = NULL;
 
-    DES_set_odd_parity(&des_key);
-    DES_set_key_checked(&des_key, &schedule);
+    // Generate the key
+    struct des_key key;
+    int status = generate_des_key(password, &key);
 
-    // Declare plaintext
-    size_t padded_plaintext_len = ciphertext_size;
-    uint8_t *padded_plaintext = (uint8_t *)malloc(padded_plaintext_len);
+    if (status != EDES_OK)
+    {
+        return status;
+    }
 
-    if (padded_plaintext == NULL) // memory allocation error
+    // The ciphertext is left untouched, the blocks are deciphered in the plaintext buffer
+    *plaintext = (uint8_t *)malloc(ciphertext_size > 0 ? ciphertext_size : 1);
+
+    if (*plaintext == NULL) // memory allocation error
     {
-        printf("Error allocating memory for padded plaintext\n");
-        exit(1);
+        des_key_clear(&key);
+        return EDES_ERROR_OUT_OF_MEMORY;
+    }
+
+    memcpy(*plaintext, ciphertext, ciphertext_size);
+
+    status = decrypt_in_place(des_ecb_decrypt_blocks, &key, *plaintext, ciphertext_size, plaintext_size);
+    des_key_clear(&key);
+
+    if (status != EDES_OK)
+    {
+        free(*plaintext);
+        *plaintext = NULL;
+    }
+
+    return status;
+}
+
+void e_des_encrypt_blocks_scalar(uint8_t *blocks, size_t number_of_bytes, const void *sboxes)
+{
+    const struct s_box *s_boxes = (const struct s_box *)sboxes;
+    size_t block_index = 0;
+
+    // The rounds of INTERLEAVE_WIDTH independent blocks are interleaved so their sbox loads overlap
+    for (; block_index + INTERLEAVE_WIDTH * BLOCK_SIZE <= number_of_bytes; block_index += INTERLEAVE_WIDTH * BLOCK_SIZE)
+    {
+        uint32_t L[INTERLEAVE_WIDTH], R[INTERLEAVE_WIDTH];
+
+        for (int lane = 0; lane < INTERLEAVE_WIDTH; lane++)
+        {
+            L[lane] = load_half_block(blocks + block_index + lane * BLOCK_SIZE);
+            R[lane] = load_half_block(blocks + block_index + lane * BLOCK_SIZE + HALF_BLOCK_SIZE);
+        }
+
+        UNROLL_LANES
+        for (int round = 0; round < NUMBER_OF_ROUNDS; round += 2)
+        {
+            UNROLL_LANES
+            for (int lane = 0; lane < INTERLEAVE_WIDTH; lane++)
+            {
+                L[lane] ^= feistel_function_32(R[lane], s_boxes[round].sbox);
+            }
+
+            UNROLL_LANES
+            for (int lane = 0; lane < INTERLEAVE_WIDTH; lane++)
+            {
+                R[lane] ^= feistel_function_32(L[lane], s_boxes[round + 1].sbox);
+            }
+        }
+
+        for (int lane = 0; lane < INTERLEAVE_WIDTH; lane++)
+        {
+            store_half_block(blocks + block_index + lane * BLOCK_SIZE, L[lane]);
+            store_half_block(blocks + block_index + lane * BLOCK_SIZE + HALF_BLOCK_SIZE, R[lane]);
+        }
     }
 
-    // Decrypt
-    for (size_t block_index = 0; block_index < ciphertext_size; block_index += BLOCK_SIZE)
+    for (; block_index < number_of_bytes; block_index += BLOCK_SIZE)
     {
-        DES_ecb_encrypt((DES_cblock *)(ciphertext + block_index), (DES_cblock *)(padded_plaintext + block_index), &schedule, DES_DECRYPT);
+        feistel_network(blocks + block_index, s_boxes);
     }
+}
+
+void e_des_decrypt_blocks_scalar(uint8_t *blocks, size_t number_of_bytes, const void *sboxes)
+{
+    const struct s_box *s_boxes = (const struct s_box *)sboxes;
+    size_t block_index = 0;
+
+    // The rounds of INTERLEAVE_WIDTH independent blocks are interleaved so their sbox loads overlap
+    for (; block_index + INTERLEAVE_WIDTH * BLOCK_SIZE <= number_of_bytes; block_index += INTERLEAVE_WIDTH * BLOCK_SIZE)
+    {
+        uint32_t L[INTERLEAVE_WIDTH], R[INTERLEAVE_WIDTH];
+
+        for (int lane = 0; lane < INTERLEAVE_WIDTH; lane++)
+        {
+            L[lane] = load_half_block(blocks + block_index + lane * BLOCK_SIZE);
+            R[lane] = load_half_block(blocks + block_index + lane * BLOCK_SIZE + HALF_BLOCK_SIZE);
+        }
+
+        UNROLL_LANES
+        for (int round = NUMBER_OF_ROUNDS - 2; round >= 0; round -= 2)
+        {
+            UNROLL_LANES
+            for (int lane = 0; lane < INTERLEAVE_WIDTH; lane++)
+            {
+                R[lane] ^= feistel_function_32(L[lane], s_boxes[round + 1].sbox);
+            }
+
+            UNROLL_LANES
+            for (int lane = 0; lane < INTERLEAVE_WIDTH; lane++)
+            {
+                L[lane] ^= feistel_function_32(R[lane], s_boxes[round].sbox);
+            }
+        }
 
-    // Remove padding
-    remove_padding(padded_plaintext, padded_plaintext_len, plaintext, plaintext_size);
+        for (int lane = 0; lane < INTERLEAVE_WIDTH; lane++)
+        {
+            store_half_block(blocks + block_index + lane * BLOCK_SIZE, L[lane]);
+            store_half_block(blocks + block_index + lane * BLOCK_SIZE + HALF_BLOCK_SIZE, R[lane]);
+        }
+    }
 
-    free(padded_plaintext);
-}
\ No newline at end of file
+    for (; block_index < number_of_bytes; block_index += BLOCK_SIZE)
+    {
+        inverse_feistel_network(blocks + block_index, s_boxes);
+    }
+}
+
+/**
+ * Struct that represents a block kernel of the e-des mode
+ *
+ * @param name the name of the kernel, the value of E_DES_KERNEL that forces it (char array)
+ * @param supported the function that checks if the CPU supports the kernel
+ * @param encrypt the function that ciphers the blocks (block_cipher_function)
+ * @param decrypt the function that deciphers the blocks (block_cipher_function)
+ */
+struct e_des_kernel
+{
+    const char *name;
+    int (*supported)(void);
+    block_cipher_function encrypt;
+    block_cipher_function decrypt;
+};
+
+static int scalar_supported(void)
+{
+    return 1;
+}
+
+// From the fastest to the slowest, the first supported kernel is used
+static const struct e_des_kernel e_des_kernels[] = {
+    {"avx512", avx512_vbmi_supported, e_des_encrypt_blocks_avx512, e_des_decrypt_blocks_avx512},
+    {"avx2", avx2_supported, e_des_encrypt_blocks_avx2, e_des_decrypt_blocks_avx2},
+    {"scalar", scalar_supported, e_des_encrypt_blocks_scalar, e_des_decrypt_blocks_scalar},
+    {"ssse3", ssse3_supported, e_des_encrypt_blocks_ssse3, e_des_decrypt_blocks_ssse3},
+};
+
+static const struct e_des_kernel *active_kernel = NULL;
+static pthread_once_t active_kernel_once = PTHREAD_ONCE_INIT;
+
+/**
+ * Function that picks the block kernel, it runs once (pthread_once)
+ *
+ * It never exits, it runs inside the library: a forced kernel that is unknown or not supported falls back to the best supported kernel with a warning
+ */
+static void select_kernel(void)
+{
+    const char *forced_kernel = getenv(E_DES_KERNEL_VARIABLE);
+    size_t number_of_kernels = sizeof(e_des_kernels) / sizeof(e_des_kernels[0]);
+    const struct e_des_kernel *best_kernel = NULL;
+    int forced_kernel_known = 0;
+
+    if (forced_kernel != NULL && forced_kernel[0] == '\0')
+    {
+        forced_kernel = NULL;
+    }
+
+    for (size_t index = 0; index < number_of_kernels; index++)
+    {
+        const struct e_des_kernel *kernel = &e_des_kernels[index];
+        int is_forced = forced_kernel != NULL && strcmp(kernel->name, forced_kernel) == 0;
+
+        forced_kernel_known |= is_forced;
+
+        if (!kernel->supported())
+        {
+            continue;
+        }
+
+        if (is_forced)
+        {
+            active_kernel = kernel;
+            return;
+        }
+
+        if (best_kernel == NULL)
+        {
+            best_kernel = kernel;
+        }
+    }
+
+    // The scalar kernel is always supported
+    active_kernel = best_kernel;
+
+    if (forced_kernel != NULL)
+    {
+        fprintf(stderr, "Warning: %s=%s is %s, using the %s kernel\n", E_DES_KERNEL_VARIABLE, forced_kernel,
+                forced_kernel_known ? "not supported by this CPU" : "unknown (scalar, ssse3, avx2 or avx512)", active_kernel->name);
+    }
+}
+
+const char *e_des_kernel_name(void)
+{
+    pthread_once(&active_kernel_once, select_kernel);
+    return active_kernel->name;
+}
+
+void e_des_encrypt_blocks(uint8_t *blocks, size_t number_of_bytes, const void *sboxes)
+{
+    pthread_once(&active_kernel_once, select_kernel);
+    active_kernel->encrypt(blocks, number_of_bytes, sboxes);
+}
+
+void e_des_decrypt_blocks(uint8_t *blocks, size_t number_of_bytes, const void *sboxes)
+{
+    pthread_once(&active_kernel_once, select_kernel);
+    active_kernel->decrypt(blocks, number_of_bytes, sboxes);
+}
+
+// The EVP ciphers are fetched once (DES-ECB lives in the legacy provider of OpenSSL 3) from a library context of our own, so the providers of the host program are not changed
+static OSSL_LIB_CTX *des_library_context;
+static EVP_CIPHER *des_ecb_cipher;
+static EVP_CIPHER *triple_des_ecb_cipher;
+static pthread_once_t des_ciphers_once = PTHREAD_ONCE_INIT;
+static int des_ciphers_status = EDES_OK;
+
+// Every thread keeps one cached context per direction, freed when the thread exits
+static pthread_key_t des_context_cache_key;
+static uint64_t des_key_counter = 0;
+
+/**
+ * Struct that represents the cached EVP contexts of a thread, [0] deciphers and [1] ciphers
+ *
+ * @param contexts the contexts (EVP_CIPHER_CTX array)
+ * @param key_ids the id of the key set on each context, 0 for none (uint64_t array)
+ */
+struct des_context_cache
+{
+    EVP_CIPHER_CTX *contexts[2];
+    uint64_t key_ids[2];
+};
+
+/**
+ * Function that frees the cached contexts of a thread when it exits
+ *
+ * @param cache the cached contexts (struct des_context_cache)
+ */
+static void free_des_context_cache(void *cache)
+{
+    struct des_context_cache *context_cache = (struct des_context_cache *)cache;
+
+    EVP_CIPHER_CTX_free(context_cache->contexts[0]);
+    EVP_CIPHER_CTX_free(context_cache->contexts[1]);
+    free(context_cache);
+}
+
+/**
+ * Function that creates the library context, loads its providers and fetches the EVP ciphers, run once by pthread_once, a failure is kept in des_ciphers_status
+ *
+ * The context, its providers and the ciphers live until the process exits
+ */
+static void fetch_des_ciphers(void)
+{
+    des_library_context = OSSL_LIB_CTX_new();
+
+    // Loading a provider disables the implicit default one, so both are loaded (the legacy one holds DES-ECB)
+    if (des_library_context == NULL || OSSL_PROVIDER_load(des_library_context, "legacy") == NULL || OSSL_PROVIDER_load(des_library_context, "default") == NULL)
+    {
+        des_ciphers_status = EDES_ERROR_CRYPTO;
+        return;
+    }
+
+    des_ecb_cipher = EVP_CIPHER_fetch(des_library_context, "DES-ECB", NULL);
+    triple_des_ecb_cipher = EVP_CIPHER_fetch(des_library_context, "DES-EDE3-ECB", NULL);
+
+    if (des_ecb_cipher == NULL || triple_des_ecb_cipher == NULL || pthread_key_create(&des_context_cache_key, free_des_context_cache) != 0)
+    {
+        des_ciphers_status = EDES_ERROR_CRYPTO;
+    }
+}
+
+/**
+ * Function that returns the context of the thread for a direction, with the key set
+ *
+ * @param key the key (struct des_key)
+ * @param encrypt 1 to cipher, 0 to decipher (int)
+ * @param ctx pointer to the context (EVP_CIPHER_CTX)
+ *
+ * @return EDES_OK, EDES_ERROR_OUT_OF_MEMORY or EDES_ERROR_CRYPTO
+ */
+static int des_context(const struct des_key *key, int encrypt, EVP_CIPHER_CTX **ctx)
+{
+    if (key->cipher == NULL) // the ciphers could not be fetched when the key was generated
+    {
+        return EDES_ERROR_CRYPTO;
+    }
+
+    struct des_context_cache *cache = (struct des_context_cache *)pthread_getspecific(des_context_cache_key);
+
+    if (cache == NULL)
+    {
+        cache = (struct des_context_cache *)calloc(1, sizeof(struct des_context_cache));
+
+        if (cache == NULL || (cache->contexts[0] = EVP_CIPHER_CTX_new()) == NULL || (cache->contexts[1] = EVP_CIPHER_CTX_new()) == NULL)
+        {
+            if (cache != NULL)
+            {
+                EVP_CIPHER_CTX_free(cache->contexts[0]);
+                free(cache);
+            }
+            return EDES_ERROR_OUT_OF_MEMORY;
+        }
+
+        pthread_setspecific(des_context_cache_key, cache);
+    }
+
+    // The key schedule is only computed again when the thread gets another key
+    if (cache->key_ids[encrypt] != key->id)
+    {
+        if (EVP_CipherInit_ex(cache->contexts[encrypt], key->cipher, NULL, key->key, NULL, encrypt) != 1)
+        {
+            cache->key_ids[encrypt] = 0;
+            return EDES_ERROR_CRYPTO;
+        }
+
+        EVP_CIPHER_CTX_set_padding(cache->contexts[encrypt], 0);
+        cache->key_ids[encrypt] = key->id;
+    }
+
+    *ctx = cache->contexts[encrypt];
+
+    return EDES_OK;
+}
+
+int des_ecb_process_blocks(uint8_t *blocks, size_t number_of_bytes, const struct des_key *key, int encrypt)
+{
+    EVP_CIPHER_CTX *ctx;
+    int status = des_context(key, encrypt, &ctx);
+    int output_length;
+
+    if (status != EDES_OK)
+    {
+        return status;
+    }
+
+    for (size_t offset = 0; offset < number_of_bytes; offset += DES_UPDATE_SIZE)
+    {
+        size_t length = number_of_bytes - offset;
+        if (length > DES_UPDATE_SIZE)
+        {
+            length = DES_UPDATE_SIZE;
+        }
+
+        if (EVP_CipherUpdate(ctx, blocks + offset, &output_length, blocks + offset, (int)length) != 1)
+        {
+            return EDES_ERROR_CRYPTO;
+        }
+    }
+
+    return EDES_OK;
+}
+
+/**
+ * Function that ciphers/deciphers the blocks in place for the block_cipher_function callers (streams, files, thread pool), they have no status so the program exits on error
+ *
+ * @param blocks the blocks (uint8_t array)
+ * @param number_of_bytes the number of bytes, multiple of BLOCK_SIZE (size_t)
+ * @param key the key (struct des_key)
+ * @param encrypt 1 to cipher, 0 to decipher (int)
+ */
+static void des_ecb_blocks(uint8_t *blocks, size_t number_of_bytes, const struct des_key *key, int encrypt)
+{
+    int status = des_ecb_process_blocks(blocks, number_of_bytes, key, encrypt);
+
+    if (status != EDES_OK)
+    {
+        fprintf(stderr, "Error in DES-ECB: %s\n", edes_strerror(status));
+        exit(1);
+    }
+}
+
+int generate_des_key(const uint8_t *password, struct des_key *key)
+{
+    pthread_once(&des_ciphers_once, fetch_des_ciphers);
+
+    if (des_ciphers_status != EDES_OK)
+    {
+        memset(key, 0, sizeof(struct des_key));
+        return des_ciphers_status;
+    }
+
+    // Shorter passwords are padded with zeros instead of reading past their end
+    DES_cblock des_key;
+    memset(des_key, 0, DES_KEY_SIZE);
+    strncpy((char *)des_key, (const char *)password, DES_KEY_SIZE);
+    DES_set_odd_parity(&des_key);
+
+    memset(key->key, 0, TRIPLE_DES_KEY_SIZE);
+    memcpy(key->key, des_key, DES_KEY_SIZE);
+    key->cipher = des_ecb_cipher;
+    key->id = __atomic_add_fetch(&des_key_counter, 1, __ATOMIC_RELAXED);
+
+    memset(des_key, 0, DES_KEY_SIZE);
+
+    return EDES_OK;
+}
+
+int generate_triple_des_key(const uint8_t *password, struct des_key *key)
+{
+    pthread_once(&des_ciphers_once, fetch_des_ciphers);
+
+    if (des_ciphers_status != EDES_OK)
+    {
+        memset(key, 0, sizeof(struct des_key));
+        return des_ciphers_status;
+    }
+
+    uint8_t hash[SHA256_DIGEST_LENGTH];
+    SHA256(password, strlen((const char *)password), hash);
+
+    for (int index = 0; index < TRIPLE_DES_KEY_SIZE; index += DES_KEY_SIZE)
+    {
+        DES_set_odd_parity((DES_cblock *)(hash + index));
+    }
+
+    memcpy(key->key, hash, TRIPLE_DES_KEY_SIZE);
+    key->cipher = triple_des_ecb_cipher;
+    key->id = __atomic_add_fetch(&des_key_counter, 1, __ATOMIC_RELAXED);
+
+    memset(hash, 0, SHA256_DIGEST_LENGTH);
+
+    return EDES_OK;
+}
+
+void des_key_clear(struct des_key *key)
+{
+    // Volatile pointer so the compiler does not drop the wipe of the key material
+    volatile uint8_t *bytes = (volatile uint8_t *)key->key;
+
+    for (size_t index = 0; index < TRIPLE_DES_KEY_SIZE; index++)
+    {
+        bytes[index] = 0;
+    }
+}
+
+void des_ecb_encrypt_blocks(uint8_t *blocks, size_t number_of_bytes, const void *key)
+{
+    des_ecb_blocks(blocks, number_of_bytes, (const struct des_key *)key, 1);
+}
+
+void des_ecb_decrypt_blocks(uint8_t *blocks, size_t number_of_bytes, const void *key)
+{
+    des_ecb_blocks(blocks, number_of_bytes, (const struct des_key *)key, 0);
+}
+
+int encrypt_in_place(block_cipher_function cipher, const void *key, uint8_t *buffer, size_t length, size_t capacity, size_t *ciphertext_size)
+{
+    // The padding goes into the slack after the data, at most BLOCK_SIZE bytes
+    if (capacity < length + BLOCK_SIZE - (length % BLOCK_SIZE))
+    {
+        return EDES_ERROR_BUFFER_TOO_SMALL;
+    }
+
+    *ciphertext_size = apply_padding(buffer, length);
+    cipher(buffer, *ciphertext_size, key);
+
+    return EDES_OK;
+}
+
+int decrypt_in_place(block_cipher_function decipher, const void *key, uint8_t *buffer, size_t length, size_t *plaintext_size)
+{
+    if (length == 0 || length % BLOCK_SIZE != 0)
+    {
+        return EDES_ERROR_INVALID_SIZE;
+    }
+
+    decipher(buffer, length, key);
+    *plaintext_size = length - get_padding_size(buffer, length);
+
+    return EDES_OK;
+}
+
+int edes_encrypt_in_place(const struct edes_ctx *ctx, uint8_t *buffer, size_t length, size_t capacity, size_t *ciphertext_size)
+{
+    return encrypt_in_place(e_des_encrypt_blocks, ctx->sboxes, buffer, length, capacity, ciphertext_size);
+}
+
+int edes_decrypt_in_place(const struct edes_ctx *ctx, uint8_t *buffer, size_t length, size_t *plaintext_size)
+{
+    return decrypt_in_place(e_des_decrypt_blocks, ctx->sboxes, buffer, length, plaintext_size);
+}
+
+void stream_encrypt(FILE *input, FILE *output, block_cipher_function cipher, const void *key, size_t buffer_size)
+{
+    // Extra block so the padding of the final chunk always fits
+    uint8_t *buffer = (uint8_t *)malloc(buffer_size + BLOCK_SIZE);
+
+    if (buffer == NULL) // memory allocation error
+    {
+        fprintf(stderr, "Error allocating memory for stream buffer\n");
+        exit(1);
+    }
+
+    for (;;)
+    {
+        STATS_START(read_start);
+        size_t number_of_readed_bytes = fread(buffer, sizeof(uint8_t), buffer_size, input);
+        STATS_STOP(STATS_READ_BYTES, read_start, number_of_readed_bytes);
+
+        if (ferror(input))
+        {
+            fprintf(stderr, "Error reading the input stream\n");
+            exit(1);
+        }
+
+        size_t number_of_bytes = number_of_readed_bytes;
+        int is_final_chunk = number_of_readed_bytes < buffer_size;
+
+        if (is_final_chunk)
+        {
+            STATS_START(padding_start);
+            number_of_bytes = apply_padding(buffer, number_of_readed_bytes);
+            STATS_STOP(STATS_ADD_PADDING, padding_start, number_of_bytes - number_of_readed_bytes);
+        }
+
+        STATS_START(feistel_start);
+        cipher(buffer, number_of_bytes, key);
+        STATS_STOP(STATS_FEISTEL, feistel_start, number_of_bytes);
+
+        STATS_START(write_start);
+        if (fwrite(buffer, sizeof(uint8_t), number_of_bytes, output) != number_of_bytes)
+        {
+            fprintf(stderr, "Error writing the output stream\n");
+            exit(1);
+        }
+        STATS_STOP(STATS_WRITE_BYTES, write_start, number_of_bytes);
+
+        if (is_final_chunk)
+        {
+            break;
+        }
+    }
+
+    free(buffer);
+}
+
+void stream_decrypt(FILE *input, FILE *output, block_cipher_function decipher, const void *key, size_t buffer_size)
+{
+    // Extra block for the block held back from the previous chunk
+    uint8_t *buffer = (uint8_t *)malloc(buffer_size + BLOCK_SIZE);
+
+    if (buffer == NULL) // memory allocation error
+    {
+        fprintf(stderr, "Error allocating memory for stream buffer\n");
+        exit(1);
+    }
+
+    size_t number_of_held_bytes = 0;
+
+    for (;;)
+    {
+        STATS_START(read_start);
+        size_t number_of_readed_bytes = fread(buffer + number_of_held_bytes, sizeof(uint8_t), buffer_size, input);
+        STATS_STOP(STATS_READ_BYTES, read_start, number_of_readed_bytes);
+
+        if (ferror(input))
+        {
+            fprintf(stderr, "Error reading the input stream\n");
+            exit(1);
+        }
+
+        size_t number_of_bytes = number_of_held_bytes + number_of_readed_bytes;
+
+        if (number_of_readed_bytes < buffer_size) // final chunk, its last block holds the padding
+        {
+            if (number_of_bytes % BLOCK_SIZE != 0)
+            {
+                fprintf(stderr, "Error: the ciphertext size is not a multiple of the block size\n");
+                exit(1);
+            }
+
+            STATS_START(feistel_start);
+            decipher(buffer, number_of_bytes, key);
+            STATS_STOP(STATS_FEISTEL, feistel_start, number_of_bytes);
+
+            number_of_bytes -= get_padding_size(buffer, number_of_bytes);
+
+            STATS_START(write_start);
+            if (fwrite(buffer, sizeof(uint8_t), number_of_bytes, output) != number_of_bytes)
+            {
+                fprintf(stderr, "Error writing the output stream\n");
+                exit(1);
+            }
+            STATS_STOP(STATS_WRITE_BYTES, write_start, number_of_bytes);
+            break;
+        }
+
+        // Hold back the last block, it may be the one with the padding
+        size_t number_of_ready_bytes = number_of_bytes - BLOCK_SIZE;
+
+        STATS_START(feistel_start);
+        decipher(buffer, number_of_ready_bytes, key);
+        STATS_STOP(STATS_FEISTEL, feistel_start, number_of_ready_bytes);
+
+        STATS_START(write_start);
+        if (fwrite(buffer, sizeof(uint8_t), number_of_ready_bytes, output) != number_of_ready_bytes)
+        {
+            fprintf(stderr, "Error writing the output stream\n");
+            exit(1);
+        }
+        STATS_STOP(STATS_WRITE_BYTES, write_start, number_of_ready_bytes);
+
+        memmove(buffer, buffer + number_of_ready_bytes, BLOCK_SIZE);
+        number_of_held_bytes = BLOCK_SIZE;
+    }
+
+    free(buffer);
+}
+
+/**
+ * Function that maps a region of a file in memory, exits on error, a zero size returns NULL
+ *
+ * @param file_descriptor the file descriptor (int)
+ * @param size the size of the region (size_t)
+ * @param protection the protection of the mapping (PROT_READ or PROT_READ | PROT_WRITE)
+ *
+ * @return pointer to the mapped region (uint8_t array)
+ */
+static uint8_t *map_file(int file_descriptor, size_t size, int protection)
+{
+    if (size == 0)
+    {
+        return NULL;
+    }
+
+    void *mapping = mmap(NULL, size, protection, MAP_SHARED, file_descriptor, 0);
+
+    if (mapping == MAP_FAILED)
+    {
+        perror("Error mapping file");
+        exit(1);
+    }
+
+    // The chunks are processed from the start to the end of the file
+    madvise(mapping, size, MADV_SEQUENTIAL);
+
+    return (uint8_t *)mapping;
+}
+
+/**
+ * Function that opens a file, exits on error
+ *
+ * @param path the path of the file (char array)
+ * @param flags the open flags (int)
+ *
+ * @return the file descriptor (int)
+ */
+static int open_file(const char *path, int flags)
+{
+    int file_descriptor = open(path, flags, 0644);
+
+    if (file_descriptor < 0)
+    {
+        fprintf(stderr, "Error opening %s\n", path);
+        exit(1);
+    }
+
+    return file_descriptor;
+}
+
+/**
+ * Function that returns the size of an open file, exits on error
+ *
+ * @param file_descriptor the file descriptor (int)
+ *
+ * @return the size of the file (size_t)
+ */
+static size_t get_file_size(int file_descriptor)
+{
+    struct stat file_status;
+
+    if (fstat(file_descriptor, &file_status) != 0)
+    {
+        perror("Error reading file size");
+        exit(1);
+    }
+
+    return (size_t)file_status.st_size;
+}
+
+/**
+ * Function that resizes an open file, exits on error
+ *
+ * @param file_descriptor the file descriptor (int)
+ * @param size the new size of the file (size_t)
+ */
+static void resize_file(int file_descriptor, size_t size)
+{
+    if (ftruncate(file_descriptor, (off_t)size) != 0)
+    {
+        perror("Error resizing file");
+        exit(1);
+    }
+}
+
+/**
+ * Function that opens the output file of -i/-o, exits if it is the input file (it would be truncated before being read)
+ *
+ * @param input_file the file descriptor of the input (int)
+ * @param output_path the path of the output (char array)
+ *
+ * @return the file descriptor of the output, emptied (int)
+ */
+static int open_output_file(int input_file, const char *output_path)
+{
+    // Opened without O_TRUNC, the output is only emptied once it is known not to be the input
+    int output_file = open_file(output_path, O_RDWR | O_CREAT);
+
+    struct stat input_status;
+    struct stat output_status;
+
+    if (fstat(input_file, &input_status) != 0 || fstat(output_file, &output_status) != 0)
+    {
+        perror("Error reading file status");
+        exit(1);
+    }
+
+    if (input_status.st_dev == output_status.st_dev && input_status.st_ino == output_status.st_ino)
+    {
+        fprintf(stderr, "Error: %s is both the input and the output, use --in-place instead\n", output_path);
+        exit(1);
+    }
+
+    resize_file(output_file, 0);
+
+    return output_file;
+}
+
+/**
+ * Function that ciphers/deciphers a mapped region chunk by chunk, the input chunk is first copied to the output when they are different mappings, the processed pages are then dropped from the working set
+ *
+ * For --stats the input chunk is faulted in first (read_bytes) and the copy into the output mapping is the write_bytes phase
+ *
+ * @param input the mapped input (uint8_t array)
+ * @param output the mapped output, may be the same as the input (uint8_t array)
+ * @param number_of_bytes the number of bytes to process, multiple of BLOCK_SIZE (size_t)
+ * @param block_function the function that ciphers/deciphers whole blocks (block_cipher_function)
+ * @param key the key material given to the block function
+ * @param chunk_size the size of the chunks, multiple of the page size (size_t)
+ */
+static void process_mapped_region(const uint8_t *input, uint8_t *output, size_t number_of_bytes, block_cipher_function block_function, const void *key, size_t chunk_size)
+{
+    size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+
+    for (size_t chunk_start = 0; chunk_start < number_of_bytes; chunk_start += chunk_size)
+    {
+        size_t size = number_of_bytes - chunk_start < chunk_size ? number_of_bytes - chunk_start : chunk_size;
+
+        // Only timed runs touch the pages up front, so the page-ins of the file are the read phase instead of hiding in the copy
+        if (EDES_STATS && stats_enabled)
+        {
+            STATS_START(read_start);
+            volatile const uint8_t *pages = input + chunk_start;
+            for (size_t offset = 0; offset < size; offset += page_size)
+            {
+                (void)pages[offset];
+            }
+            STATS_STOP(STATS_READ_BYTES, read_start, size);
+        }
+
+        if (output != input)
+        {
+            STATS_START(write_start);
+            memcpy(output + chunk_start, input + chunk_start, size);
+            madvise((void *)(input + chunk_start), size, MADV_DONTNEED);
+            STATS_STOP(STATS_WRITE_BYTES, write_start, size);
+        }
+
+        STATS_START(feistel_start);
+        block_function(output + chunk_start, size, key);
+        STATS_STOP(STATS_FEISTEL, feistel_start, size);
+
+        // The dirty pages stay in the page cache, they only leave this process working set
+        madvise(output + chunk_start, size, MADV_DONTNEED);
+    }
+}
+
+void file_encrypt(const char *input_path, const char *output_path, block_cipher_function cipher, const void *key, size_t chunk_size)
+{
+    int in_place = output_path == NULL;
+    int input_file = open_file(input_path, in_place ? O_RDWR : O_RDONLY);
+    int output_file = in_place ? input_file : open_output_file(input_file, output_path);
+
+    size_t plaintext_size = get_file_size(input_file);
+    size_t padded_size = plaintext_size + BLOCK_SIZE - (plaintext_size % BLOCK_SIZE);
+
+    // The output is pre-sized with the room for the padding
+    resize_file(output_file, padded_size);
+
+    uint8_t *output = map_file(output_file, padded_size, PROT_READ | PROT_WRITE);
+    const uint8_t *input = in_place ? output : map_file(input_file, plaintext_size, PROT_READ);
+
+    // The whole blocks are processed first, the final block gets the padding
+    size_t full_blocks_size = plaintext_size - (plaintext_size % BLOCK_SIZE);
+    process_mapped_region(input, output, full_blocks_size, cipher, key, chunk_size);
+
+    uint8_t *final_block = output + full_blocks_size;
+    if (plaintext_size > full_blocks_size)
+    {
+        memmove(final_block, input + full_blocks_size, plaintext_size - full_blocks_size);
+    }
+    STATS_START(padding_start);
+    apply_padding(final_block, plaintext_size - full_blocks_size);
+    STATS_STOP(STATS_ADD_PADDING, padding_start, BLOCK_SIZE - (plaintext_size - full_blocks_size));
+
+    STATS_START(feistel_start);
+    cipher(final_block, BLOCK_SIZE, key);
+    STATS_STOP(STATS_FEISTEL, feistel_start, BLOCK_SIZE);
+
+    // Unmapping hands the rest of the output to the page cache, the copied chunks were already counted
+    STATS_START(write_start);
+    if (!in_place && input != NULL)
+    {
+        munmap((void *)input, plaintext_size);
+    }
+    munmap(output, padded_size);
+    STATS_STOP(STATS_WRITE_BYTES, write_start, in_place ? padded_size : padded_size - full_blocks_size);
+
+    if (!in_place)
+    {
+        close(input_file);
+    }
+    close(output_file);
+}
+
+void file_decrypt(const char *input_path, const char *output_path, block_cipher_function decipher, const void *key, size_t chunk_size)
+{
+    int in_place = output_path == NULL;
+    int input_file = open_file(input_path, in_place ? O_RDWR : O_RDONLY);
+    int output_file = in_place ? input_file : open_output_file(input_file, output_path);
+
+    size_t ciphertext_size = get_file_size(input_file);
+
+    if (ciphertext_size % BLOCK_SIZE != 0)
+    {
+        fprintf(stderr, "Error: the ciphertext size is not a multiple of the block size\n");
+        exit(1);
+    }
+
+    // The output is pre-sized to the ciphertext size and truncated once the padding is known
+    if (!in_place)
+    {
+        resize_file(output_file, ciphertext_size);
+    }
+
+    uint8_t *output = map_file(output_file, ciphertext_size, PROT_READ | PROT_WRITE);
+    const uint8_t *input = in_place ? output : map_file(input_file, ciphertext_size, PROT_READ);
+
+    process_mapped_region(input, output, ciphertext_size, decipher, key, chunk_size);
+
+    size_t plaintext_size = ciphertext_size - get_padding_size(output, ciphertext_size);
+
+    // Unmapping hands the output to the page cache and the truncation drops the padding, the copied chunks were already counted
+    STATS_START(write_start);
+    if (!in_place && input != NULL)
+    {
+        munmap((void *)input, ciphertext_size);
+    }
+    if (output != NULL)
+    {
+        munmap(output, ciphertext_size);
+    }
+
+    resize_file(output_file, plaintext_size);
+    STATS_STOP(STATS_WRITE_BYTES, write_start, in_place ? plaintext_size : 0);
+
+    if (!in_place)
+    {
+        close(input_file);
+    }
+    close(output_file);
+}
+
+/**
+ * Function that reads exactly size bytes at the given offset of a file (pread), retrying the short reads
+ *
+ * @param file_descriptor the file descriptor (int)
+ * @param buffer the buffer (uint8_t array)
+ * @param size the number of bytes to read (size_t)
+ * @param offset the offset in the file (uint64_t)
+ *
+ * @return EDES_OK, or EDES_ERROR_IO on error or end of file
+ */
+static int read_exactly_at(int file_descriptor, uint8_t *buffer, size_t size, uint64_t offset)
+{
+    while (size > 0)
+    {
+        ssize_t number_of_readed_bytes = pread(file_descriptor, buffer, size, (off_t)offset);
+
+        if (number_of_readed_bytes <= 0)
+        {
+            return EDES_ERROR_IO;
+        }
+
+        buffer += number_of_readed_bytes;
+        size -= (size_t)number_of_readed_bytes;
+        offset += (uint64_t)number_of_readed_bytes;
+    }
+
+    return EDES_OK;
+}
+
+/**
+ * Function that reads and deciphers one block of a file and copies part of it
+ *
+ * @param file_descriptor the ciphertext file (int)
+ * @param decipher the function that deciphers whole blocks (block_cipher_function)
+ * @param key the key material given to the decipher function
+ * @param block_offset the offset of the block, multiple of BLOCK_SIZE (uint64_t)
+ * @param first_byte the first byte of the block to copy (size_t)
+ * @param number_of_bytes the number of bytes to copy (size_t)
+ * @param plaintext the destination (uint8_t array)
+ *
+ * @return EDES_OK, or EDES_ERROR_IO
+ */
+static int decrypt_partial_block(int file_descriptor, block_cipher_function decipher, const void *key, uint64_t block_offset, size_t first_byte, size_t number_of_bytes, uint8_t *plaintext)
+{
+    uint8_t block[BLOCK_SIZE];
+
+    if (read_exactly_at(file_descriptor, block, BLOCK_SIZE, block_offset) != EDES_OK)
+    {
+        return EDES_ERROR_IO;
+    }
+
+    decipher(block, BLOCK_SIZE, key);
+    memcpy(plaintext, block + first_byte, number_of_bytes);
+
+    return EDES_OK;
+}
+
+int decrypt_range(int file_descriptor, block_cipher_function decipher, const void *key, uint64_t offset, size_t length, uint8_t *plaintext, size_t *plaintext_size)
+{
+    struct stat file_status;
+
+    *plaintext_size = 0;
+
+    if (fstat(file_descriptor, &file_status) != 0)
+    {
+        return EDES_ERROR_IO;
+    }
+
+    uint64_t ciphertext_size = (uint64_t)file_status.st_size;
+
+    if (ciphertext_size == 0 || ciphertext_size % BLOCK_SIZE != 0)
+    {
+        return EDES_ERROR_INVALID_SIZE;
+    }
+
+    uint64_t end = offset + length < offset ? UINT64_MAX : offset + length;
+
+    // Only a range that reaches the final block needs its padding
+    if (end > ciphertext_size - BLOCK_SIZE)
+    {
+        uint8_t final_block[BLOCK_SIZE];
+
+        if (decrypt_partial_block(file_descriptor, decipher, key, ciphertext_size - BLOCK_SIZE, 0, BLOCK_SIZE, final_block) != EDES_OK)
+        {
+            return EDES_ERROR_IO;
+        }
+
+        uint64_t padded_plaintext_size = ciphertext_size - get_padding_size(final_block, BLOCK_SIZE);
+
+        if (end > padded_plaintext_size)
+        {
+            end = padded_plaintext_size;
+        }
+    }
+
+    if (offset >= end)
+    {
+        return EDES_OK;
+    }
+
+    uint64_t first_full_block = (offset + BLOCK_SIZE - 1) / BLOCK_SIZE * BLOCK_SIZE;
+    uint64_t last_full_block_end = end / BLOCK_SIZE * BLOCK_SIZE;
+
+    // The range is inside a single block
+    if (first_full_block > last_full_block_end)
+    {
+        if (decrypt_partial_block(file_descriptor, decipher, key, last_full_block_end, offset % BLOCK_SIZE, end - offset, plaintext) != EDES_OK)
+        {
+            return EDES_ERROR_IO;
+        }
+
+        *plaintext_size = end - offset;
+        return EDES_OK;
+    }
+
+    // Head: the end of the block that holds the offset
+    if (offset < first_full_block && decrypt_partial_block(file_descriptor, decipher, key, first_full_block - BLOCK_SIZE, offset % BLOCK_SIZE, first_full_block - offset, plaintext) != EDES_OK)
+    {
+        return EDES_ERROR_IO;
+    }
+
+    // Middle: the whole blocks are read and deciphered directly in the plaintext buffer
+    uint8_t *middle = plaintext + (first_full_block - offset);
+    size_t middle_size = last_full_block_end - first_full_block;
+
+    if (middle_size > 0)
+    {
+        if (read_exactly_at(file_descriptor, middle, middle_size, first_full_block) != EDES_OK)
+        {
+            return EDES_ERROR_IO;
+        }
+
+        decipher(middle, middle_size, key);
+    }
+
+    // Tail: the start of the block that holds the end
+    if (end > last_full_block_end && decrypt_partial_block(file_descriptor, decipher, key, last_full_block_end, 0, end - last_full_block_end, middle + middle_size) != EDES_OK)
+    {
+        return EDES_ERROR_IO;
+    }
+
+    *plaintext_size = end - offset;
+    return EDES_OK;
+}
+
+void file_decrypt_range(int file_descriptor, FILE *output, block_cipher_function decipher, const void *key, uint64_t offset, size_t length, size_t buffer_size)
+{
+    uint8_t *buffer = (uint8_t *)malloc(buffer_size);
+
+    if (buffer == NULL) // memory allocation error
+    {
+        fprintf(stderr, "Error allocating memory for range buffer\n");
+        exit(1);
+    }
+
+    while (length > 0)
+    {
+        size_t chunk_length = length < buffer_size ? length : buffer_size;
+        size_t number_of_bytes;
+        int status = decrypt_range(file_descriptor, decipher, key, offset, chunk_length, buffer, &number_of_bytes);
+
+        if (status == EDES_ERROR_INVALID_SIZE)
+        {
+            fprintf(stderr, "Error: the ciphertext size is not a non-zero multiple of the block size\n");
+            exit(1);
+        }
+        else if (status != EDES_OK)
+        {
+            perror("Error reading the ciphertext file");
+            exit(1);
+        }
+
+        if (fwrite(buffer, sizeof(uint8_t), number_of_bytes, output) != number_of_bytes)
+        {
+            fprintf(stderr, "Error writing the output stream\n");
+            exit(1);
+        }
+
+        // The end of the plaintext was reached
+        if (number_of_bytes < chunk_length)
+        {
+            break;
+        }
+
+        offset += number_of_bytes;
+        length -= number_of_bytes;
+    }
+
+    free(buffer);
+}
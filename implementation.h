@@ -19,9 +19,14 @@
 #include <stdint.h>
 #include <stddef.h>
 #include <openssl/sha.h>
+#include <openssl/rand.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "libedes.h"
 
 // Libraries for performance testing
 #include <openssl/des.h>
+#include <openssl/evp.h>
 #include <time.h>
 #include <unistd.h>
 #include <fcntl.h>
@@ -31,10 +36,23 @@
 #define KEY_SIZE 32  // 256 bits
 #define BLOCK_SIZE 8 // 64 bits
 #define HALF_BLOCK_SIZE 4
+#define IV_SIZE BLOCK_SIZE // the IV of the chained/counter modes is one block
 #define NUMBER_OF_ROUNDS 16
 #define NUMBER_OF_S_BOXES 16
 #define S_BOX_SIZE 256 // 256 bytes
 #define NUMBER_OF_BYTES_IN_ALL_S_BOXES (NUMBER_OF_S_BOXES * S_BOX_SIZE) // 4096 bytes
+#define EDES_ARENA_ALIGNMENT 16
+#ifndef INTERLEAVE_WIDTH
+#define INTERLEAVE_WIDTH 4 // number of blocks interleaved by the portable kernel, can be set at compile time (-DINTERLEAVE_WIDTH=8)
+#endif
+#define E_DES_KERNEL_VARIABLE "E_DES_KERNEL" // environment variable that forces a block kernel (scalar, ssse3, avx2 or avx512)
+#define STREAM_BUFFER_SIZE (64 * 1024) // 64KiB per thread, must be a multiple of BLOCK_SIZE
+#define FILE_CHUNK_SIZE (1024 * 1024) // 1MiB per thread, must be a multiple of the page size
+#define DES_KEY_SIZE 8 // 64 bits, the first bytes of the password
+#define TRIPLE_DES_KEY_SIZE 24 // three DES keys (EDE), the first bytes of the SHA-256 of the password
+#define DES_UPDATE_SIZE (1024 * 1024 * 1024) // 1GiB, EVP_CipherUpdate takes an int length
+
+// The status codes (EDES_OK, EDES_ERROR_*) of the functions that do not allocate memory (the *_into, *_arena and range variants) are the ones of the public API, in libedes.h
 
 // Constants for the performance testing
 #define NUMBER_OF_TESTS 100000
@@ -51,9 +69,61 @@ struct s_box
 };
 
 /**
- * Function that reads the bytes from stdin, it receives a pointer to the uint8_t array and a pointer to the size of the array
+ * Struct that represents a precomputed e-des key context, the sboxes are derived once from the password and can then be used by any number of encrypt/decrypt calls
+ *
+ * The context is never modified by the encrypt/decrypt functions, so a single context can be shared read-only between threads
+ *
+ * @param sboxes the sboxes derived from the password (struct s_box array)
+ */
+struct edes_ctx
+{
+    struct s_box sboxes[NUMBER_OF_S_BOXES];
+};
+
+/**
+ * Struct that represents a des-ecb or 3des-ede key, the blocks are ciphered by an EVP_CIPHER_CTX (whole buffers at a time)
+ *
+ * An EVP_CIPHER_CTX cannot be used by two threads at once, so each thread keeps its own cached contexts and only sets the key again when it gets a key with another id.
+ * The key is never modified by the cipher functions, so a single key can be shared read-only between threads
+ *
+ * @param cipher the EVP cipher, DES-ECB or DES-EDE3-ECB (EVP_CIPHER)
+ * @param key the raw key, DES_KEY_SIZE or TRIPLE_DES_KEY_SIZE bytes (uint8_t array)
+ * @param id the id of the key, unique in the process (uint64_t)
+ */
+struct des_key
+{
+    const EVP_CIPHER *cipher;
+    uint8_t key[TRIPLE_DES_KEY_SIZE];
+    uint64_t id;
+};
+
+/**
+ * Struct that represents a bump arena, the buffers are carved from caller-owned memory and all freed at once by edes_arena_reset
+ *
+ * @param memory the memory of the arena (uint8_t array)
+ * @param size the size of the memory (size_t)
+ * @param used the number of bytes already given out (size_t)
+ */
+struct edes_arena
+{
+    uint8_t *memory;
+    size_t size;
+    size_t used;
+};
+
+/**
+ * Function pointer type for the functions that cipher/decipher whole blocks in place, it receives the blocks, the number of bytes (multiple of BLOCK_SIZE) and the key material of the mode
  *
- * @param readed_bytes pointer to the uint8_t array
+ * @param blocks the blocks (uint8_t array)
+ * @param number_of_bytes the number of bytes to process (size_t)
+ * @param key the key material (struct s_box array for e-des, struct des_key for des-ecb and 3des-ede)
+ */
+typedef void (*block_cipher_function)(uint8_t *blocks, size_t number_of_bytes, const void *key);
+
+/**
+ * Function that reads the bytes from stdin, it receives a pointer to the uint8_t array and a pointer to the size of the array (at most MAX_BYTES bytes are read)
+ *
+ * @param readed_bytes pointer to the uint8_t array (with room for MAX_BYTES bytes)
  * @param number_of_readed_bytes pointer to the size of the array (size_t)
  */
 void read_bytes(uint8_t *readed_bytes, size_t *number_of_readed_bytes);
@@ -78,6 +148,8 @@ void feistel_function(const uint8_t *input_block, const uint8_t *s_box, uint8_t
 /**
  * Function that handles the feistel network used to cipher, it receives the block that will be divided in two halfs, the sboxes and a pointer to the cipher block
  *
+ * The halves are kept in 32-bit registers and the 16 rounds are unrolled, no memory is allocated
+ *
  * @param block the block (uint8_t array)
  * @param sboxes the sboxes (struct s_box array)
  */
@@ -86,10 +158,12 @@ void feistel_network(uint8_t *block, const struct s_box *sboxes);
 /**
  * Function that handles the inverse feistel network used to decipher, it receives the block that will be divided in two halfs, the sboxes and a pointer to the cipher block
  *
+ * The halves are kept in 32-bit registers and the 16 rounds are unrolled, no memory is allocated
+ *
  * @param block the block (uint8_t array)
  * @param sboxes the sboxes (struct s_box array)
  */
-void inverse_feistel_network(const uint8_t *block, const struct s_box *sboxes);
+void inverse_feistel_network(uint8_t *block, const struct s_box *sboxes);
 
 /**
  * Function that generates the key from the password, using SHA256
@@ -116,13 +190,31 @@ void generate_single_sbox(const uint8_t *password, uint8_t *single_sbox);
 void round_robin_shuffle(uint8_t *array, size_t size);
 
 /**
- * Function that generates the sboxes from the password
+ * Function that applies the round robin algorithm without allocating memory, the shuffled bytes are written to a different array
+ *
+ * @param array the array (uint8_t array)
+ * @param shuffled_array the shuffled array, must not be the same as the array (uint8_t array)
+ * @param size the size of the arrays (size_t)
+ *
+ * @return EDES_OK, or EDES_ERROR_INVALID_ARGUMENT if the arrays are the same
+ */
+int round_robin_shuffle_into(const uint8_t *array, uint8_t *shuffled_array, size_t size);
+
+/**
+ * Function that generates the sboxes from the password, directly in the destination (no allocations nor intermediate copies)
  *
  * @param password the password (uint8_t array)
  * @param sboxes pointer to the sboxes (struct s_box array)
  */
 void generate_sboxes(const uint8_t *password, struct s_box *sboxes);
 
+/**
+ * Function that generates a random IV (openssl RAND_bytes), the program exits if no random bytes are available
+ *
+ * @param iv the IV, IV_SIZE bytes (uint8_t array)
+ */
+void generate_iv(uint8_t *iv);
+
 /**
  * Function that will apply the PCKS#7 padding to the plaintext, it receives the plaintext, the plaintext length, a pointer to the padded plaintext and a pointer to the padded length
  *
@@ -144,35 +236,266 @@ void add_padding(const uint8_t *plaintext, size_t plaintext_length, uint8_t **pa
 void remove_padding(const uint8_t *padded_plaintext, size_t padded_length, uint8_t **plaintext, size_t *plaintext_length);
 
 /**
- * Encrypt Function, receives the plaintext, the password and a pointer to the ciphertext
+ * Function that writes the PCKS#7 padding right after the plaintext, it receives the buffer and the plaintext length, the buffer must have room for BLOCK_SIZE extra bytes
+ *
+ * @param buffer the buffer holding the plaintext (uint8_t array)
+ * @param plaintext_length the plaintext length (size_t)
+ *
+ * @return the padded length (size_t)
+ */
+size_t apply_padding(uint8_t *buffer, size_t plaintext_length);
+
+/**
+ * Function that returns the number of PCKS#7 padding bytes at the end of the padded plaintext
  *
+ * @param padded_plaintext the padded plaintext (uint8_t array)
+ * @param padded_length the padded plaintext length (size_t)
+ *
+ * @return the number of padding bytes, 0 if the last byte is not a valid padding byte (size_t)
+ */
+size_t get_padding_size(const uint8_t *padded_plaintext, size_t padded_length);
+
+/**
+ * Struct that represents one message of a batch
+ *
+ * @param data the message (uint8_t array)
+ * @param size the message size (size_t)
+ */
+struct edes_message
+{
+    const uint8_t *data;
+    size_t size;
+};
+
+/**
+ * Function that applies the PCKS#7 padding into a caller buffer, the plaintext may already be at the start of that buffer
+ *
+ * @param plaintext the plaintext (uint8_t array)
+ * @param plaintext_length the plaintext length (size_t)
+ * @param padded_plaintext the padded plaintext (uint8_t array)
+ * @param padded_capacity the padded plaintext buffer size (size_t)
+ * @param padded_length pointer to the padded length (size_t)
+ *
+ * @return EDES_OK, or EDES_ERROR_BUFFER_TOO_SMALL
+ */
+int add_padding_into(const uint8_t *plaintext, size_t plaintext_length, uint8_t *padded_plaintext, size_t padded_capacity, size_t *padded_length);
+
+/**
+ * Function that removes the PCKS#7 padding into a caller buffer, the padded plaintext may already be at the start of that buffer
+ *
+ * @param padded_plaintext the padded plaintext (uint8_t array)
+ * @param padded_length the padded plaintext length (size_t)
  * @param plaintext the plaintext (uint8_t array)
+ * @param plaintext_capacity the plaintext buffer size (size_t)
+ * @param plaintext_length pointer to the plaintext length (size_t)
+ *
+ * @return EDES_OK, or EDES_ERROR_BUFFER_TOO_SMALL
+ */
+int remove_padding_into(const uint8_t *padded_plaintext, size_t padded_length, uint8_t *plaintext, size_t plaintext_capacity, size_t *plaintext_length);
+
+/**
+ * Function that initializes a bump arena over caller-owned memory
+ *
+ * @param arena pointer to the arena (struct edes_arena)
+ * @param memory the memory of the arena
+ * @param size the size of the memory (size_t)
+ */
+void edes_arena_init(struct edes_arena *arena, void *memory, size_t size);
+
+/**
+ * Function that carves a buffer from the arena, aligned to EDES_ARENA_ALIGNMENT bytes
+ *
+ * @param arena pointer to the arena (struct edes_arena)
+ * @param size the size of the buffer (size_t)
+ *
+ * @return pointer to the buffer, NULL if the arena is full
+ */
+void *edes_arena_alloc(struct edes_arena *arena, size_t size);
+
+/**
+ * Function that gives back all the buffers of the arena at once
+ *
+ * @param arena pointer to the arena (struct edes_arena)
+ */
+void edes_arena_reset(struct edes_arena *arena);
+
+/**
+ * Function that initializes the key context, it derives the sboxes from the password
+ *
+ * @param ctx pointer to the key context (struct edes_ctx)
  * @param password the password (uint8_t array)
+ */
+void edes_ctx_init(struct edes_ctx *ctx, const uint8_t *password);
+
+/**
+ * Function that wipes the key material of the key context
+ *
+ * @param ctx pointer to the key context (struct edes_ctx)
+ */
+void edes_ctx_clear(struct edes_ctx *ctx);
+
+/**
+ * Encrypt Function into a caller buffer, no memory is allocated
+ *
+ * @param ctx the key context (struct edes_ctx)
+ * @param plaintext the plaintext (uint8_t array)
+ * @param plaintext_size the plaintext size (size_t)
+ * @param ciphertext the ciphertext buffer (uint8_t array)
+ * @param ciphertext_capacity the ciphertext buffer size, at least the plaintext size rounded up to the next multiple of BLOCK_SIZE (size_t)
+ * @param ciphertext_size pointer to the ciphertext size (size_t)
+ *
+ * @return EDES_OK, or EDES_ERROR_BUFFER_TOO_SMALL
+ */
+int edes_encrypt_into(const struct edes_ctx *ctx, const uint8_t *plaintext, size_t plaintext_size, uint8_t *ciphertext, size_t ciphertext_capacity, size_t *ciphertext_size);
+
+/**
+ * Decrypt Function into a caller buffer, no memory is allocated
+ *
+ * @param ctx the key context (struct edes_ctx)
+ * @param ciphertext the ciphertext (uint8_t array)
+ * @param ciphertext_size the ciphertext size (size_t)
+ * @param plaintext the plaintext buffer (uint8_t array)
+ * @param plaintext_capacity the plaintext buffer size, at least the plaintext size (size_t)
+ * @param plaintext_size pointer to the plaintext size (size_t)
+ *
+ * @return EDES_OK, EDES_ERROR_INVALID_SIZE if the ciphertext size is not a non-zero multiple of BLOCK_SIZE, or EDES_ERROR_BUFFER_TOO_SMALL
+ */
+int edes_decrypt_into(const struct edes_ctx *ctx, const uint8_t *ciphertext, size_t ciphertext_size, uint8_t *plaintext, size_t plaintext_capacity, size_t *plaintext_size);
+
+/**
+ * Encrypt Function with the ciphertext carved from a bump arena
+ *
+ * @param ctx the key context (struct edes_ctx)
+ * @param arena pointer to the arena (struct edes_arena)
+ * @param plaintext the plaintext (uint8_t array)
+ * @param plaintext_size the plaintext size (size_t)
  * @param ciphertext pointer to the ciphertext (uint8_t array)
  * @param ciphertext_size pointer to the ciphertext size (size_t)
+ *
+ * @return EDES_OK, or EDES_ERROR_BUFFER_TOO_SMALL if the arena is full
  */
-void encrypt(const uint8_t *plaintext, const uint8_t *password, uint8_t **ciphertext, size_t *ciphertext_size);
+int edes_encrypt_arena(const struct edes_ctx *ctx, struct edes_arena *arena, const uint8_t *plaintext, size_t plaintext_size, uint8_t **ciphertext, size_t *ciphertext_size);
 
 /**
- * Decrypt Function, receives the ciphertext, the key and a pointer to the plaintext
+ * Decrypt Function with the plaintext carved from a bump arena
  *
+ * @param ctx the key context (struct edes_ctx)
+ * @param arena pointer to the arena (struct edes_arena)
  * @param ciphertext the ciphertext (uint8_t array)
- * @param password the password (uint8_t array)
+ * @param ciphertext_size the ciphertext size (size_t)
  * @param plaintext pointer to the plaintext (uint8_t array)
  * @param plaintext_size pointer to the plaintext size (size_t)
+ *
+ * @return EDES_OK, EDES_ERROR_INVALID_SIZE, or EDES_ERROR_BUFFER_TOO_SMALL if the arena is full
+ */
+int edes_decrypt_arena(const struct edes_ctx *ctx, struct edes_arena *arena, const uint8_t *ciphertext, size_t ciphertext_size, uint8_t **plaintext, size_t *plaintext_size);
+
+/**
+ * Encrypt Function with a precomputed key context, receives the plaintext and its size and a pointer to the ciphertext
+ *
+ * @param ctx the key context (struct edes_ctx)
+ * @param plaintext the plaintext (uint8_t array)
+ * @param plaintext_size the plaintext size (size_t)
+ * @param ciphertext pointer to the ciphertext, NULL on error (uint8_t array)
+ * @param ciphertext_size pointer to the ciphertext size (size_t)
+ *
+ * @return EDES_OK, or EDES_ERROR_OUT_OF_MEMORY
+ */
+int edes_encrypt(const struct edes_ctx *ctx, const uint8_t *plaintext, size_t plaintext_size, uint8_t **ciphertext, size_t *ciphertext_size);
+
+/**
+ * Decrypt Function with a precomputed key context, receives the ciphertext and its size and a pointer to the plaintext
+ *
+ * @param ctx the key context (struct edes_ctx)
+ * @param ciphertext the ciphertext (uint8_t array)
+ * @param ciphertext_size the ciphertext size (size_t)
+ * @param plaintext pointer to the plaintext, NULL on error (uint8_t array)
+ * @param plaintext_size pointer to the plaintext size (size_t)
+ *
+ * @return EDES_OK, EDES_ERROR_INVALID_SIZE if the ciphertext size is not a non-zero multiple of BLOCK_SIZE, or EDES_ERROR_OUT_OF_MEMORY
+ */
+int edes_decrypt(const struct edes_ctx *ctx, const uint8_t *ciphertext, size_t ciphertext_size, uint8_t **plaintext, size_t *plaintext_size);
+
+/**
+ * Function that returns the arena size needed to encrypt a batch of messages (the sum of the padded sizes)
+ *
+ * @param messages the plaintext messages (struct edes_message array)
+ * @param number_of_messages the number of messages (size_t)
+ *
+ * @return the arena size in bytes, SIZE_MAX if it does not fit in a size_t (size_t)
  */
-void decrypt(const uint8_t *ciphertext, const size_t ciphertext_size, const uint8_t *password, uint8_t **plaintext, size_t *plaintext_size);
+size_t edes_encrypt_batch_size(const struct edes_message *messages, size_t number_of_messages);
+
+/**
+ * Batch Encrypt Function, pads every message into the arena one after the other and ciphers all the blocks with a single call to the block kernel
+ *
+ * The ciphertext of the message i is arena[offsets[i]] to arena[offsets[i + 1]], so offsets must have room for number_of_messages + 1 entries
+ *
+ * @param ctx the key context (struct edes_ctx)
+ * @param messages the plaintext messages (struct edes_message array)
+ * @param number_of_messages the number of messages (size_t)
+ * @param arena the output arena (uint8_t array)
+ * @param arena_size the arena size, at least edes_encrypt_batch_size (size_t)
+ * @param offsets the offsets of the ciphertexts in the arena (size_t array)
+ *
+ * @return EDES_OK, or EDES_ERROR_BUFFER_TOO_SMALL if the arena is smaller than edes_encrypt_batch_size (nothing is written)
+ */
+int edes_encrypt_batch(const struct edes_ctx *ctx, const struct edes_message *messages, size_t number_of_messages, uint8_t *arena, size_t arena_size, size_t *offsets);
+
+/**
+ * Batch Decrypt Function, copies every ciphertext into the arena one after the other and deciphers all the blocks with a single call to the block kernel
+ *
+ * The plaintext of the message i is plaintext_sizes[i] bytes at arena[offsets[i]], offsets must have room for number_of_messages + 1 entries
+ *
+ * @param ctx the key context (struct edes_ctx)
+ * @param messages the ciphertext messages, sizes multiple of BLOCK_SIZE (struct edes_message array)
+ * @param number_of_messages the number of messages (size_t)
+ * @param arena the output arena (uint8_t array)
+ * @param arena_size the arena size, at least the sum of the ciphertext sizes (size_t)
+ * @param offsets the offsets of the plaintexts in the arena (size_t array)
+ * @param plaintext_sizes the plaintext sizes (size_t array)
+ *
+ * @return EDES_OK, EDES_ERROR_INVALID_SIZE if a ciphertext size is not a non-zero multiple of BLOCK_SIZE, or EDES_ERROR_BUFFER_TOO_SMALL if the arena is full (nothing is deciphered)
+ */
+int edes_decrypt_batch(const struct edes_ctx *ctx, const struct edes_message *messages, size_t number_of_messages, uint8_t *arena, size_t arena_size, size_t *offsets, size_t *plaintext_sizes);
+
+/**
+ * Encrypt Function, receives the plaintext, the password and a pointer to the ciphertext (wrapper that builds a key context for a single call)
+ *
+ * @param plaintext the plaintext (uint8_t array)
+ * @param plaintext_size the plaintext size, the plaintext may contain zero bytes (size_t)
+ * @param password the password (uint8_t array)
+ * @param ciphertext pointer to the ciphertext, NULL on error (uint8_t array)
+ * @param ciphertext_size pointer to the ciphertext size (size_t)
+ *
+ * @return EDES_OK, or EDES_ERROR_OUT_OF_MEMORY
+ */
+int encrypt(const uint8_t *plaintext, size_t plaintext_size, const uint8_t *password, uint8_t **ciphertext, size_t *ciphertext_size);
+
+/**
+ * Decrypt Function, receives the ciphertext, the key and a pointer to the plaintext (wrapper that builds a key context for a single call)
+ *
+ * @param ciphertext the ciphertext (uint8_t array)
+ * @param password the password (uint8_t array)
+ * @param plaintext pointer to the plaintext, NULL on error (uint8_t array)
+ * @param plaintext_size pointer to the plaintext size (size_t)
+ *
+ * @return EDES_OK, EDES_ERROR_INVALID_SIZE if the ciphertext size is not a non-zero multiple of BLOCK_SIZE, or EDES_ERROR_OUT_OF_MEMORY
+ */
+int decrypt(const uint8_t *ciphertext, const size_t ciphertext_size, const uint8_t *password, uint8_t **plaintext, size_t *plaintext_size);
 
 /**
  * ECB Encrypt Function, receives the plaintext, the password and a pointer to the ciphertext
  *
  * @param plaintext the plaintext (uint8_t array)
+ * @param plaintext_size the plaintext size, the plaintext may contain zero bytes (size_t)
  * @param password the password (uint8_t array)
- * @param ciphertext pointer to the ciphertext (uint8_t array)
+ * @param ciphertext pointer to the ciphertext, NULL on error (uint8_t array)
  * @param ciphertext_size pointer to the ciphertext size (size_t)
  *
+ * @return EDES_OK, EDES_ERROR_CRYPTO if the DES key could not be set up, or EDES_ERROR_OUT_OF_MEMORY
  */
-void ecb_encrypt(const uint8_t *plaintext, const uint8_t *password, uint8_t **ciphertext, size_t *ciphertext_size);
+int ecb_encrypt(const uint8_t *plaintext, size_t plaintext_size, const uint8_t *password, uint8_t **ciphertext, size_t *ciphertext_size);
 
 /**
  * ECB Decrypt Function, receives the ciphertext, the password and a pointer to the plaintext
@@ -180,10 +503,242 @@ void ecb_encrypt(const uint8_t *plaintext, const uint8_t *password, uint8_t **ci
  * @param ciphertext the ciphertext (uint8_t array)
  * @param ciphertext_size the ciphertext size (size_t)
  * @param password the password (uint8_t array)
- * @param plaintext pointer to the plaintext (uint8_t array)
+ * @param plaintext pointer to the plaintext, NULL on error (uint8_t array)
  * @param plaintext_size pointer to the plaintext size (size_t)
  *
+ * @return EDES_OK, EDES_ERROR_CRYPTO if the DES key could not be set up, EDES_ERROR_INVALID_SIZE if the ciphertext size is not a non-zero multiple of BLOCK_SIZE, or EDES_ERROR_OUT_OF_MEMORY
+ */
+int ecb_decrypt(const uint8_t *ciphertext, const size_t ciphertext_size, const uint8_t *password, uint8_t **plaintext, size_t *plaintext_size);
+
+/**
+ * Function that ciphers the blocks in place with the portable kernel, the rounds of INTERLEAVE_WIDTH blocks are interleaved to hide the latency of the sbox loads
+ *
+ * @param blocks the blocks (uint8_t array)
+ * @param number_of_bytes the number of bytes to cipher, multiple of BLOCK_SIZE (size_t)
+ * @param sboxes the sboxes (struct s_box array)
+ */
+void e_des_encrypt_blocks_scalar(uint8_t *blocks, size_t number_of_bytes, const void *sboxes);
+
+/**
+ * Function that deciphers the blocks in place with the portable kernel, the rounds of INTERLEAVE_WIDTH blocks are interleaved to hide the latency of the sbox loads
+ *
+ * @param blocks the blocks (uint8_t array)
+ * @param number_of_bytes the number of bytes to decipher, multiple of BLOCK_SIZE (size_t)
+ * @param sboxes the sboxes (struct s_box array)
+ */
+void e_des_decrypt_blocks_scalar(uint8_t *blocks, size_t number_of_bytes, const void *sboxes);
+
+/**
+ * Function that ciphers the blocks in place with the e-des mode, with the block kernel picked by e_des_kernel_name
+ *
+ * @param blocks the blocks (uint8_t array)
+ * @param number_of_bytes the number of bytes to cipher, multiple of BLOCK_SIZE (size_t)
+ * @param sboxes the sboxes (struct s_box array)
+ */
+void e_des_encrypt_blocks(uint8_t *blocks, size_t number_of_bytes, const void *sboxes);
+
+/**
+ * Function that deciphers the blocks in place with the e-des mode, with the block kernel picked by e_des_kernel_name
+ *
+ * @param blocks the blocks (uint8_t array)
+ * @param number_of_bytes the number of bytes to decipher, multiple of BLOCK_SIZE (size_t)
+ * @param sboxes the sboxes (struct s_box array)
+ */
+void e_des_decrypt_blocks(uint8_t *blocks, size_t number_of_bytes, const void *sboxes);
+
+/**
+ * Function that returns the name of the block kernel used by e_des_encrypt_blocks/e_des_decrypt_blocks
+ *
+ * The kernel is picked once, on the first call, from the CPU features: avx512 (AVX-512 VBMI), then avx2, then scalar.
+ * The ssse3 kernel is slower than the interleaved scalar kernel so it is only used when forced.
+ * The E_DES_KERNEL environment variable forces a kernel, a kernel that is unknown or not supported by the CPU is replaced by the best supported one (with a warning on stderr).
+ *
+ * @return the name of the kernel (char array)
+ */
+const char *e_des_kernel_name(void);
+
+/**
+ * Function that generates the des-ecb key from the password (only the first DES_KEY_SIZE bytes are used, shorter passwords are padded with zeros)
+ *
+ * @param password the password (uint8_t array)
+ * @param key pointer to the key, zeroed on error (struct des_key)
+ *
+ * @return EDES_OK, or EDES_ERROR_CRYPTO if OpenSSL does not provide DES-ECB (legacy provider)
+ */
+int generate_des_key(const uint8_t *password, struct des_key *key);
+
+/**
+ * Function that generates the 3des-ede key from the password (the first TRIPLE_DES_KEY_SIZE bytes of its SHA-256, so the three keys differ for any password)
+ *
+ * @param password the password (uint8_t array)
+ * @param key pointer to the key, zeroed on error (struct des_key)
+ *
+ * @return EDES_OK, or EDES_ERROR_CRYPTO if OpenSSL does not provide DES-EDE3-ECB
+ */
+int generate_triple_des_key(const uint8_t *password, struct des_key *key);
+
+/**
+ * Function that wipes a des-ecb/3des-ede key
+ *
+ * @param key pointer to the key (struct des_key)
+ */
+void des_key_clear(struct des_key *key);
+
+/**
+ * Function that ciphers/deciphers the blocks in place with the des-ecb or 3des-ede mode, in one EVP_CipherUpdate per DES_UPDATE_SIZE bytes with the cached context of the thread
+ *
+ * @param blocks the blocks (uint8_t array)
+ * @param number_of_bytes the number of bytes, multiple of BLOCK_SIZE (size_t)
+ * @param key the key (struct des_key)
+ * @param encrypt 1 to cipher, 0 to decipher (int)
+ *
+ * @return EDES_OK, EDES_ERROR_OUT_OF_MEMORY (context of the thread) or EDES_ERROR_CRYPTO
+ */
+int des_ecb_process_blocks(uint8_t *blocks, size_t number_of_bytes, const struct des_key *key, int encrypt);
+
+/**
+ * Function that ciphers the blocks in place with the des-ecb or 3des-ede mode (des_ecb_process_blocks as a block_cipher_function, the program exits on error)
+ *
+ * @param blocks the blocks (uint8_t array)
+ * @param number_of_bytes the number of bytes to cipher, multiple of BLOCK_SIZE (size_t)
+ * @param key the key (struct des_key)
+ */
+void des_ecb_encrypt_blocks(uint8_t *blocks, size_t number_of_bytes, const void *key);
+
+/**
+ * Function that deciphers the blocks in place with the des-ecb or 3des-ede mode (des_ecb_process_blocks as a block_cipher_function, the program exits on error)
+ *
+ * @param blocks the blocks (uint8_t array)
+ * @param number_of_bytes the number of bytes to decipher, multiple of BLOCK_SIZE (size_t)
+ * @param key the key (struct des_key)
+ */
+void des_ecb_decrypt_blocks(uint8_t *blocks, size_t number_of_bytes, const void *key);
+
+/**
+ * Function that pads and ciphers a buffer in place, the padding is written in the slack after the data
+ *
+ * @param cipher the function that ciphers the blocks (block_cipher_function)
+ * @param key the key of the cipher function
+ * @param buffer the buffer, holds the plaintext and receives the ciphertext (uint8_t array)
+ * @param length the plaintext length (size_t)
+ * @param capacity the buffer size, at least the length plus BLOCK_SIZE is always enough (size_t)
+ * @param ciphertext_size pointer to the ciphertext size (size_t)
+ *
+ * @return EDES_OK, or EDES_ERROR_BUFFER_TOO_SMALL if there is no room for the padding
+ */
+int encrypt_in_place(block_cipher_function cipher, const void *key, uint8_t *buffer, size_t length, size_t capacity, size_t *ciphertext_size);
+
+/**
+ * Function that deciphers a buffer in place, the plaintext is left at the start of the buffer
+ *
+ * @param decipher the function that deciphers the blocks (block_cipher_function)
+ * @param key the key of the decipher function
+ * @param buffer the buffer, holds the ciphertext and receives the plaintext (uint8_t array)
+ * @param length the ciphertext length (size_t)
+ * @param plaintext_size pointer to the plaintext size, without the padding (size_t)
+ *
+ * @return EDES_OK, or EDES_ERROR_INVALID_SIZE if the length is not a non-zero multiple of BLOCK_SIZE
+ */
+int decrypt_in_place(block_cipher_function decipher, const void *key, uint8_t *buffer, size_t length, size_t *plaintext_size);
+
+/**
+ * Encrypt Function in place with a precomputed key context
+ *
+ * @param ctx the key context (struct edes_ctx)
+ * @param buffer the buffer, holds the plaintext and receives the ciphertext (uint8_t array)
+ * @param length the plaintext length (size_t)
+ * @param capacity the buffer size, at least the length plus BLOCK_SIZE is always enough (size_t)
+ * @param ciphertext_size pointer to the ciphertext size (size_t)
+ *
+ * @return EDES_OK, or EDES_ERROR_BUFFER_TOO_SMALL
+ */
+int edes_encrypt_in_place(const struct edes_ctx *ctx, uint8_t *buffer, size_t length, size_t capacity, size_t *ciphertext_size);
+
+/**
+ * Decrypt Function in place with a precomputed key context
+ *
+ * @param ctx the key context (struct edes_ctx)
+ * @param buffer the buffer, holds the ciphertext and receives the plaintext (uint8_t array)
+ * @param length the ciphertext length (size_t)
+ * @param plaintext_size pointer to the plaintext size (size_t)
+ *
+ * @return EDES_OK, or EDES_ERROR_INVALID_SIZE
+ */
+int edes_decrypt_in_place(const struct edes_ctx *ctx, uint8_t *buffer, size_t length, size_t *plaintext_size);
+
+/**
+ * Stream Encrypt Function, reads the plaintext in chunks of buffer_size bytes, ciphers them and writes them, the padding is only added to the final block
+ *
+ * @param input the input stream (FILE)
+ * @param output the output stream (FILE)
+ * @param cipher the function that ciphers whole blocks (block_cipher_function)
+ * @param key the key material given to the cipher function
+ * @param buffer_size the size of the chunks, multiple of BLOCK_SIZE (size_t)
+ */
+void stream_encrypt(FILE *input, FILE *output, block_cipher_function cipher, const void *key, size_t buffer_size);
+
+/**
+ * Stream Decrypt Function, reads the ciphertext in chunks of buffer_size bytes, deciphers them and writes them, the last block is held back so its padding can be removed
+ *
+ * @param input the input stream (FILE)
+ * @param output the output stream (FILE)
+ * @param decipher the function that deciphers whole blocks (block_cipher_function)
+ * @param key the key material given to the decipher function
+ * @param buffer_size the size of the chunks, multiple of BLOCK_SIZE (size_t)
+ */
+void stream_decrypt(FILE *input, FILE *output, block_cipher_function decipher, const void *key, size_t buffer_size);
+
+/**
+ * File Encrypt Function, maps the input file and a pre-sized output file in memory and ciphers the mapped pages directly, chunk by chunk, so only a few chunks are resident at a time
+ *
+ * @param input_path the path of the plaintext file (char array)
+ * @param output_path the path of the ciphertext file, NULL to cipher the input file in place (char array)
+ * @param cipher the function that ciphers whole blocks (block_cipher_function)
+ * @param key the key material given to the cipher function
+ * @param chunk_size the size of the chunks, multiple of the page size (size_t)
+ */
+void file_encrypt(const char *input_path, const char *output_path, block_cipher_function cipher, const void *key, size_t chunk_size);
+
+/**
+ * File Decrypt Function, maps the input file and a pre-sized output file in memory and deciphers the mapped pages directly, the output file is truncated at the end to remove the padding
+ *
+ * @param input_path the path of the ciphertext file (char array)
+ * @param output_path the path of the plaintext file, NULL to decipher the input file in place (char array)
+ * @param decipher the function that deciphers whole blocks (block_cipher_function)
+ * @param key the key material given to the decipher function
+ * @param chunk_size the size of the chunks, multiple of the page size (size_t)
+ */
+void file_decrypt(const char *input_path, const char *output_path, block_cipher_function decipher, const void *key, size_t chunk_size);
+
+/**
+ * Range Decrypt Function, deciphers only the plaintext bytes offset to offset + length of an ECB ciphertext file, no memory is allocated
+ *
+ * Only the blocks that cover the range are read (pread), the partial first and last blocks are trimmed. The padding is only read when the range reaches the final block,
+ * the range is then clipped to the end of the plaintext
+ *
+ * @param file_descriptor the ciphertext file, must support pread (int)
+ * @param decipher the function that deciphers whole blocks (block_cipher_function)
+ * @param key the key material given to the decipher function
+ * @param offset the offset of the range in the plaintext (uint64_t)
+ * @param length the length of the range (size_t)
+ * @param plaintext the plaintext buffer, at least length bytes (uint8_t array)
+ * @param plaintext_size pointer to the number of bytes deciphered, less than length when the range goes past the end of the plaintext (size_t)
+ *
+ * @return EDES_OK, EDES_ERROR_INVALID_SIZE if the file size is not a non-zero multiple of BLOCK_SIZE, or EDES_ERROR_IO
+ */
+int decrypt_range(int file_descriptor, block_cipher_function decipher, const void *key, uint64_t offset, size_t length, uint8_t *plaintext, size_t *plaintext_size);
+
+/**
+ * File Range Decrypt Function, deciphers the plaintext bytes offset to offset + length of an ECB ciphertext file and writes them, in chunks of buffer_size bytes
+ *
+ * @param file_descriptor the ciphertext file, must support pread (int)
+ * @param output the output stream (FILE)
+ * @param decipher the function that deciphers whole blocks (block_cipher_function)
+ * @param key the key material given to the decipher function
+ * @param offset the offset of the range in the plaintext (uint64_t)
+ * @param length the length of the range, SIZE_MAX for the rest of the plaintext (size_t)
+ * @param buffer_size the size of the chunks, multiple of BLOCK_SIZE (size_t)
  */
-void ecb_decrypt(const uint8_t *ciphertext, const size_t ciphertext_size, const uint8_t *password, uint8_t **plaintext, size_t *plaintext_size);
+void file_decrypt_range(int file_descriptor, FILE *output, block_cipher_function decipher, const void *key, uint64_t offset, size_t length, size_t buffer_size);
 
 #endif
\ No newline at end of file
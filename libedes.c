@@ -0,0 +1,221 @@
+/**
+ * @file libedes.c
+ * @brief Implementation of the public API of libedes
+ *
+ * @author Ana Vidal (118408)
+ * @author Simão Andrade (118345)
+ * @date 2023-10-20
+ */
+
+#include "libedes.h"
+#include "implementation.h"
+#include "cbc.h"
+
+#define EDES_STRINGIFY(x) #x
+#define EDES_VERSION_STRING(major, minor, patch) EDES_STRINGIFY(major) "." EDES_STRINGIFY(minor) "." EDES_STRINGIFY(patch)
+
+/**
+ * Struct behind the opaque key context of the public API
+ *
+ * @param ctx the precomputed key context (struct edes_ctx)
+ */
+struct edes_key
+{
+    struct edes_ctx ctx;
+};
+
+const char *edes_version(int *major, int *minor, int *patch)
+{
+    if (major != NULL)
+    {
+        *major = EDES_VERSION_MAJOR;
+    }
+    if (minor != NULL)
+    {
+        *minor = EDES_VERSION_MINOR;
+    }
+    if (patch != NULL)
+    {
+        *patch = EDES_VERSION_PATCH;
+    }
+
+    return EDES_VERSION_STRING(EDES_VERSION_MAJOR, EDES_VERSION_MINOR, EDES_VERSION_PATCH);
+}
+
+const char *edes_strerror(int status)
+{
+    switch (status)
+    {
+    case EDES_OK:
+        return "success";
+    case EDES_ERROR_BUFFER_TOO_SMALL:
+        return "buffer too small";
+    case EDES_ERROR_INVALID_SIZE:
+        return "invalid size";
+    case EDES_ERROR_INVALID_ARGUMENT:
+        return "invalid argument";
+    case EDES_ERROR_IO:
+        return "input/output error";
+    case EDES_ERROR_OUT_OF_MEMORY:
+        return "out of memory";
+    case EDES_ERROR_CRYPTO:
+        return "cryptographic library error";
+    case EDES_ERROR_CORRUPTED:
+        return "corrupted or truncated data";
+    case EDES_ERROR_KEY_MISMATCH:
+        return "the key check value does not match (wrong password or mode)";
+    default:
+        return "unknown error";
+    }
+}
+
+const char *edes_kernel_name(void)
+{
+    return e_des_kernel_name();
+}
+
+int edes_key_create(edes_key **key, const uint8_t *password, size_t password_size)
+{
+    if (key == NULL || password == NULL || password_size == 0)
+    {
+        return EDES_ERROR_INVALID_ARGUMENT;
+    }
+
+    // The sboxes are derived from a NUL-terminated password, so a zero byte would silently cut it
+    if (memchr(password, 0, password_size) != NULL)
+    {
+        return EDES_ERROR_INVALID_ARGUMENT;
+    }
+
+    uint8_t *terminated_password = (uint8_t *)malloc(password_size + 1);
+    edes_key *new_key = (edes_key *)malloc(sizeof(edes_key));
+
+    if (terminated_password == NULL || new_key == NULL)
+    {
+        free(terminated_password);
+        free(new_key);
+        return EDES_ERROR_OUT_OF_MEMORY;
+    }
+
+    memcpy(terminated_password, password, password_size);
+    terminated_password[password_size] = '\0';
+
+    edes_ctx_init(&new_key->ctx, terminated_password);
+
+    // Volatile pointer so the compiler does not drop the wipe of the password copy
+    volatile uint8_t *bytes = terminated_password;
+    for (size_t index = 0; index < password_size; index++)
+    {
+        bytes[index] = 0;
+    }
+    free(terminated_password);
+
+    *key = new_key;
+
+    return EDES_OK;
+}
+
+void edes_key_destroy(edes_key *key)
+{
+    if (key == NULL)
+    {
+        return;
+    }
+
+    edes_ctx_clear(&key->ctx);
+    free(key);
+}
+
+size_t edes_ciphertext_size(size_t plaintext_size)
+{
+    return plaintext_size + BLOCK_SIZE - (plaintext_size % BLOCK_SIZE);
+}
+
+int edes_key_encrypt(const edes_key *key, const uint8_t *plaintext, size_t plaintext_size, uint8_t *ciphertext, size_t ciphertext_capacity, size_t *ciphertext_size)
+{
+    if (key == NULL || (plaintext == NULL && plaintext_size != 0) || ciphertext == NULL || ciphertext_size == NULL)
+    {
+        return EDES_ERROR_INVALID_ARGUMENT;
+    }
+
+    return edes_encrypt_into(&key->ctx, plaintext, plaintext_size, ciphertext, ciphertext_capacity, ciphertext_size);
+}
+
+int edes_key_decrypt(const edes_key *key, const uint8_t *ciphertext, size_t ciphertext_size, uint8_t *plaintext, size_t plaintext_capacity, size_t *plaintext_size)
+{
+    if (key == NULL || ciphertext == NULL || plaintext == NULL || plaintext_size == NULL)
+    {
+        return EDES_ERROR_INVALID_ARGUMENT;
+    }
+
+    return edes_decrypt_into(&key->ctx, ciphertext, ciphertext_size, plaintext, plaintext_capacity, plaintext_size);
+}
+
+int edes_key_encrypt_in_place(const edes_key *key, uint8_t *buffer, size_t length, size_t capacity, size_t *ciphertext_size)
+{
+    if (key == NULL || buffer == NULL || ciphertext_size == NULL)
+    {
+        return EDES_ERROR_INVALID_ARGUMENT;
+    }
+
+    return edes_encrypt_in_place(&key->ctx, buffer, length, capacity, ciphertext_size);
+}
+
+int edes_key_decrypt_in_place(const edes_key *key, uint8_t *buffer, size_t length, size_t *plaintext_size)
+{
+    if (key == NULL || buffer == NULL || plaintext_size == NULL)
+    {
+        return EDES_ERROR_INVALID_ARGUMENT;
+    }
+
+    return edes_decrypt_in_place(&key->ctx, buffer, length, plaintext_size);
+}
+
+int edes_cbc_encrypt_batch(const edes_key *key, edes_cbc_stream *streams, size_t number_of_streams)
+{
+    if (key == NULL || (streams == NULL && number_of_streams != 0))
+    {
+        return EDES_ERROR_INVALID_ARGUMENT;
+    }
+
+    for (size_t stream = 0; stream < number_of_streams; stream++)
+    {
+        if (streams[stream].buffer == NULL || streams[stream].iv == NULL)
+        {
+            return EDES_ERROR_INVALID_ARGUMENT;
+        }
+
+        if (streams[stream].length > SIZE_MAX - BLOCK_SIZE || streams[stream].capacity < edes_ciphertext_size(streams[stream].length))
+        {
+            return EDES_ERROR_BUFFER_TOO_SMALL;
+        }
+    }
+
+    // One group of CBC_STREAMS_PER_TASK streams at a time, so the messages live on the stack
+    struct cbc_message messages[CBC_STREAMS_PER_TASK];
+
+    for (size_t first = 0; first < number_of_streams; first += CBC_STREAMS_PER_TASK)
+    {
+        size_t number_of_messages = number_of_streams - first;
+
+        if (number_of_messages > CBC_STREAMS_PER_TASK)
+        {
+            number_of_messages = CBC_STREAMS_PER_TASK;
+        }
+
+        for (size_t message = 0; message < number_of_messages; message++)
+        {
+            edes_cbc_stream *stream = &streams[first + message];
+
+            stream->ciphertext_size = apply_padding(stream->buffer, stream->length);
+
+            messages[message].data = stream->buffer;
+            messages[message].size = stream->ciphertext_size;
+            messages[message].iv = stream->iv;
+        }
+
+        cbc_encrypt_messages(NULL, key->ctx.sboxes, messages, number_of_messages);
+    }
+
+    return EDES_OK;
+}
@@ -0,0 +1,198 @@
+#ifndef __LIBEDES_H__
+#define __LIBEDES_H__
+
+/**
+ * @file libedes.h
+ * @brief Public API of libedes
+ *
+ * This file is the only header needed to use libedes.a/libedes.so. The key context is opaque, every buffer is given with its length and every error is returned as a status code (the library never exits, not even on a bad E_DES_KERNEL, which falls back to the best supported kernel).
+ * Only the functions of this header are exported by libedes.so, the internals (implementation.h) are compiled with link-time optimization so they are still inlined across files.
+ *
+ * The API is versioned: functions are only added in minor versions, an incompatible change bumps EDES_VERSION_MAJOR (and the soname, libedes.so.<major>).
+ *
+ * @author Ana Vidal (118408)
+ * @author Simão Andrade (118345)
+ * @date 2023-10-20
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Version of the API
+#define EDES_VERSION_MAJOR 1
+#define EDES_VERSION_MINOR 1
+#define EDES_VERSION_PATCH 0
+
+// Symbols exported by libedes.so
+#if defined(__GNUC__)
+#define EDES_API __attribute__((visibility("default")))
+#else
+#define EDES_API
+#endif
+
+// Status codes
+#define EDES_OK 0
+#define EDES_ERROR_BUFFER_TOO_SMALL -1
+#define EDES_ERROR_INVALID_SIZE -2
+#define EDES_ERROR_INVALID_ARGUMENT -3
+#define EDES_ERROR_IO -4
+#define EDES_ERROR_OUT_OF_MEMORY -5
+#define EDES_ERROR_CRYPTO -6
+#define EDES_ERROR_CORRUPTED -7
+#define EDES_ERROR_KEY_MISMATCH -8
+
+#define EDES_BLOCK_SIZE 8 // 64 bits
+
+/**
+ * Opaque key context, the sboxes derived from a password, it is never modified after edes_key_create so it can be shared read-only between threads
+ */
+typedef struct edes_key edes_key;
+
+/**
+ * Function that returns the version of the library
+ *
+ * @param major pointer to the major version, may be NULL (int)
+ * @param minor pointer to the minor version, may be NULL (int)
+ * @param patch pointer to the patch version, may be NULL (int)
+ *
+ * @return the version as "major.minor.patch" (char array)
+ */
+EDES_API const char *edes_version(int *major, int *minor, int *patch);
+
+/**
+ * Function that describes a status code
+ *
+ * @param status the status code (int)
+ *
+ * @return the description (char array)
+ */
+EDES_API const char *edes_strerror(int status);
+
+/**
+ * Function that returns the name of the block kernel picked for this CPU (scalar, ssse3, avx2 or avx512)
+ *
+ * @return the name of the kernel (char array)
+ */
+EDES_API const char *edes_kernel_name(void);
+
+/**
+ * Function that derives a key context from a password
+ *
+ * @param key pointer to the new key context (edes_key)
+ * @param password the password, it must not contain zero bytes (uint8_t array)
+ * @param password_size the password size, non-zero (size_t)
+ *
+ * @return EDES_OK, EDES_ERROR_INVALID_ARGUMENT or EDES_ERROR_OUT_OF_MEMORY
+ */
+EDES_API int edes_key_create(edes_key **key, const uint8_t *password, size_t password_size);
+
+/**
+ * Function that wipes and frees a key context, NULL is ignored
+ *
+ * @param key the key context (edes_key)
+ */
+EDES_API void edes_key_destroy(edes_key *key);
+
+/**
+ * Function that returns the ciphertext size of a plaintext (the padding adds 1 to EDES_BLOCK_SIZE bytes)
+ *
+ * @param plaintext_size the plaintext size (size_t)
+ *
+ * @return the ciphertext size (size_t)
+ */
+EDES_API size_t edes_ciphertext_size(size_t plaintext_size);
+
+/**
+ * Encrypt Function into a caller buffer
+ *
+ * @param key the key context (edes_key)
+ * @param plaintext the plaintext (uint8_t array)
+ * @param plaintext_size the plaintext size (size_t)
+ * @param ciphertext the ciphertext buffer, must not overlap the plaintext (uint8_t array)
+ * @param ciphertext_capacity the ciphertext buffer size, at least edes_ciphertext_size(plaintext_size) (size_t)
+ * @param ciphertext_size pointer to the ciphertext size (size_t)
+ *
+ * @return EDES_OK, EDES_ERROR_INVALID_ARGUMENT or EDES_ERROR_BUFFER_TOO_SMALL
+ */
+EDES_API int edes_key_encrypt(const edes_key *key, const uint8_t *plaintext, size_t plaintext_size, uint8_t *ciphertext, size_t ciphertext_capacity, size_t *ciphertext_size);
+
+/**
+ * Decrypt Function into a caller buffer
+ *
+ * @param key the key context (edes_key)
+ * @param ciphertext the ciphertext (uint8_t array)
+ * @param ciphertext_size the ciphertext size, non-zero multiple of EDES_BLOCK_SIZE (size_t)
+ * @param plaintext the plaintext buffer, must not overlap the ciphertext (uint8_t array)
+ * @param plaintext_capacity the plaintext buffer size, the ciphertext size is always enough (size_t)
+ * @param plaintext_size pointer to the plaintext size (size_t)
+ *
+ * @return EDES_OK, EDES_ERROR_INVALID_ARGUMENT, EDES_ERROR_INVALID_SIZE or EDES_ERROR_BUFFER_TOO_SMALL
+ */
+EDES_API int edes_key_decrypt(const edes_key *key, const uint8_t *ciphertext, size_t ciphertext_size, uint8_t *plaintext, size_t plaintext_capacity, size_t *plaintext_size);
+
+/**
+ * Encrypt Function in place, the padding is written after the plaintext
+ *
+ * @param key the key context (edes_key)
+ * @param buffer the buffer, holds the plaintext and receives the ciphertext (uint8_t array)
+ * @param length the plaintext length (size_t)
+ * @param capacity the buffer size, at least edes_ciphertext_size(length) (size_t)
+ * @param ciphertext_size pointer to the ciphertext size (size_t)
+ *
+ * @return EDES_OK, EDES_ERROR_INVALID_ARGUMENT or EDES_ERROR_BUFFER_TOO_SMALL
+ */
+EDES_API int edes_key_encrypt_in_place(const edes_key *key, uint8_t *buffer, size_t length, size_t capacity, size_t *ciphertext_size);
+
+/**
+ * Decrypt Function in place, the plaintext is left at the start of the buffer
+ *
+ * @param key the key context (edes_key)
+ * @param buffer the buffer, holds the ciphertext and receives the plaintext (uint8_t array)
+ * @param length the ciphertext length, non-zero multiple of EDES_BLOCK_SIZE (size_t)
+ * @param plaintext_size pointer to the plaintext size (size_t)
+ *
+ * @return EDES_OK, EDES_ERROR_INVALID_ARGUMENT or EDES_ERROR_INVALID_SIZE
+ */
+EDES_API int edes_key_decrypt_in_place(const edes_key *key, uint8_t *buffer, size_t length, size_t *plaintext_size);
+
+/**
+ * Struct that represents one independent stream of edes_cbc_encrypt_batch
+ *
+ * @param buffer the buffer, holds the plaintext and receives the ciphertext, the padding is written after the plaintext (uint8_t array)
+ * @param length the plaintext length (size_t)
+ * @param capacity the buffer size, at least edes_ciphertext_size(length) (size_t)
+ * @param iv the IV of the stream, EDES_BLOCK_SIZE bytes (uint8_t array)
+ * @param ciphertext_size the ciphertext size, set by edes_cbc_encrypt_batch (size_t)
+ */
+typedef struct edes_cbc_stream
+{
+    uint8_t *buffer;
+    size_t length;
+    size_t capacity;
+    const uint8_t *iv;
+    size_t ciphertext_size;
+} edes_cbc_stream;
+
+/**
+ * CBC Encrypt Function for many independent streams in place, on the calling thread
+ *
+ * The block i of every stream is ciphered by the same call to the block kernel, so the SIMD kernels are filled even though each stream is serial. The ciphertext of a stream is the same as the one of the e-des-cbc mode without its IV header.
+ * Every stream is checked before any buffer is touched, so on error the buffers are left as they were.
+ *
+ * @param key the key context (edes_key)
+ * @param streams the streams (edes_cbc_stream array)
+ * @param number_of_streams the number of streams (size_t)
+ *
+ * @return EDES_OK, EDES_ERROR_INVALID_ARGUMENT or EDES_ERROR_BUFFER_TOO_SMALL
+ */
+EDES_API int edes_cbc_encrypt_batch(const edes_key *key, edes_cbc_stream *streams, size_t number_of_streams);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
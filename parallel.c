@@ -0,0 +1,211 @@
+#include "parallel.h"
+
+/**
+ * Struct that represents the arguments of a parallel_cipher_blocks job
+ *
+ * @param parallel_cipher the thread pool, block function and key (struct parallel_cipher)
+ * @param blocks the blocks (uint8_t array)
+ * @param number_of_bytes the number of bytes to process (size_t)
+ */
+struct parallel_cipher_job
+{
+    const struct parallel_cipher *parallel_cipher;
+    uint8_t *blocks;
+    size_t number_of_bytes;
+};
+
+/**
+ * Function that takes and runs the tasks of the current job until there are none left, it must be called with the mutex locked
+ *
+ * @param pool the thread pool (struct thread_pool)
+ */
+static void run_pending_tasks(struct thread_pool *pool)
+{
+    while (pool->next_task < pool->number_of_tasks)
+    {
+        size_t task_index = pool->next_task++;
+        thread_pool_task task = pool->task;
+        void *argument = pool->argument;
+
+        pthread_mutex_unlock(&pool->mutex);
+        task(argument, task_index);
+        pthread_mutex_lock(&pool->mutex);
+
+        pool->finished_tasks++;
+        if (pool->finished_tasks == pool->number_of_tasks)
+        {
+            pthread_cond_broadcast(&pool->work_done);
+        }
+    }
+}
+
+/**
+ * Function run by the worker threads, it waits for new jobs and works on them until the pool is destroyed
+ *
+ * @param argument the thread pool (struct thread_pool)
+ *
+ * @return NULL
+ */
+static void *worker_thread(void *argument)
+{
+    struct thread_pool *pool = (struct thread_pool *)argument;
+    unsigned long last_generation = 0;
+
+    pthread_mutex_lock(&pool->mutex);
+    for (;;)
+    {
+        while (!pool->shutdown && pool->generation == last_generation)
+        {
+            pthread_cond_wait(&pool->work_available, &pool->mutex);
+        }
+
+        if (pool->shutdown)
+        {
+            break;
+        }
+
+        last_generation = pool->generation;
+        run_pending_tasks(pool);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+
+    return NULL;
+}
+
+size_t get_number_of_cores(void)
+{
+    long number_of_cores = sysconf(_SC_NPROCESSORS_ONLN);
+
+    return number_of_cores > 0 ? (size_t)number_of_cores : 1;
+}
+
+struct thread_pool *thread_pool_create(size_t number_of_threads)
+{
+    if (number_of_threads == 0)
+    {
+        number_of_threads = get_number_of_cores();
+    }
+
+    struct thread_pool *pool = (struct thread_pool *)calloc(1, sizeof(struct thread_pool));
+
+    if (pool == NULL) // memory allocation error
+    {
+        fprintf(stderr, "Error allocating memory for thread pool\n");
+        exit(1);
+    }
+
+    pool->number_of_threads = number_of_threads;
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->work_available, NULL);
+    pthread_cond_init(&pool->work_done, NULL);
+
+    // The calling thread is the first worker, only the others are created
+    pool->threads = (pthread_t *)malloc(sizeof(pthread_t) * number_of_threads);
+
+    if (pool->threads == NULL) // memory allocation error
+    {
+        fprintf(stderr, "Error allocating memory for threads\n");
+        exit(1);
+    }
+
+    for (size_t thread_index = 1; thread_index < number_of_threads; thread_index++)
+    {
+        if (pthread_create(&pool->threads[thread_index], NULL, worker_thread, pool) != 0)
+        {
+            fprintf(stderr, "Error creating worker thread\n");
+            exit(1);
+        }
+    }
+
+    return pool;
+}
+
+void thread_pool_run(struct thread_pool *pool, thread_pool_task task, void *argument, size_t number_of_tasks)
+{
+    if (number_of_tasks == 0)
+    {
+        return;
+    }
+
+    // Nothing to share, run the tasks on the calling thread
+    if (pool->number_of_threads == 1 || number_of_tasks == 1)
+    {
+        for (size_t task_index = 0; task_index < number_of_tasks; task_index++)
+        {
+            task(argument, task_index);
+        }
+        return;
+    }
+
+    pthread_mutex_lock(&pool->mutex);
+
+    pool->task = task;
+    pool->argument = argument;
+    pool->number_of_tasks = number_of_tasks;
+    pool->next_task = 0;
+    pool->finished_tasks = 0;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->work_available);
+
+    run_pending_tasks(pool);
+
+    while (pool->finished_tasks < pool->number_of_tasks)
+    {
+        pthread_cond_wait(&pool->work_done, &pool->mutex);
+    }
+
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+void thread_pool_destroy(struct thread_pool *pool)
+{
+    pthread_mutex_lock(&pool->mutex);
+    pool->shutdown = 1;
+    pthread_cond_broadcast(&pool->work_available);
+    pthread_mutex_unlock(&pool->mutex);
+
+    for (size_t thread_index = 1; thread_index < pool->number_of_threads; thread_index++)
+    {
+        pthread_join(pool->threads[thread_index], NULL);
+    }
+
+    pthread_mutex_destroy(&pool->mutex);
+    pthread_cond_destroy(&pool->work_available);
+    pthread_cond_destroy(&pool->work_done);
+
+    free(pool->threads);
+    free(pool);
+}
+
+/**
+ * Task of a parallel_cipher_blocks job, it processes one chunk of PARALLEL_CHUNK_SIZE bytes
+ *
+ * @param argument the job (struct parallel_cipher_job)
+ * @param task_index the index of the chunk (size_t)
+ */
+static void cipher_chunk(void *argument, size_t task_index)
+{
+    struct parallel_cipher_job *job = (struct parallel_cipher_job *)argument;
+
+    size_t chunk_start = task_index * PARALLEL_CHUNK_SIZE;
+    size_t chunk_size = job->number_of_bytes - chunk_start;
+
+    if (chunk_size > PARALLEL_CHUNK_SIZE)
+    {
+        chunk_size = PARALLEL_CHUNK_SIZE;
+    }
+
+    job->parallel_cipher->function(job->blocks + chunk_start, chunk_size, job->parallel_cipher->key);
+}
+
+void parallel_cipher_blocks(uint8_t *blocks, size_t number_of_bytes, const void *parallel_cipher)
+{
+    struct parallel_cipher_job job;
+    job.parallel_cipher = (const struct parallel_cipher *)parallel_cipher;
+    job.blocks = blocks;
+    job.number_of_bytes = number_of_bytes;
+
+    size_t number_of_chunks = (number_of_bytes + PARALLEL_CHUNK_SIZE - 1) / PARALLEL_CHUNK_SIZE;
+
+    thread_pool_run(job.parallel_cipher->pool, cipher_chunk, &job, number_of_chunks);
+}
@@ -0,0 +1,119 @@
+#ifndef __PARALLEL_H__
+#define __PARALLEL_H__
+
+/**
+ * @file parallel.h
+ * @brief Thread pool and parallel ECB engine
+ *
+ * This file contains a small thread pool and the parallel engine that spreads the independent ECB blocks across all the cores.
+ * The workers only read the key material (sboxes or key schedule), so a single copy of it is shared by all of them.
+ *
+ * @author Ana Vidal (118408)
+ * @author Simão Andrade (118345)
+ * @date 2023-10-20
+ */
+
+#include "implementation.h"
+#include <pthread.h>
+
+// Constants for the parallel engine
+#define PARALLEL_CHUNK_SIZE (32 * 1024) // 32KiB, fits in the L1/L2 cache of a core together with the sboxes
+#define MAX_THREADS_PER_CORE 4 // upper bound of -j, the stream buffers grow with the number of threads
+
+/**
+ * Function pointer type for the tasks run by the thread pool, it receives the shared argument and the index of the task
+ *
+ * @param argument the argument shared by all the tasks
+ * @param task_index the index of the task (size_t)
+ */
+typedef void (*thread_pool_task)(void *argument, size_t task_index);
+
+/**
+ * Struct that represents a thread pool, the thread that calls thread_pool_run also works on the tasks
+ *
+ * @param threads the worker threads (pthread_t array)
+ * @param number_of_threads the number of threads, including the calling thread (size_t)
+ * @param mutex the mutex that protects the state of the pool (pthread_mutex_t)
+ * @param work_available condition signaled when a new job is posted or the pool is destroyed (pthread_cond_t)
+ * @param work_done condition signaled when the last task of the job finishes (pthread_cond_t)
+ * @param task the task of the current job (thread_pool_task)
+ * @param argument the argument of the current job
+ * @param number_of_tasks the number of tasks of the current job (size_t)
+ * @param next_task the index of the next task to be taken (size_t)
+ * @param finished_tasks the number of finished tasks of the current job (size_t)
+ * @param generation the number of the current job, so workers never run a job twice (unsigned long)
+ * @param shutdown set when the pool is being destroyed (int)
+ */
+struct thread_pool
+{
+    pthread_t *threads;
+    size_t number_of_threads;
+    pthread_mutex_t mutex;
+    pthread_cond_t work_available;
+    pthread_cond_t work_done;
+    thread_pool_task task;
+    void *argument;
+    size_t number_of_tasks;
+    size_t next_task;
+    size_t finished_tasks;
+    unsigned long generation;
+    int shutdown;
+};
+
+/**
+ * Struct that represents a block cipher function run by the thread pool, it is given as key to parallel_cipher_blocks
+ *
+ * @param pool the thread pool (struct thread_pool)
+ * @param function the function that ciphers/deciphers whole blocks (block_cipher_function)
+ * @param key the key material given to the function
+ */
+struct parallel_cipher
+{
+    struct thread_pool *pool;
+    block_cipher_function function;
+    const void *key;
+};
+
+/**
+ * Function that returns the number of online cores
+ *
+ * @return the number of online cores, at least 1 (size_t)
+ */
+size_t get_number_of_cores(void);
+
+/**
+ * Function that creates a thread pool with the given number of threads (the calling thread counts as one of them)
+ *
+ * @param number_of_threads the number of threads, 0 uses all the cores (size_t)
+ *
+ * @return pointer to the thread pool (struct thread_pool)
+ */
+struct thread_pool *thread_pool_create(size_t number_of_threads);
+
+/**
+ * Function that runs a job on the thread pool and waits until all its tasks are finished
+ *
+ * @param pool the thread pool (struct thread_pool)
+ * @param task the task to run (thread_pool_task)
+ * @param argument the argument shared by all the tasks
+ * @param number_of_tasks the number of tasks (size_t)
+ */
+void thread_pool_run(struct thread_pool *pool, thread_pool_task task, void *argument, size_t number_of_tasks);
+
+/**
+ * Function that stops the worker threads and frees the thread pool
+ *
+ * @param pool the thread pool (struct thread_pool)
+ */
+void thread_pool_destroy(struct thread_pool *pool);
+
+/**
+ * Function that ciphers/deciphers the blocks in place, splitting them in chunks of PARALLEL_CHUNK_SIZE bytes across the thread pool, the output is byte-identical to the serial function
+ *
+ * @param blocks the blocks (uint8_t array)
+ * @param number_of_bytes the number of bytes to process, multiple of BLOCK_SIZE (size_t)
+ * @param parallel_cipher the thread pool, block function and key to use (struct parallel_cipher)
+ */
+void parallel_cipher_blocks(uint8_t *blocks, size_t number_of_bytes, const void *parallel_cipher);
+
+#endif
@@ -0,0 +1,309 @@
+#include "sbox_cache.h"
+
+/**
+ * Function that wipes a memory region, the volatile pointer keeps the compiler from dropping the writes
+ *
+ * @param memory the memory region
+ * @param size the size of the region (size_t)
+ */
+static void wipe(void *memory, size_t size)
+{
+    volatile uint8_t *bytes = (volatile uint8_t *)memory;
+
+    for (size_t index = 0; index < size; index++)
+    {
+        bytes[index] = 0;
+    }
+}
+
+/**
+ * Function that returns the hash bucket of a digest
+ *
+ * @param cache the cache (struct sbox_cache)
+ * @param digest the SHA256 digest (uint8_t array)
+ *
+ * @return pointer to the head of the bucket (struct sbox_cache_entry pointer)
+ */
+static struct sbox_cache_entry **get_bucket(struct sbox_cache *cache, const uint8_t *digest)
+{
+    // The digest is already uniformly distributed, its first bytes are used as the hash
+    size_t hash = 0;
+    memcpy(&hash, digest, sizeof(size_t));
+
+    return &cache->buckets[hash & (cache->number_of_buckets - 1)];
+}
+
+/**
+ * Function that finds the cached entry of a digest, it must be called with the mutex locked
+ *
+ * @param cache the cache (struct sbox_cache)
+ * @param digest the SHA256 digest (uint8_t array)
+ *
+ * @return pointer to the entry, NULL if the digest is not cached (struct sbox_cache_entry)
+ */
+static struct sbox_cache_entry *find_entry(struct sbox_cache *cache, const uint8_t *digest)
+{
+    for (struct sbox_cache_entry *entry = *get_bucket(cache, digest); entry != NULL; entry = entry->hash_next)
+    {
+        if (memcmp(entry->digest, digest, SHA256_DIGEST_LENGTH) == 0)
+        {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Function that removes an entry from the LRU list
+ *
+ * @param cache the cache (struct sbox_cache)
+ * @param entry the entry (struct sbox_cache_entry)
+ */
+static void lru_unlink(struct sbox_cache *cache, struct sbox_cache_entry *entry)
+{
+    if (entry->lru_previous != NULL)
+    {
+        entry->lru_previous->lru_next = entry->lru_next;
+    }
+    else
+    {
+        cache->lru_head = entry->lru_next;
+    }
+
+    if (entry->lru_next != NULL)
+    {
+        entry->lru_next->lru_previous = entry->lru_previous;
+    }
+    else
+    {
+        cache->lru_tail = entry->lru_previous;
+    }
+
+    entry->lru_previous = NULL;
+    entry->lru_next = NULL;
+}
+
+/**
+ * Function that puts an entry at the head (most recently used) of the LRU list
+ *
+ * @param cache the cache (struct sbox_cache)
+ * @param entry the entry, not in the list (struct sbox_cache_entry)
+ */
+static void lru_push_head(struct sbox_cache *cache, struct sbox_cache_entry *entry)
+{
+    entry->lru_previous = NULL;
+    entry->lru_next = cache->lru_head;
+
+    if (cache->lru_head != NULL)
+    {
+        cache->lru_head->lru_previous = entry;
+    }
+    else
+    {
+        cache->lru_tail = entry;
+    }
+
+    cache->lru_head = entry;
+}
+
+/**
+ * Function that takes an entry for a new digest, an unused one or the least recently used entry without users (which is wiped), it must be called with the mutex locked
+ *
+ * @param cache the cache (struct sbox_cache)
+ *
+ * @return pointer to the entry, NULL if all the entries are in use (struct sbox_cache_entry)
+ */
+static struct sbox_cache_entry *take_entry(struct sbox_cache *cache)
+{
+    if (cache->free_entries != NULL)
+    {
+        struct sbox_cache_entry *entry = cache->free_entries;
+        cache->free_entries = entry->hash_next;
+        cache->stats.size++;
+        return entry;
+    }
+
+    for (struct sbox_cache_entry *entry = cache->lru_tail; entry != NULL; entry = entry->lru_previous)
+    {
+        if (entry->references > 0)
+        {
+            continue;
+        }
+
+        // Unlink the victim from its bucket and from the LRU list
+        struct sbox_cache_entry **link = get_bucket(cache, entry->digest);
+        while (*link != entry)
+        {
+            link = &(*link)->hash_next;
+        }
+        *link = entry->hash_next;
+
+        lru_unlink(cache, entry);
+        wipe(entry->digest, SHA256_DIGEST_LENGTH);
+        edes_ctx_clear(&entry->ctx);
+
+        cache->stats.evictions++;
+        return entry;
+    }
+
+    return NULL;
+}
+
+struct sbox_cache *sbox_cache_create(size_t capacity)
+{
+    if (capacity == 0)
+    {
+        capacity = 1;
+    }
+
+    struct sbox_cache *cache = (struct sbox_cache *)calloc(1, sizeof(struct sbox_cache));
+
+    if (cache == NULL) // memory allocation error
+    {
+        fprintf(stderr, "Error allocating memory for sbox cache\n");
+        exit(1);
+    }
+
+    cache->number_of_buckets = 1;
+    while (cache->number_of_buckets < capacity)
+    {
+        cache->number_of_buckets *= 2;
+    }
+
+    cache->entries = (struct sbox_cache_entry *)calloc(capacity, sizeof(struct sbox_cache_entry));
+    cache->buckets = (struct sbox_cache_entry **)calloc(cache->number_of_buckets, sizeof(struct sbox_cache_entry *));
+
+    if (cache->entries == NULL || cache->buckets == NULL) // memory allocation error
+    {
+        fprintf(stderr, "Error allocating memory for sbox cache entries\n");
+        exit(1);
+    }
+
+    for (size_t entry_index = 0; entry_index < capacity; entry_index++)
+    {
+        cache->entries[entry_index].is_cached = 1;
+        cache->entries[entry_index].hash_next = entry_index + 1 < capacity ? &cache->entries[entry_index + 1] : NULL;
+    }
+
+    cache->free_entries = &cache->entries[0];
+    cache->stats.capacity = capacity;
+    pthread_mutex_init(&cache->mutex, NULL);
+
+    return cache;
+}
+
+const struct edes_ctx *sbox_cache_acquire(struct sbox_cache *cache, const uint8_t *password)
+{
+    uint8_t digest[SHA256_DIGEST_LENGTH];
+    SHA256(password, strlen((const char *)password), digest);
+
+    pthread_mutex_lock(&cache->mutex);
+
+    struct sbox_cache_entry *entry = find_entry(cache, digest);
+
+    if (entry != NULL)
+    {
+        cache->stats.hits++;
+        entry->references++;
+        lru_unlink(cache, entry);
+        lru_push_head(cache, entry);
+
+        pthread_mutex_unlock(&cache->mutex);
+        wipe(digest, SHA256_DIGEST_LENGTH);
+        return &entry->ctx;
+    }
+
+    cache->stats.misses++;
+    pthread_mutex_unlock(&cache->mutex);
+
+    // The sboxes are derived without the lock, so the other tenants are not blocked
+    struct edes_ctx ctx;
+    edes_ctx_init(&ctx, password);
+
+    pthread_mutex_lock(&cache->mutex);
+
+    // Another thread may have added the same password in the meantime
+    entry = find_entry(cache, digest);
+
+    if (entry == NULL)
+    {
+        entry = take_entry(cache);
+
+        if (entry != NULL)
+        {
+            memcpy(entry->digest, digest, SHA256_DIGEST_LENGTH);
+            memcpy(&entry->ctx, &ctx, sizeof(struct edes_ctx));
+
+            struct sbox_cache_entry **bucket = get_bucket(cache, digest);
+            entry->hash_next = *bucket;
+            *bucket = entry;
+        }
+    }
+    else
+    {
+        lru_unlink(cache, entry);
+    }
+
+    if (entry != NULL)
+    {
+        entry->references++;
+        lru_push_head(cache, entry);
+    }
+
+    pthread_mutex_unlock(&cache->mutex);
+
+    if (entry == NULL)
+    {
+        // All the entries are in use, the context is given out without being cached
+        entry = (struct sbox_cache_entry *)calloc(1, sizeof(struct sbox_cache_entry));
+
+        if (entry == NULL) // memory allocation error
+        {
+            fprintf(stderr, "Error allocating memory for sbox cache entry\n");
+            exit(1);
+        }
+
+        memcpy(&entry->ctx, &ctx, sizeof(struct edes_ctx));
+        entry->references = 1;
+        entry->is_cached = 0;
+    }
+
+    edes_ctx_clear(&ctx);
+    wipe(digest, SHA256_DIGEST_LENGTH);
+
+    return &entry->ctx;
+}
+
+void sbox_cache_release(struct sbox_cache *cache, const struct edes_ctx *ctx)
+{
+    struct sbox_cache_entry *entry = (struct sbox_cache_entry *)((uint8_t *)ctx - offsetof(struct sbox_cache_entry, ctx));
+
+    if (!entry->is_cached)
+    {
+        edes_ctx_clear(&entry->ctx);
+        free(entry);
+        return;
+    }
+
+    pthread_mutex_lock(&cache->mutex);
+    entry->references--;
+    pthread_mutex_unlock(&cache->mutex);
+}
+
+void sbox_cache_get_stats(struct sbox_cache *cache, struct sbox_cache_stats *stats)
+{
+    pthread_mutex_lock(&cache->mutex);
+    *stats = cache->stats;
+    pthread_mutex_unlock(&cache->mutex);
+}
+
+void sbox_cache_destroy(struct sbox_cache *cache)
+{
+    wipe(cache->entries, cache->stats.capacity * sizeof(struct sbox_cache_entry));
+    pthread_mutex_destroy(&cache->mutex);
+
+    free(cache->entries);
+    free(cache->buckets);
+    free(cache);
+}
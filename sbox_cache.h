@@ -0,0 +1,125 @@
+#ifndef __SBOX_CACHE_H__
+#define __SBOX_CACHE_H__
+
+/**
+ * @file sbox_cache.h
+ * @brief Bounded LRU cache of derived sboxes
+ *
+ * This file contains a thread-safe cache of key contexts (the 16 sboxes derived from a password) for workloads where many passwords are used interleaved.
+ * The entries are looked up by the SHA256 digest of the password, so the passwords themselves are never stored, and the evicted entries are wiped.
+ *
+ * @author Ana Vidal (118408)
+ * @author Simão Andrade (118345)
+ * @date 2023-10-20
+ */
+
+#include "implementation.h"
+#include <pthread.h>
+
+/**
+ * Struct that represents an entry of the cache
+ *
+ * @param digest the SHA256 digest of the password (uint8_t array)
+ * @param ctx the key context derived from the password (struct edes_ctx)
+ * @param references the number of users of the entry, only entries without users can be evicted (size_t)
+ * @param is_cached 0 for the entries given out when the cache is full of entries in use, they are freed on release (int)
+ * @param hash_next the next entry of the same hash bucket (struct sbox_cache_entry)
+ * @param lru_previous the previous (more recently used) entry of the LRU list (struct sbox_cache_entry)
+ * @param lru_next the next (less recently used) entry of the LRU list (struct sbox_cache_entry)
+ */
+struct sbox_cache_entry
+{
+    uint8_t digest[SHA256_DIGEST_LENGTH];
+    struct edes_ctx ctx;
+    size_t references;
+    int is_cached;
+    struct sbox_cache_entry *hash_next;
+    struct sbox_cache_entry *lru_previous;
+    struct sbox_cache_entry *lru_next;
+};
+
+/**
+ * Struct that represents the counters of the cache
+ *
+ * @param hits the number of lookups found in the cache (size_t)
+ * @param misses the number of lookups that derived the sboxes (size_t)
+ * @param evictions the number of entries evicted (and wiped) to make room (size_t)
+ * @param size the number of entries in the cache (size_t)
+ * @param capacity the maximum number of entries (size_t)
+ */
+struct sbox_cache_stats
+{
+    size_t hits;
+    size_t misses;
+    size_t evictions;
+    size_t size;
+    size_t capacity;
+};
+
+/**
+ * Struct that represents the cache
+ *
+ * @param mutex the mutex that protects the cache (pthread_mutex_t)
+ * @param entries the entries (struct sbox_cache_entry array)
+ * @param free_entries the list of unused entries, linked by hash_next (struct sbox_cache_entry)
+ * @param buckets the hash buckets (struct sbox_cache_entry pointer array)
+ * @param number_of_buckets the number of hash buckets, power of two (size_t)
+ * @param lru_head the most recently used entry (struct sbox_cache_entry)
+ * @param lru_tail the least recently used entry (struct sbox_cache_entry)
+ * @param stats the counters (struct sbox_cache_stats)
+ */
+struct sbox_cache
+{
+    pthread_mutex_t mutex;
+    struct sbox_cache_entry *entries;
+    struct sbox_cache_entry *free_entries;
+    struct sbox_cache_entry **buckets;
+    size_t number_of_buckets;
+    struct sbox_cache_entry *lru_head;
+    struct sbox_cache_entry *lru_tail;
+    struct sbox_cache_stats stats;
+};
+
+/**
+ * Function that creates a cache with room for the given number of key contexts
+ *
+ * @param capacity the maximum number of entries (size_t)
+ *
+ * @return pointer to the cache (struct sbox_cache)
+ */
+struct sbox_cache *sbox_cache_create(size_t capacity);
+
+/**
+ * Function that returns the key context of the password, derived only if it is not in the cache, the context must be given back with sbox_cache_release
+ *
+ * @param cache the cache (struct sbox_cache)
+ * @param password the password (uint8_t array)
+ *
+ * @return pointer to the key context, read-only and valid until released (struct edes_ctx)
+ */
+const struct edes_ctx *sbox_cache_acquire(struct sbox_cache *cache, const uint8_t *password);
+
+/**
+ * Function that gives back a key context returned by sbox_cache_acquire
+ *
+ * @param cache the cache (struct sbox_cache)
+ * @param ctx the key context (struct edes_ctx)
+ */
+void sbox_cache_release(struct sbox_cache *cache, const struct edes_ctx *ctx);
+
+/**
+ * Function that copies the counters of the cache
+ *
+ * @param cache the cache (struct sbox_cache)
+ * @param stats pointer to the counters (struct sbox_cache_stats)
+ */
+void sbox_cache_get_stats(struct sbox_cache *cache, struct sbox_cache_stats *stats);
+
+/**
+ * Function that wipes all the entries and frees the cache, no context may be in use
+ *
+ * @param cache the cache (struct sbox_cache)
+ */
+void sbox_cache_destroy(struct sbox_cache *cache);
+
+#endif
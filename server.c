@@ -0,0 +1,502 @@
+#include "server.h"
+#include <errno.h>
+
+/**
+ * Struct that represents the state shared by the worker threads
+ *
+ * @param listening_socket the listening socket (int)
+ * @param cache the cache of sboxes (struct sbox_cache)
+ */
+struct server
+{
+    int listening_socket;
+    struct sbox_cache *cache;
+};
+
+/**
+ * Function that stores a little-endian 32-bit number
+ *
+ * @param bytes the 4 bytes (uint8_t array)
+ * @param value the number (uint32_t)
+ */
+static void store_little_endian_32(uint8_t *bytes, uint32_t value)
+{
+    for (int byte = 0; byte < 4; byte++)
+    {
+        bytes[byte] = (uint8_t)(value >> (8 * byte));
+    }
+}
+
+/**
+ * Function that loads a little-endian 32-bit number
+ *
+ * @param bytes the 4 bytes (uint8_t array)
+ *
+ * @return the number (uint32_t)
+ */
+static uint32_t load_little_endian_32(const uint8_t *bytes)
+{
+    return (uint32_t)bytes[0] | (uint32_t)bytes[1] << 8 | (uint32_t)bytes[2] << 16 | (uint32_t)bytes[3] << 24;
+}
+
+/**
+ * Function that receives exactly size bytes from a socket, retrying the short reads
+ *
+ * @param socket_descriptor the socket (int)
+ * @param bytes the bytes (uint8_t array)
+ * @param size the number of bytes (size_t)
+ *
+ * @return 1 if all the bytes were received, 0 if the connection was closed before the first byte, -1 on error or if it was closed in the middle
+ */
+static int receive_exactly(int socket_descriptor, uint8_t *bytes, size_t size)
+{
+    size_t done = 0;
+
+    while (done < size)
+    {
+        ssize_t number_of_received_bytes = recv(socket_descriptor, bytes + done, size - done, 0);
+
+        if (number_of_received_bytes < 0 && errno == EINTR)
+        {
+            continue;
+        }
+
+        if (number_of_received_bytes <= 0)
+        {
+            return number_of_received_bytes == 0 && done == 0 ? 0 : -1;
+        }
+
+        done += (size_t)number_of_received_bytes;
+    }
+
+    return 1;
+}
+
+/**
+ * Function that sends exactly size bytes to a socket, retrying the short writes (a closed peer does not raise SIGPIPE)
+ *
+ * @param socket_descriptor the socket (int)
+ * @param bytes the bytes (uint8_t array)
+ * @param size the number of bytes (size_t)
+ *
+ * @return 0 on success, -1 on error
+ */
+static int send_exactly(int socket_descriptor, const uint8_t *bytes, size_t size)
+{
+    size_t done = 0;
+
+    while (done < size)
+    {
+        ssize_t number_of_sent_bytes = send(socket_descriptor, bytes + done, size - done, MSG_NOSIGNAL);
+
+        if (number_of_sent_bytes < 0 && errno == EINTR)
+        {
+            continue;
+        }
+
+        if (number_of_sent_bytes <= 0)
+        {
+            return -1;
+        }
+
+        done += (size_t)number_of_sent_bytes;
+    }
+
+    return 0;
+}
+
+int server_process_request(struct sbox_cache *cache, int mode, int operation, int flags, const uint8_t *password, uint8_t *buffer, size_t *size)
+{
+    int is_final = (flags & SERVER_FLAG_FINAL) != 0;
+
+    if ((mode != SERVER_MODE_E_DES && mode != SERVER_MODE_DES_ECB) || (operation != SERVER_OPERATION_ENCRYPT && operation != SERVER_OPERATION_DECRYPT))
+    {
+        return EDES_ERROR_INVALID_ARGUMENT;
+    }
+
+    // Only the final request of an encrypt stream may hold a partial block, only the final request of a decrypt stream has padding to remove
+    if ((operation == SERVER_OPERATION_ENCRYPT && !is_final && *size % BLOCK_SIZE != 0) || (operation == SERVER_OPERATION_DECRYPT && (*size % BLOCK_SIZE != 0 || (is_final && *size == 0))))
+    {
+        return EDES_ERROR_INVALID_SIZE;
+    }
+
+    if (operation == SERVER_OPERATION_ENCRYPT && is_final)
+    {
+        *size = apply_padding(buffer, *size);
+    }
+
+    if (mode == SERVER_MODE_E_DES)
+    {
+        // The sboxes of the recent passwords stay resident, only new passwords are derived
+        const struct edes_ctx *ctx = sbox_cache_acquire(cache, password);
+
+        if (operation == SERVER_OPERATION_ENCRYPT)
+        {
+            e_des_encrypt_blocks(buffer, *size, ctx->sboxes);
+        }
+        else
+        {
+            e_des_decrypt_blocks(buffer, *size, ctx->sboxes);
+        }
+
+        sbox_cache_release(cache, ctx);
+    }
+    else
+    {
+        struct des_key key;
+        int status = generate_des_key(password, &key);
+
+        if (status == EDES_OK)
+        {
+            status = des_ecb_process_blocks(buffer, *size, &key, operation == SERVER_OPERATION_ENCRYPT);
+        }
+
+        des_key_clear(&key);
+
+        // A failed request is answered with its status, the worker keeps serving
+        if (status != EDES_OK)
+        {
+            return status;
+        }
+    }
+
+    if (operation == SERVER_OPERATION_DECRYPT && is_final)
+    {
+        *size -= get_padding_size(buffer, *size);
+    }
+
+    return EDES_OK;
+}
+
+/**
+ * Function that sends a response, the status and the payload
+ *
+ * @param socket_descriptor the socket (int)
+ * @param status the status (int)
+ * @param payload the payload (uint8_t array)
+ * @param size the payload size (size_t)
+ *
+ * @return 0 on success, -1 on error
+ */
+static int send_response(int socket_descriptor, int status, const uint8_t *payload, size_t size)
+{
+    uint8_t header[SERVER_RESPONSE_HEADER_SIZE];
+
+    store_little_endian_32(header, (uint32_t)status);
+    store_little_endian_32(header + 4, (uint32_t)size);
+
+    if (send_exactly(socket_descriptor, header, SERVER_RESPONSE_HEADER_SIZE) != 0)
+    {
+        return -1;
+    }
+
+    return send_exactly(socket_descriptor, payload, size);
+}
+
+/**
+ * Function that serves the requests of one connection until the client closes it or sends a malformed request
+ *
+ * @param server the server (struct server)
+ * @param connection the connected socket (int)
+ * @param buffer pointer to the payload buffer of the worker, grown when needed (uint8_t array)
+ * @param capacity pointer to the size of the payload buffer (size_t)
+ */
+static void serve_connection(struct server *server, int connection, uint8_t **buffer, size_t *capacity)
+{
+    uint8_t password[SERVER_MAX_PASSWORD_SIZE + 1];
+
+    for (;;)
+    {
+        uint8_t header[SERVER_REQUEST_HEADER_SIZE];
+
+        if (receive_exactly(connection, header, SERVER_REQUEST_HEADER_SIZE) != 1)
+        {
+            break;
+        }
+
+        int mode = header[0];
+        int operation = header[1];
+        int flags = header[2];
+        size_t password_size = load_little_endian_32(header + 4);
+        size_t size = load_little_endian_32(header + 8);
+
+        // The rest of the connection can not be framed after a bad header
+        if (password_size == 0 || password_size > SERVER_MAX_PASSWORD_SIZE || size > SERVER_MAX_PAYLOAD_SIZE)
+        {
+            send_response(connection, EDES_ERROR_INVALID_ARGUMENT, NULL, 0);
+            break;
+        }
+
+        // Room for the padding of the final block
+        if (size + BLOCK_SIZE > *capacity)
+        {
+            uint8_t *grown_buffer = (uint8_t *)realloc(*buffer, size + BLOCK_SIZE);
+
+            if (grown_buffer == NULL) // memory allocation error
+            {
+                send_response(connection, EDES_ERROR_BUFFER_TOO_SMALL, NULL, 0);
+                break;
+            }
+
+            *buffer = grown_buffer;
+            *capacity = size + BLOCK_SIZE;
+        }
+
+        if (receive_exactly(connection, password, password_size) != 1 || receive_exactly(connection, *buffer, size) != 1)
+        {
+            break;
+        }
+
+        password[password_size] = '\0';
+
+        int status = memchr(password, '\0', password_size) != NULL ? EDES_ERROR_INVALID_ARGUMENT : server_process_request(server->cache, mode, operation, flags, password, *buffer, &size);
+
+        memset(password, 0, password_size);
+
+        if (send_response(connection, status, *buffer, status == EDES_OK ? size : 0) != 0)
+        {
+            break;
+        }
+    }
+}
+
+/**
+ * Function run by the worker threads, each one accepts a connection and serves it until it is closed
+ *
+ * @param argument the server (struct server)
+ *
+ * @return NULL
+ */
+static void *server_worker(void *argument)
+{
+    struct server *server = (struct server *)argument;
+    uint8_t *buffer = NULL;
+    size_t capacity = 0;
+
+    for (;;)
+    {
+        int connection = accept(server->listening_socket, NULL, NULL);
+
+        if (connection < 0)
+        {
+            if (errno == EINTR || errno == ECONNABORTED)
+            {
+                continue;
+            }
+
+            perror("Error accepting connection");
+            exit(1);
+        }
+
+        serve_connection(server, connection, &buffer, &capacity);
+        close(connection);
+    }
+
+    return NULL;
+}
+
+/**
+ * Function that fills the address of a Unix domain socket, exits if the path is too long
+ *
+ * @param address pointer to the address (struct sockaddr_un)
+ * @param socket_path the path of the socket (char array)
+ */
+static void fill_address(struct sockaddr_un *address, const char *socket_path)
+{
+    memset(address, 0, sizeof(struct sockaddr_un));
+    address->sun_family = AF_UNIX;
+
+    if (strlen(socket_path) >= sizeof(address->sun_path))
+    {
+        fprintf(stderr, "Error: the socket path %s is too long\n", socket_path);
+        exit(1);
+    }
+
+    strcpy(address->sun_path, socket_path);
+}
+
+void server_run(const char *socket_path, size_t number_of_workers)
+{
+    struct sockaddr_un address;
+    struct server server;
+
+    fill_address(&address, socket_path);
+
+    server.listening_socket = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if (server.listening_socket < 0)
+    {
+        perror("Error creating socket");
+        exit(1);
+    }
+
+    // Replace the socket file left by a previous server, anything else at the path is left alone
+    struct stat path_status;
+
+    if (lstat(socket_path, &path_status) == 0)
+    {
+        if (!S_ISSOCK(path_status.st_mode))
+        {
+            fprintf(stderr, "Error: %s exists and is not a socket\n", socket_path);
+            exit(1);
+        }
+
+        unlink(socket_path);
+    }
+    else if (errno != ENOENT)
+    {
+        perror("Error checking the socket path");
+        exit(1);
+    }
+
+    // Only the owner may connect
+    mode_t previous_mask = umask(0077);
+
+    if (bind(server.listening_socket, (struct sockaddr *)&address, sizeof(address)) != 0 || listen(server.listening_socket, SERVER_BACKLOG) != 0)
+    {
+        perror("Error listening on socket");
+        exit(1);
+    }
+
+    umask(previous_mask);
+
+    server.cache = sbox_cache_create(SERVER_CACHE_CAPACITY);
+
+    // The calling thread is the first worker, only the others are created
+    for (size_t worker = 1; worker < number_of_workers; worker++)
+    {
+        pthread_t thread;
+
+        if (pthread_create(&thread, NULL, server_worker, &server) != 0)
+        {
+            fprintf(stderr, "Error creating worker thread\n");
+            exit(1);
+        }
+
+        pthread_detach(thread);
+    }
+
+    server_worker(&server);
+}
+
+/**
+ * Function that sends one request and writes its response, the program exits on error
+ *
+ * @param connection the connected socket (int)
+ * @param output the output stream (FILE)
+ * @param header the request header, the payload length is filled here (uint8_t array)
+ * @param password the password (uint8_t array)
+ * @param password_size the password size (size_t)
+ * @param buffer the payload, receives the response (uint8_t array)
+ * @param size the payload size (size_t)
+ * @param capacity the size of the buffer (size_t)
+ */
+static void send_request(int connection, FILE *output, uint8_t *header, const uint8_t *password, size_t password_size, uint8_t *buffer, size_t size, size_t capacity)
+{
+    uint8_t response_header[SERVER_RESPONSE_HEADER_SIZE];
+
+    store_little_endian_32(header + 8, (uint32_t)size);
+
+    if (send_exactly(connection, header, SERVER_REQUEST_HEADER_SIZE) != 0 || send_exactly(connection, password, password_size) != 0 || send_exactly(connection, buffer, size) != 0 ||
+        receive_exactly(connection, response_header, SERVER_RESPONSE_HEADER_SIZE) != 1)
+    {
+        fprintf(stderr, "Error: the connection to the server was lost\n");
+        exit(1);
+    }
+
+    int status = (int32_t)load_little_endian_32(response_header);
+    size_t response_size = load_little_endian_32(response_header + 4);
+
+    if (status != EDES_OK)
+    {
+        fprintf(stderr, "Error: the server rejected the request (status %d)\n", status);
+        exit(1);
+    }
+
+    if (response_size > capacity || receive_exactly(connection, buffer, response_size) != 1)
+    {
+        fprintf(stderr, "Error: the connection to the server was lost\n");
+        exit(1);
+    }
+
+    if (fwrite(buffer, sizeof(uint8_t), response_size, output) != response_size)
+    {
+        fprintf(stderr, "Error writing the output stream\n");
+        exit(1);
+    }
+}
+
+void client_stream(const char *socket_path, FILE *input, FILE *output, int mode, int operation, const uint8_t *password, size_t buffer_size)
+{
+    struct sockaddr_un address;
+    size_t password_size = strlen((const char *)password);
+
+    if (password_size == 0 || password_size > SERVER_MAX_PASSWORD_SIZE || buffer_size > SERVER_MAX_PAYLOAD_SIZE)
+    {
+        fprintf(stderr, "Error: the password or the request size is not supported by the server\n");
+        exit(1);
+    }
+
+    fill_address(&address, socket_path);
+
+    int connection = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if (connection < 0 || connect(connection, (struct sockaddr *)&address, sizeof(address)) != 0)
+    {
+        fprintf(stderr, "Error connecting to the server at %s\n", socket_path);
+        exit(1);
+    }
+
+    // Extra block for the padding (encrypt) or the block held back from the previous chunk (decrypt)
+    size_t capacity = buffer_size + BLOCK_SIZE;
+    uint8_t *buffer = (uint8_t *)malloc(capacity);
+
+    if (buffer == NULL) // memory allocation error
+    {
+        fprintf(stderr, "Error allocating memory for stream buffer\n");
+        exit(1);
+    }
+
+    uint8_t header[SERVER_REQUEST_HEADER_SIZE] = {(uint8_t)mode, (uint8_t)operation, 0, 0};
+    store_little_endian_32(header + 4, (uint32_t)password_size);
+
+    size_t number_of_held_bytes = 0;
+    uint8_t held_block[BLOCK_SIZE];
+
+    for (;;)
+    {
+        memcpy(buffer, held_block, number_of_held_bytes);
+
+        size_t number_of_readed_bytes = fread(buffer + number_of_held_bytes, sizeof(uint8_t), buffer_size, input);
+
+        if (ferror(input))
+        {
+            fprintf(stderr, "Error reading the input stream\n");
+            exit(1);
+        }
+
+        size_t number_of_bytes = number_of_held_bytes + number_of_readed_bytes;
+
+        if (number_of_readed_bytes < buffer_size) // final chunk, the server adds or removes the padding
+        {
+            // An empty ciphertext deciphers to nothing, like the local stream
+            if (operation == SERVER_OPERATION_DECRYPT && number_of_bytes == 0)
+            {
+                break;
+            }
+
+            header[2] = SERVER_FLAG_FINAL;
+            send_request(connection, output, header, password, password_size, buffer, number_of_bytes, capacity);
+            break;
+        }
+
+        // When deciphering hold back the last block, it may be the one with the padding
+        number_of_held_bytes = operation == SERVER_OPERATION_DECRYPT ? BLOCK_SIZE : 0;
+        memcpy(held_block, buffer + number_of_bytes - number_of_held_bytes, number_of_held_bytes);
+
+        send_request(connection, output, header, password, password_size, buffer, number_of_bytes - number_of_held_bytes, capacity);
+    }
+
+    free(buffer);
+    close(connection);
+}
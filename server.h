@@ -0,0 +1,76 @@
+#ifndef __SERVER_H__
+#define __SERVER_H__
+
+/**
+ * @file server.h
+ * @brief Local encrypt/decrypt server over a Unix domain socket
+ *
+ * This file contains a long-running server that keeps the derived sboxes resident (sbox_cache) and serves framed encrypt/decrypt requests from a pool of worker threads,
+ * and the thin client used by the e-des binary to send stdin to the server and write the answer to stdout.
+ *
+ * Every request is a header (mode, operation, flags, password length and payload length, little-endian), the password and the payload.
+ * Every response is the status (EDES_OK or an EDES_ERROR_* code) and the payload length, then the payload. A connection may carry any number of requests.
+ * A stream is sent as a sequence of requests, only the one with SERVER_FLAG_FINAL has its padding added (encrypt) or removed (decrypt).
+ *
+ * @author Ana Vidal (118408)
+ * @author Simão Andrade (118345)
+ * @date 2023-10-20
+ */
+
+#include "implementation.h"
+#include "sbox_cache.h"
+#include <sys/socket.h>
+#include <sys/un.h>
+
+// Constants for the server
+#define SERVER_REQUEST_HEADER_SIZE 12
+#define SERVER_RESPONSE_HEADER_SIZE 8
+#define SERVER_MODE_E_DES 0
+#define SERVER_MODE_DES_ECB 1
+#define SERVER_OPERATION_ENCRYPT 0
+#define SERVER_OPERATION_DECRYPT 1
+#define SERVER_FLAG_FINAL 1 // the last request of a stream, it holds the padding
+#define SERVER_MAX_PASSWORD_SIZE 1024
+#define SERVER_MAX_PAYLOAD_SIZE (16 * 1024 * 1024) // 16MiB, bigger requests are rejected
+#define SERVER_CACHE_CAPACITY 64 // number of passwords whose sboxes stay resident
+#define SERVER_BACKLOG 128
+
+/**
+ * Function that serves requests on a Unix domain socket until the process is killed, a stale socket file at the path is replaced, any other file there is an error
+ *
+ * @param socket_path the path of the socket (char array)
+ * @param number_of_workers the number of worker threads, each one serves one connection at a time (size_t)
+ *
+ * A worker stays with its connection until the client closes it, so at most number_of_workers clients are served at once and the next ones wait in the backlog, even behind idle connections
+ */
+void server_run(const char *socket_path, size_t number_of_workers);
+
+/**
+ * Function that processes one request in place, the same operation the server does for each request
+ *
+ * @param cache the cache of sboxes (struct sbox_cache)
+ * @param mode SERVER_MODE_E_DES or SERVER_MODE_DES_ECB (int)
+ * @param operation SERVER_OPERATION_ENCRYPT or SERVER_OPERATION_DECRYPT (int)
+ * @param flags SERVER_FLAG_FINAL for the last request of a stream (int)
+ * @param password the password, NUL-terminated (uint8_t array)
+ * @param buffer the payload, with room for BLOCK_SIZE extra bytes (uint8_t array)
+ * @param size pointer to the payload size, updated with the response size (size_t)
+ *
+ * @return EDES_OK, EDES_ERROR_INVALID_SIZE, EDES_ERROR_INVALID_ARGUMENT, or EDES_ERROR_OUT_OF_MEMORY/EDES_ERROR_CRYPTO from des-ecb
+ */
+int server_process_request(struct sbox_cache *cache, int mode, int operation, int flags, const uint8_t *password, uint8_t *buffer, size_t *size);
+
+/**
+ * Client Stream Function, sends the input to the server in requests of buffer_size bytes and writes the responses, the program exits on error
+ *
+ * @param socket_path the path of the socket (char array)
+ * @param input the input stream (FILE)
+ * @param output the output stream (FILE)
+ * @param mode SERVER_MODE_E_DES or SERVER_MODE_DES_ECB (int)
+ * @param operation SERVER_OPERATION_ENCRYPT or SERVER_OPERATION_DECRYPT (int)
+ * @param password the password (uint8_t array)
+ * @param buffer_size the size of the requests, multiple of BLOCK_SIZE (size_t)
+ */
+void client_stream(const char *socket_path, FILE *input, FILE *output, int mode, int operation, const uint8_t *password, size_t buffer_size);
+
+#endif
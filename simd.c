@@ -0,0 +1,611 @@
+#include "simd.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <immintrin.h>
+
+#define AVX2_TARGET __attribute__((target("avx2")))
+#define AVX2_GROUPS (AVX2_BLOCKS_PER_BATCH / 8)
+
+int avx2_supported(void)
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+
+/**
+ * Function that does the feistel function on 8 half blocks at once, each 32-bit lane holds the 4 bytes of one half block (byte 0 in the low bits)
+ *
+ * The sbox bytes are read with 32-bit gathers and the unused upper bytes are dropped, the gathers of the last sbox read 3 bytes before the index instead of 3 bytes after it so they never leave the sboxes array
+ *
+ * @param input_block the 8 half blocks (__m256i)
+ * @param sboxes the sboxes (struct s_box array)
+ * @param sbox_index the index of the sbox of the round (int)
+ *
+ * @return the 8 output half blocks (__m256i)
+ */
+static inline AVX2_TARGET __m256i feistel_function_avx2(__m256i input_block, const struct s_box *sboxes, int sbox_index)
+{
+    const __m256i byte_mask = _mm256_set1_epi32(0xff);
+
+    // Cumulative indexes, the same as in feistel_function
+    __m256i index_0 = _mm256_srli_epi32(input_block, 24);
+    __m256i index_1 = _mm256_and_si256(_mm256_add_epi32(index_0, _mm256_srli_epi32(input_block, 16)), byte_mask);
+    __m256i index_2 = _mm256_and_si256(_mm256_add_epi32(index_1, _mm256_srli_epi32(input_block, 8)), byte_mask);
+    __m256i index_3 = _mm256_and_si256(_mm256_add_epi32(index_2, input_block), byte_mask);
+
+    __m256i output_0, output_1, output_2, output_3;
+
+    if (sbox_index < NUMBER_OF_S_BOXES - 1)
+    {
+        const int *base = (const int *)sboxes[sbox_index].sbox;
+        output_0 = _mm256_and_si256(_mm256_i32gather_epi32(base, index_0, 1), byte_mask);
+        output_1 = _mm256_and_si256(_mm256_i32gather_epi32(base, index_1, 1), byte_mask);
+        output_2 = _mm256_and_si256(_mm256_i32gather_epi32(base, index_2, 1), byte_mask);
+        output_3 = _mm256_and_si256(_mm256_i32gather_epi32(base, index_3, 1), byte_mask);
+    }
+    else
+    {
+        const int *base = (const int *)(sboxes[sbox_index].sbox - 3);
+        output_0 = _mm256_srli_epi32(_mm256_i32gather_epi32(base, index_0, 1), 24);
+        output_1 = _mm256_srli_epi32(_mm256_i32gather_epi32(base, index_1, 1), 24);
+        output_2 = _mm256_srli_epi32(_mm256_i32gather_epi32(base, index_2, 1), 24);
+        output_3 = _mm256_srli_epi32(_mm256_i32gather_epi32(base, index_3, 1), 24);
+    }
+
+    return _mm256_or_si256(_mm256_or_si256(output_0, _mm256_slli_epi32(output_1, 8)),
+                           _mm256_or_si256(_mm256_slli_epi32(output_2, 16), _mm256_slli_epi32(output_3, 24)));
+}
+
+/**
+ * Function that loads 8 blocks and splits them in the L and R halves, one block per 32-bit lane
+ *
+ * @param blocks the 8 blocks (uint8_t array)
+ * @param L pointer to the left halves (__m256i)
+ * @param R pointer to the right halves (__m256i)
+ */
+static inline AVX2_TARGET void load_halves_avx2(const uint8_t *blocks, __m256i *L, __m256i *R)
+{
+    const __m256i deinterleave = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+
+    __m256i low = _mm256_permutevar8x32_epi32(_mm256_loadu_si256((const __m256i *)blocks), deinterleave);
+    __m256i high = _mm256_permutevar8x32_epi32(_mm256_loadu_si256((const __m256i *)(blocks + 32)), deinterleave);
+
+    *L = _mm256_permute2x128_si256(low, high, 0x20);
+    *R = _mm256_permute2x128_si256(low, high, 0x31);
+}
+
+/**
+ * Function that joins the L and R halves back into 8 blocks and stores them
+ *
+ * @param blocks the 8 blocks (uint8_t array)
+ * @param L the left halves (__m256i)
+ * @param R the right halves (__m256i)
+ */
+static inline AVX2_TARGET void store_halves_avx2(uint8_t *blocks, __m256i L, __m256i R)
+{
+    const __m256i interleave = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+    __m256i low = _mm256_permute2x128_si256(L, R, 0x20);
+    __m256i high = _mm256_permute2x128_si256(L, R, 0x31);
+
+    _mm256_storeu_si256((__m256i *)blocks, _mm256_permutevar8x32_epi32(low, interleave));
+    _mm256_storeu_si256((__m256i *)(blocks + 32), _mm256_permutevar8x32_epi32(high, interleave));
+}
+
+AVX2_TARGET void e_des_encrypt_blocks_avx2(uint8_t *blocks, size_t number_of_bytes, const void *sboxes)
+{
+    const struct s_box *s_boxes = (const struct s_box *)sboxes;
+    size_t block_index = 0;
+
+    for (; block_index + AVX2_BLOCKS_PER_BATCH * BLOCK_SIZE <= number_of_bytes; block_index += AVX2_BLOCKS_PER_BATCH * BLOCK_SIZE)
+    {
+        __m256i L[AVX2_GROUPS], R[AVX2_GROUPS];
+
+        for (int group = 0; group < AVX2_GROUPS; group++)
+        {
+            load_halves_avx2(blocks + block_index + group * 8 * BLOCK_SIZE, &L[group], &R[group]);
+        }
+
+        for (int round = 0; round < NUMBER_OF_ROUNDS; round++)
+        {
+            for (int group = 0; group < AVX2_GROUPS; group++)
+            {
+                __m256i temp = _mm256_xor_si256(L[group], feistel_function_avx2(R[group], s_boxes, round));
+                L[group] = R[group];
+                R[group] = temp;
+            }
+        }
+
+        for (int group = 0; group < AVX2_GROUPS; group++)
+        {
+            store_halves_avx2(blocks + block_index + group * 8 * BLOCK_SIZE, L[group], R[group]);
+        }
+    }
+
+    for (; block_index < number_of_bytes; block_index += BLOCK_SIZE)
+    {
+        feistel_network(blocks + block_index, s_boxes);
+    }
+}
+
+AVX2_TARGET void e_des_decrypt_blocks_avx2(uint8_t *blocks, size_t number_of_bytes, const void *sboxes)
+{
+    const struct s_box *s_boxes = (const struct s_box *)sboxes;
+    size_t block_index = 0;
+
+    for (; block_index + AVX2_BLOCKS_PER_BATCH * BLOCK_SIZE <= number_of_bytes; block_index += AVX2_BLOCKS_PER_BATCH * BLOCK_SIZE)
+    {
+        __m256i L[AVX2_GROUPS], R[AVX2_GROUPS];
+
+        for (int group = 0; group < AVX2_GROUPS; group++)
+        {
+            load_halves_avx2(blocks + block_index + group * 8 * BLOCK_SIZE, &L[group], &R[group]);
+        }
+
+        for (int round = NUMBER_OF_ROUNDS - 1; round >= 0; round--)
+        {
+            for (int group = 0; group < AVX2_GROUPS; group++)
+            {
+                __m256i temp = _mm256_xor_si256(R[group], feistel_function_avx2(L[group], s_boxes, round));
+                R[group] = L[group];
+                L[group] = temp;
+            }
+        }
+
+        for (int group = 0; group < AVX2_GROUPS; group++)
+        {
+            store_halves_avx2(blocks + block_index + group * 8 * BLOCK_SIZE, L[group], R[group]);
+        }
+    }
+
+    for (; block_index < number_of_bytes; block_index += BLOCK_SIZE)
+    {
+        inverse_feistel_network(blocks + block_index, s_boxes);
+    }
+}
+
+#define SSSE3_TARGET __attribute__((target("ssse3")))
+#define AVX512_TARGET __attribute__((target("avx512f,avx512bw,avx512vbmi")))
+
+int ssse3_supported(void)
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("ssse3");
+}
+
+int avx512_vbmi_supported(void)
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512vbmi");
+}
+
+/**
+ * Function that looks up 16 bytes in a 256 byte sbox, the sbox is read as 16 chunks of 16 bytes with pshufb
+ *
+ * For the chunk c the index is xored with c << 4 and added (saturated) to 0x70, the bytes of the chunk end up below 0x80 with the low nibble kept and the others at 0xff, which pshufb turns into 0
+ *
+ * @param index the 16 indexes (__m128i)
+ * @param sbox the sbox (uint8_t array)
+ *
+ * @return the 16 sbox bytes (__m128i)
+ */
+static inline SSSE3_TARGET __m128i sbox_lookup_ssse3(__m128i index, const uint8_t *sbox)
+{
+    const __m128i bias = _mm_set1_epi8(0x70);
+    __m128i output = _mm_setzero_si128();
+
+    for (int chunk = 0; chunk < S_BOX_SIZE / 16; chunk++)
+    {
+        __m128i table = _mm_loadu_si128((const __m128i *)(sbox + 16 * chunk));
+        __m128i selector = _mm_adds_epu8(_mm_xor_si128(index, _mm_set1_epi8((char)(chunk << 4))), bias);
+        output = _mm_or_si128(output, _mm_shuffle_epi8(table, selector));
+    }
+
+    return output;
+}
+
+/**
+ * Function that transposes the 16-bit elements of 8 vectors (8x8), it is its own inverse
+ *
+ * @param vectors the 8 vectors (__m128i array)
+ */
+static inline SSSE3_TARGET void transpose_8x8_epi16_ssse3(__m128i *vectors)
+{
+    __m128i a[8], b[8];
+
+    for (int k = 0; k < 4; k++)
+    {
+        a[2 * k] = _mm_unpacklo_epi16(vectors[2 * k], vectors[2 * k + 1]);
+        a[2 * k + 1] = _mm_unpackhi_epi16(vectors[2 * k], vectors[2 * k + 1]);
+    }
+
+    for (int k = 0; k < 2; k++)
+    {
+        for (int j = 0; j < 2; j++)
+        {
+            b[4 * k + 2 * j] = _mm_unpacklo_epi32(a[4 * k + j], a[4 * k + j + 2]);
+            b[4 * k + 2 * j + 1] = _mm_unpackhi_epi32(a[4 * k + j], a[4 * k + j + 2]);
+        }
+    }
+
+    for (int j = 0; j < 4; j++)
+    {
+        vectors[2 * j] = _mm_unpacklo_epi64(b[j], b[j + 4]);
+        vectors[2 * j + 1] = _mm_unpackhi_epi64(b[j], b[j + 4]);
+    }
+}
+
+/**
+ * Function that loads 16 blocks as 8 byte planes, the plane p holds the byte p of every block
+ *
+ * @param blocks the 16 blocks (uint8_t array)
+ * @param planes the 8 planes (__m128i array)
+ */
+static inline SSSE3_TARGET void load_planes_ssse3(const uint8_t *blocks, __m128i *planes)
+{
+    // The 2 blocks of a vector are interleaved byte by byte, the 16-bit transpose then gathers the pairs of each byte position
+    const __m128i interleave = _mm_setr_epi8(0, 8, 1, 9, 2, 10, 3, 11, 4, 12, 5, 13, 6, 14, 7, 15);
+
+    for (int k = 0; k < BLOCK_SIZE; k++)
+    {
+        planes[k] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(blocks + 16 * k)), interleave);
+    }
+
+    transpose_8x8_epi16_ssse3(planes);
+}
+
+/**
+ * Function that stores 8 byte planes back as 16 blocks (the inverse of load_planes_ssse3)
+ *
+ * @param blocks the 16 blocks (uint8_t array)
+ * @param planes the 8 planes (__m128i array)
+ */
+static inline SSSE3_TARGET void store_planes_ssse3(uint8_t *blocks, __m128i *planes)
+{
+    const __m128i deinterleave = _mm_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15);
+
+    transpose_8x8_epi16_ssse3(planes);
+
+    for (int k = 0; k < BLOCK_SIZE; k++)
+    {
+        _mm_storeu_si128((__m128i *)(blocks + 16 * k), _mm_shuffle_epi8(planes[k], deinterleave));
+    }
+}
+
+/**
+ * Function that does the feistel function on the byte planes of a half block (plane 0 is byte 0), the same lookups as feistel_function
+ *
+ * @param half the 4 planes of the input half block (__m128i array)
+ * @param sbox the sbox of the round (uint8_t array)
+ * @param output the 4 planes of the output (__m128i array)
+ */
+static inline SSSE3_TARGET void feistel_function_ssse3(const __m128i *half, const uint8_t *sbox, __m128i *output)
+{
+    __m128i index = half[3];
+    output[0] = sbox_lookup_ssse3(index, sbox);
+
+    index = _mm_add_epi8(index, half[2]);
+    output[1] = sbox_lookup_ssse3(index, sbox);
+
+    index = _mm_add_epi8(index, half[1]);
+    output[2] = sbox_lookup_ssse3(index, sbox);
+
+    index = _mm_add_epi8(index, half[0]);
+    output[3] = sbox_lookup_ssse3(index, sbox);
+}
+
+SSSE3_TARGET void e_des_encrypt_blocks_ssse3(uint8_t *blocks, size_t number_of_bytes, const void *sboxes)
+{
+    const struct s_box *s_boxes = (const struct s_box *)sboxes;
+    size_t block_index = 0;
+
+    for (; block_index + SSSE3_BLOCKS_PER_BATCH * BLOCK_SIZE <= number_of_bytes; block_index += SSSE3_BLOCKS_PER_BATCH * BLOCK_SIZE)
+    {
+        // planes 0-3 are L, planes 4-7 are R, the halves swap by swapping the pointers
+        __m128i planes[BLOCK_SIZE], output[HALF_BLOCK_SIZE];
+        __m128i *L = planes, *R = planes + HALF_BLOCK_SIZE;
+
+        load_planes_ssse3(blocks + block_index, planes);
+
+        for (int round = 0; round < NUMBER_OF_ROUNDS; round++)
+        {
+            feistel_function_ssse3(R, s_boxes[round].sbox, output);
+
+            for (int byte = 0; byte < HALF_BLOCK_SIZE; byte++)
+            {
+                L[byte] = _mm_xor_si128(L[byte], output[byte]);
+            }
+
+            __m128i *temp = L;
+            L = R;
+            R = temp;
+        }
+
+        // After an even number of rounds L and R are back in their planes
+        store_planes_ssse3(blocks + block_index, planes);
+    }
+
+    e_des_encrypt_blocks_scalar(blocks + block_index, number_of_bytes - block_index, sboxes);
+}
+
+SSSE3_TARGET void e_des_decrypt_blocks_ssse3(uint8_t *blocks, size_t number_of_bytes, const void *sboxes)
+{
+    const struct s_box *s_boxes = (const struct s_box *)sboxes;
+    size_t block_index = 0;
+
+    for (; block_index + SSSE3_BLOCKS_PER_BATCH * BLOCK_SIZE <= number_of_bytes; block_index += SSSE3_BLOCKS_PER_BATCH * BLOCK_SIZE)
+    {
+        __m128i planes[BLOCK_SIZE], output[HALF_BLOCK_SIZE];
+        __m128i *L = planes, *R = planes + HALF_BLOCK_SIZE;
+
+        load_planes_ssse3(blocks + block_index, planes);
+
+        for (int round = NUMBER_OF_ROUNDS - 1; round >= 0; round--)
+        {
+            feistel_function_ssse3(L, s_boxes[round].sbox, output);
+
+            for (int byte = 0; byte < HALF_BLOCK_SIZE; byte++)
+            {
+                R[byte] = _mm_xor_si128(R[byte], output[byte]);
+            }
+
+            __m128i *temp = L;
+            L = R;
+            R = temp;
+        }
+
+        store_planes_ssse3(blocks + block_index, planes);
+    }
+
+    e_des_decrypt_blocks_scalar(blocks + block_index, number_of_bytes - block_index, sboxes);
+}
+
+/**
+ * Function that looks up 64 bytes in a 256 byte sbox held in 4 vectors, vpermi2b reads 128 bytes and the bit 7 of the index picks the half
+ *
+ * @param index the 64 indexes (__m512i)
+ * @param table the sbox (__m512i array)
+ *
+ * @return the 64 sbox bytes (__m512i)
+ */
+static inline AVX512_TARGET __m512i sbox_lookup_avx512(__m512i index, const __m512i *table)
+{
+    __m512i low = _mm512_permutex2var_epi8(table[0], index, table[1]);
+    __m512i high = _mm512_permutex2var_epi8(table[2], index, table[3]);
+
+    return _mm512_mask_blend_epi8(_mm512_movepi8_mask(index), low, high);
+}
+
+/**
+ * Function that transposes the 64-bit elements of 8 vectors (8x8), it is its own inverse
+ *
+ * @param vectors the 8 vectors (__m512i array)
+ */
+static inline AVX512_TARGET void transpose_8x8_epi64_avx512(__m512i *vectors)
+{
+    const __m512i pairs_low = _mm512_setr_epi64(0, 8, 2, 10, 4, 12, 6, 14);
+    const __m512i pairs_high = _mm512_setr_epi64(1, 9, 3, 11, 5, 13, 7, 15);
+    const __m512i quads_low = _mm512_setr_epi64(0, 1, 8, 9, 4, 5, 12, 13);
+    const __m512i quads_high = _mm512_setr_epi64(2, 3, 10, 11, 6, 7, 14, 15);
+    const __m512i octets_low = _mm512_setr_epi64(0, 1, 2, 3, 8, 9, 10, 11);
+    const __m512i octets_high = _mm512_setr_epi64(4, 5, 6, 7, 12, 13, 14, 15);
+    __m512i a[8], b[8];
+
+    for (int k = 0; k < 8; k += 2)
+    {
+        a[k] = _mm512_permutex2var_epi64(vectors[k], pairs_low, vectors[k + 1]);
+        a[k + 1] = _mm512_permutex2var_epi64(vectors[k], pairs_high, vectors[k + 1]);
+    }
+
+    for (int k = 0; k < 8; k += 4)
+    {
+        for (int j = 0; j < 2; j++)
+        {
+            b[k + j] = _mm512_permutex2var_epi64(a[k + j], quads_low, a[k + j + 2]);
+            b[k + j + 2] = _mm512_permutex2var_epi64(a[k + j], quads_high, a[k + j + 2]);
+        }
+    }
+
+    for (int j = 0; j < 4; j++)
+    {
+        vectors[j] = _mm512_permutex2var_epi64(b[j], octets_low, b[j + 4]);
+        vectors[j + 4] = _mm512_permutex2var_epi64(b[j], octets_high, b[j + 4]);
+    }
+}
+
+/**
+ * Function that loads 64 blocks as 8 byte planes, the plane p holds the byte p of every block
+ *
+ * @param blocks the 64 blocks (uint8_t array)
+ * @param planes the 8 planes (__m512i array)
+ */
+static inline AVX512_TARGET void load_planes_avx512(const uint8_t *blocks, __m512i *planes)
+{
+    // Each vector of 8 blocks is regrouped by byte position (8 bytes per position), the 64-bit transpose then joins the positions of all the vectors
+    const __m512i group = _mm512_set_epi8(63, 55, 47, 39, 31, 23, 15, 7, 62, 54, 46, 38, 30, 22, 14, 6,
+                                          61, 53, 45, 37, 29, 21, 13, 5, 60, 52, 44, 36, 28, 20, 12, 4,
+                                          59, 51, 43, 35, 27, 19, 11, 3, 58, 50, 42, 34, 26, 18, 10, 2,
+                                          57, 49, 41, 33, 25, 17, 9, 1, 56, 48, 40, 32, 24, 16, 8, 0);
+
+    for (int k = 0; k < BLOCK_SIZE; k++)
+    {
+        planes[k] = _mm512_permutexvar_epi8(group, _mm512_loadu_si512((const void *)(blocks + 64 * k)));
+    }
+
+    transpose_8x8_epi64_avx512(planes);
+}
+
+/**
+ * Function that stores 8 byte planes back as 64 blocks (the inverse of load_planes_avx512)
+ *
+ * @param blocks the 64 blocks (uint8_t array)
+ * @param planes the 8 planes (__m512i array)
+ */
+static inline AVX512_TARGET void store_planes_avx512(uint8_t *blocks, __m512i *planes)
+{
+    const __m512i ungroup = _mm512_set_epi8(63, 55, 47, 39, 31, 23, 15, 7, 62, 54, 46, 38, 30, 22, 14, 6,
+                                            61, 53, 45, 37, 29, 21, 13, 5, 60, 52, 44, 36, 28, 20, 12, 4,
+                                            59, 51, 43, 35, 27, 19, 11, 3, 58, 50, 42, 34, 26, 18, 10, 2,
+                                            57, 49, 41, 33, 25, 17, 9, 1, 56, 48, 40, 32, 24, 16, 8, 0);
+
+    transpose_8x8_epi64_avx512(planes);
+
+    for (int k = 0; k < BLOCK_SIZE; k++)
+    {
+        _mm512_storeu_si512((void *)(blocks + 64 * k), _mm512_permutexvar_epi8(ungroup, planes[k]));
+    }
+}
+
+/**
+ * Function that does the feistel function on the byte planes of a half block (plane 0 is byte 0), the same lookups as feistel_function
+ *
+ * @param half the 4 planes of the input half block (__m512i array)
+ * @param table the sbox of the round (__m512i array)
+ * @param output the 4 planes of the output (__m512i array)
+ */
+static inline AVX512_TARGET void feistel_function_avx512(const __m512i *half, const __m512i *table, __m512i *output)
+{
+    __m512i index = half[3];
+    output[0] = sbox_lookup_avx512(index, table);
+
+    index = _mm512_add_epi8(index, half[2]);
+    output[1] = sbox_lookup_avx512(index, table);
+
+    index = _mm512_add_epi8(index, half[1]);
+    output[2] = sbox_lookup_avx512(index, table);
+
+    index = _mm512_add_epi8(index, half[0]);
+    output[3] = sbox_lookup_avx512(index, table);
+}
+
+/**
+ * Function that loads the 256 bytes of an sbox in 4 vectors
+ *
+ * @param sbox the sbox (uint8_t array)
+ * @param table the 4 vectors (__m512i array)
+ */
+static inline AVX512_TARGET void load_sbox_avx512(const uint8_t *sbox, __m512i *table)
+{
+    for (int quarter = 0; quarter < 4; quarter++)
+    {
+        table[quarter] = _mm512_loadu_si512((const void *)(sbox + 64 * quarter));
+    }
+}
+
+AVX512_TARGET void e_des_encrypt_blocks_avx512(uint8_t *blocks, size_t number_of_bytes, const void *sboxes)
+{
+    const struct s_box *s_boxes = (const struct s_box *)sboxes;
+    size_t block_index = 0;
+
+    for (; block_index + AVX512_BLOCKS_PER_BATCH * BLOCK_SIZE <= number_of_bytes; block_index += AVX512_BLOCKS_PER_BATCH * BLOCK_SIZE)
+    {
+        // planes 0-3 are L, planes 4-7 are R, the halves swap by swapping the pointers
+        __m512i planes[BLOCK_SIZE], output[HALF_BLOCK_SIZE], table[4];
+        __m512i *L = planes, *R = planes + HALF_BLOCK_SIZE;
+
+        load_planes_avx512(blocks + block_index, planes);
+
+        for (int round = 0; round < NUMBER_OF_ROUNDS; round++)
+        {
+            load_sbox_avx512(s_boxes[round].sbox, table);
+            feistel_function_avx512(R, table, output);
+
+            for (int byte = 0; byte < HALF_BLOCK_SIZE; byte++)
+            {
+                L[byte] = _mm512_xor_si512(L[byte], output[byte]);
+            }
+
+            __m512i *temp = L;
+            L = R;
+            R = temp;
+        }
+
+        // After an even number of rounds L and R are back in their planes
+        store_planes_avx512(blocks + block_index, planes);
+    }
+
+    e_des_encrypt_blocks_scalar(blocks + block_index, number_of_bytes - block_index, sboxes);
+}
+
+AVX512_TARGET void e_des_decrypt_blocks_avx512(uint8_t *blocks, size_t number_of_bytes, const void *sboxes)
+{
+    const struct s_box *s_boxes = (const struct s_box *)sboxes;
+    size_t block_index = 0;
+
+    for (; block_index + AVX512_BLOCKS_PER_BATCH * BLOCK_SIZE <= number_of_bytes; block_index += AVX512_BLOCKS_PER_BATCH * BLOCK_SIZE)
+    {
+        __m512i planes[BLOCK_SIZE], output[HALF_BLOCK_SIZE], table[4];
+        __m512i *L = planes, *R = planes + HALF_BLOCK_SIZE;
+
+        load_planes_avx512(blocks + block_index, planes);
+
+        for (int round = NUMBER_OF_ROUNDS - 1; round >= 0; round--)
+        {
+            load_sbox_avx512(s_boxes[round].sbox, table);
+            feistel_function_avx512(L, table, output);
+
+            for (int byte = 0; byte < HALF_BLOCK_SIZE; byte++)
+            {
+                R[byte] = _mm512_xor_si512(R[byte], output[byte]);
+            }
+
+            __m512i *temp = L;
+            L = R;
+            R = temp;
+        }
+
+        store_planes_avx512(blocks + block_index, planes);
+    }
+
+    e_des_decrypt_blocks_scalar(blocks + block_index, number_of_bytes - block_index, sboxes);
+}
+
+#else
+
+int avx2_supported(void)
+{
+    return 0;
+}
+
+int ssse3_supported(void)
+{
+    return 0;
+}
+
+int avx512_vbmi_supported(void)
+{
+    return 0;
+}
+
+void e_des_encrypt_blocks_ssse3(uint8_t *blocks, size_t number_of_bytes, const void *sboxes)
+{
+    e_des_encrypt_blocks_scalar(blocks, number_of_bytes, sboxes);
+}
+
+void e_des_decrypt_blocks_ssse3(uint8_t *blocks, size_t number_of_bytes, const void *sboxes)
+{
+    e_des_decrypt_blocks_scalar(blocks, number_of_bytes, sboxes);
+}
+
+void e_des_encrypt_blocks_avx512(uint8_t *blocks, size_t number_of_bytes, const void *sboxes)
+{
+    e_des_encrypt_blocks_scalar(blocks, number_of_bytes, sboxes);
+}
+
+void e_des_decrypt_blocks_avx512(uint8_t *blocks, size_t number_of_bytes, const void *sboxes)
+{
+    e_des_decrypt_blocks_scalar(blocks, number_of_bytes, sboxes);
+}
+
+void e_des_encrypt_blocks_avx2(uint8_t *blocks, size_t number_of_bytes, const void *sboxes)
+{
+    e_des_encrypt_blocks_scalar(blocks, number_of_bytes, sboxes);
+}
+
+void e_des_decrypt_blocks_avx2(uint8_t *blocks, size_t number_of_bytes, const void *sboxes)
+{
+    e_des_decrypt_blocks_scalar(blocks, number_of_bytes, sboxes);
+}
+
+#endif
@@ -0,0 +1,98 @@
+#ifndef __SIMD_H__
+#define __SIMD_H__
+
+/**
+ * @file simd.h
+ * @brief Vectorized e-des kernels
+ *
+ * This file contains the SIMD kernels that run the feistel network and the inverse feistel network on many blocks at once.
+ * The kernels give the same output as feistel_network/inverse_feistel_network, the blocks that do not fill a whole vector batch are handled by the scalar functions.
+ *
+ * @author Ana Vidal (118408)
+ * @author Simão Andrade (118345)
+ * @date 2023-10-20
+ */
+
+#include "implementation.h"
+
+// Constants for the SIMD kernels
+#define AVX2_BLOCKS_PER_BATCH 16   // 2 groups of 8 blocks (one block per 32-bit lane) are interleaved to hide the gather latency
+#define SSSE3_BLOCKS_PER_BATCH 16  // the blocks are split in 8 byte planes of 16 bytes (one block per byte lane)
+#define AVX512_BLOCKS_PER_BATCH 64 // the blocks are split in 8 byte planes of 64 bytes (one block per byte lane)
+
+/**
+ * Function that checks if the CPU supports the AVX2 kernels
+ *
+ * @return 1 if AVX2 is supported, 0 otherwise
+ */
+int avx2_supported(void);
+
+/**
+ * Function that checks if the CPU supports the SSSE3 kernels
+ *
+ * @return 1 if SSSE3 is supported, 0 otherwise
+ */
+int ssse3_supported(void);
+
+/**
+ * Function that checks if the CPU supports the AVX-512 kernels (AVX-512F, AVX-512BW and AVX-512VBMI)
+ *
+ * @return 1 if they are supported, 0 otherwise
+ */
+int avx512_vbmi_supported(void);
+
+/**
+ * Function that ciphers the blocks in place with the AVX2 kernel, it must only be called when avx2_supported returns 1
+ *
+ * @param blocks the blocks (uint8_t array)
+ * @param number_of_bytes the number of bytes to cipher, multiple of BLOCK_SIZE (size_t)
+ * @param sboxes the NUMBER_OF_S_BOXES sboxes, contiguous in memory (struct s_box array)
+ */
+void e_des_encrypt_blocks_avx2(uint8_t *blocks, size_t number_of_bytes, const void *sboxes);
+
+/**
+ * Function that deciphers the blocks in place with the AVX2 kernel, it must only be called when avx2_supported returns 1
+ *
+ * @param blocks the blocks (uint8_t array)
+ * @param number_of_bytes the number of bytes to decipher, multiple of BLOCK_SIZE (size_t)
+ * @param sboxes the NUMBER_OF_S_BOXES sboxes, contiguous in memory (struct s_box array)
+ */
+void e_des_decrypt_blocks_avx2(uint8_t *blocks, size_t number_of_bytes, const void *sboxes);
+
+/**
+ * Function that ciphers the blocks in place with the SSSE3 kernel (byte planes, the sbox is read with 16 pshufb per lookup), it must only be called when ssse3_supported returns 1
+ *
+ * @param blocks the blocks (uint8_t array)
+ * @param number_of_bytes the number of bytes to cipher, multiple of BLOCK_SIZE (size_t)
+ * @param sboxes the NUMBER_OF_S_BOXES sboxes, contiguous in memory (struct s_box array)
+ */
+void e_des_encrypt_blocks_ssse3(uint8_t *blocks, size_t number_of_bytes, const void *sboxes);
+
+/**
+ * Function that deciphers the blocks in place with the SSSE3 kernel, it must only be called when ssse3_supported returns 1
+ *
+ * @param blocks the blocks (uint8_t array)
+ * @param number_of_bytes the number of bytes to decipher, multiple of BLOCK_SIZE (size_t)
+ * @param sboxes the NUMBER_OF_S_BOXES sboxes, contiguous in memory (struct s_box array)
+ */
+void e_des_decrypt_blocks_ssse3(uint8_t *blocks, size_t number_of_bytes, const void *sboxes);
+
+/**
+ * Function that ciphers the blocks in place with the AVX-512 kernel (byte planes, the sbox is read with 2 vpermi2b per lookup), it must only be called when avx512_vbmi_supported returns 1
+ *
+ * @param blocks the blocks (uint8_t array)
+ * @param number_of_bytes the number of bytes to cipher, multiple of BLOCK_SIZE (size_t)
+ * @param sboxes the NUMBER_OF_S_BOXES sboxes, contiguous in memory (struct s_box array)
+ */
+void e_des_encrypt_blocks_avx512(uint8_t *blocks, size_t number_of_bytes, const void *sboxes);
+
+/**
+ * Function that deciphers the blocks in place with the AVX-512 kernel, it must only be called when avx512_vbmi_supported returns 1
+ *
+ * @param blocks the blocks (uint8_t array)
+ * @param number_of_bytes the number of bytes to decipher, multiple of BLOCK_SIZE (size_t)
+ * @param sboxes the NUMBER_OF_S_BOXES sboxes, contiguous in memory (struct s_box array)
+ */
+void e_des_decrypt_blocks_avx512(uint8_t *blocks, size_t number_of_bytes, const void *sboxes);
+
+#endif
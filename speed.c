@@ -2,7 +2,7 @@
 
 /**
  * @file speed.c
- * @brief Tests the performance of the encryption and decryption functions (ECB and E-DES implementations)
+ * @brief Tests the performance of the encryption and decryption functions (DES-ECB, 3DES-EDE and E-DES implementations)
  *
  * @author Ana Vidal (118408)
  * @author Simão Andrade (118345)
@@ -35,55 +35,62 @@ void speed_encrypt(const int number_of_tests, const size_t number_of_bytes)
     // Time variables
     struct timespec start, end;
 
-    // Generate the random bytes
-    uint8_t random_bytes[number_of_bytes];
+    // Generate the random bytes (on the heap, a stack array breaks with large sizes)
+    uint8_t *random_bytes = (uint8_t *)malloc(number_of_bytes);
+
+    if (random_bytes == NULL) {
+        printf("Memory allocation error\n");
+        exit(1);
+    }
+
     generate_random_data(random_bytes, number_of_bytes);
 
     // Generate the password
-    uint8_t password[BLOCK_SIZE];
+    uint8_t password[BLOCK_SIZE + 1] = {0};
     generate_random_data(password, BLOCK_SIZE);
 
-    /* DES-ECB CIPHER */
-    printf("DES-ECB CIPHER\n");
+    /* DES-ECB AND 3DES-EDE CIPHER */
 
-    // Generate the key schedule
-    DES_key_schedule key_schedule;
-    DES_set_key((DES_cblock*)password, &key_schedule);
+    // Generate the keys, the whole buffer is processed by one EVP_CipherUpdate with a cached context
+    struct des_key des_keys[2];
+    const char *des_names[2] = {"DES-ECB", "3DES-EDE"};
+    generate_des_key(password, &des_keys[0]);
+    generate_triple_des_key(password, &des_keys[1]);
 
+    for (int des_index = 0; des_index < 2; des_index++) {
+        printf("%s CIPHER\n", des_names[des_index]);
 
-    clock_t *time_list_ecb = (clock_t*)malloc(number_of_tests * sizeof(clock_t));
-    for (int test = 0; test < number_of_tests; test++) {
-        clock_t start_time = clock();
-        // Perform DES-ECB encryption here
-        for (int block_index = 0; block_index < number_of_bytes; block_index += BLOCK_SIZE)
-        {
-            // Perform DES-ECB encryption here
-            DES_ecb_encrypt((DES_cblock *) (random_bytes + block_index), (DES_cblock *) (random_bytes + block_index), &key_schedule, DES_ENCRYPT);
-        }
-        clock_t end_time = clock();
-
-        time_list_ecb[test] = end_time - start_time;
-    }
+        clock_t *time_list_ecb = (clock_t*)malloc(number_of_tests * sizeof(clock_t));
+        for (int test = 0; test < number_of_tests; test++) {
+            clock_t start_time = clock();
+            // Perform DES-ECB/3DES-EDE encryption here
+            des_ecb_encrypt_blocks(random_bytes, number_of_bytes, &des_keys[des_index]);
+            clock_t end_time = clock();
 
-    // Print the results (Min, Max, Average) in milliseconds
-    clock_t minimum_time_ecb = time_list_ecb[0];
-    clock_t maximum_time_ecb = time_list_ecb[0];
-    clock_t total_time_ecb = 0;
-    for (int test = 0; test < number_of_tests; test++) {
-        if (time_list_ecb[test] < minimum_time_ecb) {
-            minimum_time_ecb = time_list_ecb[test];
+            time_list_ecb[test] = end_time - start_time;
         }
-        if (time_list_ecb[test] > maximum_time_ecb) {
-            maximum_time_ecb = time_list_ecb[test];
+
+        // Print the results (Min, Max, Average) in milliseconds
+        clock_t minimum_time_ecb = time_list_ecb[0];
+        clock_t maximum_time_ecb = time_list_ecb[0];
+        clock_t total_time_ecb = 0;
+        for (int test = 0; test < number_of_tests; test++) {
+            if (time_list_ecb[test] < minimum_time_ecb) {
+                minimum_time_ecb = time_list_ecb[test];
+            }
+            if (time_list_ecb[test] > maximum_time_ecb) {
+                maximum_time_ecb = time_list_ecb[test];
+            }
+            total_time_ecb += time_list_ecb[test];
         }
-        total_time_ecb += time_list_ecb[test];
-    }
 
-    printf("Minium: %f ms\n", (double)minimum_time_ecb / (CLOCKS_PER_SEC / 1000));
-    printf("Maximum: %f ms\n", (double)maximum_time_ecb / (CLOCKS_PER_SEC / 1000));
-    printf("Average: %f ms\n", (double)total_time_ecb / (CLOCKS_PER_SEC / 1000) / number_of_tests);
+        printf("Minium: %f ms\n", (double)minimum_time_ecb / (CLOCKS_PER_SEC / 1000));
+        printf("Maximum: %f ms\n", (double)maximum_time_ecb / (CLOCKS_PER_SEC / 1000));
+        printf("Average: %f ms\n", (double)total_time_ecb / (CLOCKS_PER_SEC / 1000) / number_of_tests);
 
-    free(time_list_ecb);
+        free(time_list_ecb);
+        des_key_clear(&des_keys[des_index]);
+    }
 
     /* E-DES CIPHER */
     printf("E-DES CIPHER\n");
@@ -106,10 +113,7 @@ void speed_encrypt(const int number_of_tests, const size_t number_of_bytes)
 
     for (int test = 0; test < number_of_tests; test++) {
         clock_t start_time = clock();
-        for (int block_index = 0; block_index < number_of_bytes; block_index += BLOCK_SIZE)
-        {
-            feistel_network((uint8_t *) (random_bytes + block_index), sboxes);
-        }
+        e_des_encrypt_blocks(random_bytes, number_of_bytes, sboxes);
         clock_t end_time = clock();
 
         time_list_edes[test] = end_time - start_time;
@@ -133,6 +137,9 @@ void speed_encrypt(const int number_of_tests, const size_t number_of_bytes)
     printf("Minium: %f ms\n", (double)minimum_time_edes / (CLOCKS_PER_SEC / 1000));
     printf("Maximum: %f ms\n", (double)maximum_time_edes / (CLOCKS_PER_SEC / 1000));
     printf("Average: %f ms\n", (double)total_time_edes / (CLOCKS_PER_SEC / 1000) / number_of_tests);
+
+    free(time_list_edes);
+    free(random_bytes);
 }
 
 /**
@@ -146,55 +153,62 @@ void speed_decrypt(const int number_of_tests, const size_t number_of_bytes)
     // Time variables
     struct timespec start, end;
 
-    // Generate the random bytes
-    uint8_t random_bytes[number_of_bytes];
+    // Generate the random bytes (on the heap, a stack array breaks with large sizes)
+    uint8_t *random_bytes = (uint8_t *)malloc(number_of_bytes);
+
+    if (random_bytes == NULL) {
+        printf("Memory allocation error\n");
+        exit(1);
+    }
+
     generate_random_data(random_bytes, number_of_bytes);
 
     // Generate the password
-    uint8_t password[BLOCK_SIZE];
+    uint8_t password[BLOCK_SIZE + 1] = {0};
     generate_random_data(password, BLOCK_SIZE);
 
-    /* DES-ECB DECIPHER */
-    printf("DES-ECB DECIPHER\n");
+    /* DES-ECB AND 3DES-EDE DECIPHER */
 
-    // Generate the key schedule
-    DES_key_schedule key_schedule;
-    DES_set_key((DES_cblock*)password, &key_schedule);
+    // Generate the keys, the whole buffer is processed by one EVP_CipherUpdate with a cached context
+    struct des_key des_keys[2];
+    const char *des_names[2] = {"DES-ECB", "3DES-EDE"};
+    generate_des_key(password, &des_keys[0]);
+    generate_triple_des_key(password, &des_keys[1]);
 
+    for (int des_index = 0; des_index < 2; des_index++) {
+        printf("%s DECIPHER\n", des_names[des_index]);
 
-    clock_t *time_list_ecb = (clock_t*)malloc(number_of_tests * sizeof(clock_t));
-    for (int test = 0; test < number_of_tests; test++) {
-        clock_t start_time = clock();
-        // Perform DES-ECB encryption here
-        for (int block_index = 0; block_index < number_of_bytes; block_index += BLOCK_SIZE)
-        {
-            // Perform DES-ECB encryption here
-            DES_ecb_encrypt((DES_cblock *) (random_bytes + block_index), (DES_cblock *) (random_bytes + block_index), &key_schedule, DES_ENCRYPT);
-        }
-        clock_t end_time = clock();
-
-        time_list_ecb[test] = end_time - start_time;
-    }
+        clock_t *time_list_ecb = (clock_t*)malloc(number_of_tests * sizeof(clock_t));
+        for (int test = 0; test < number_of_tests; test++) {
+            clock_t start_time = clock();
+            // Perform DES-ECB/3DES-EDE decryption here
+            des_ecb_decrypt_blocks(random_bytes, number_of_bytes, &des_keys[des_index]);
+            clock_t end_time = clock();
 
-    // Print the results (Min, Max, Average) in milliseconds
-    clock_t minimum_time_ecb = time_list_ecb[0];
-    clock_t maximum_time_ecb = time_list_ecb[0];
-    clock_t total_time_ecb = 0;
-    for (int test = 0; test < number_of_tests; test++) {
-        if (time_list_ecb[test] < minimum_time_ecb) {
-            minimum_time_ecb = time_list_ecb[test];
+            time_list_ecb[test] = end_time - start_time;
         }
-        if (time_list_ecb[test] > maximum_time_ecb) {
-            maximum_time_ecb = time_list_ecb[test];
+
+        // Print the results (Min, Max, Average) in milliseconds
+        clock_t minimum_time_ecb = time_list_ecb[0];
+        clock_t maximum_time_ecb = time_list_ecb[0];
+        clock_t total_time_ecb = 0;
+        for (int test = 0; test < number_of_tests; test++) {
+            if (time_list_ecb[test] < minimum_time_ecb) {
+                minimum_time_ecb = time_list_ecb[test];
+            }
+            if (time_list_ecb[test] > maximum_time_ecb) {
+                maximum_time_ecb = time_list_ecb[test];
+            }
+            total_time_ecb += time_list_ecb[test];
         }
-        total_time_ecb += time_list_ecb[test];
-    }
 
-    printf("Minium: %f ms\n", (double)minimum_time_ecb / (CLOCKS_PER_SEC / 1000));
-    printf("Maximum: %f ms\n", (double)maximum_time_ecb / (CLOCKS_PER_SEC / 1000));
-    printf("Average: %f ms\n", (double)total_time_ecb / (CLOCKS_PER_SEC / 1000) / number_of_tests);
+        printf("Minium: %f ms\n", (double)minimum_time_ecb / (CLOCKS_PER_SEC / 1000));
+        printf("Maximum: %f ms\n", (double)maximum_time_ecb / (CLOCKS_PER_SEC / 1000));
+        printf("Average: %f ms\n", (double)total_time_ecb / (CLOCKS_PER_SEC / 1000) / number_of_tests);
 
-    free(time_list_ecb);
+        free(time_list_ecb);
+        des_key_clear(&des_keys[des_index]);
+    }
 
     /* E-DES DECIPHER */
     printf("E-DES DECIPHER\n");
@@ -218,10 +232,7 @@ void speed_decrypt(const int number_of_tests, const size_t number_of_bytes)
 
     for (int test = 0; test < number_of_tests; test++) {
         clock_t start_time = clock();
-        for (int block_index = 0; block_index < number_of_bytes; block_index += BLOCK_SIZE)
-        {
-            inverse_feistel_network((uint8_t *) (random_bytes + block_index), sboxes);
-        }
+        e_des_decrypt_blocks(random_bytes, number_of_bytes, sboxes);
         clock_t end_time = clock();
 
         time_list_edes[test] = end_time - start_time;
@@ -247,13 +258,16 @@ void speed_decrypt(const int number_of_tests, const size_t number_of_bytes)
     printf("Minium: %f ms\n", (double)minimum_time_edes / (CLOCKS_PER_SEC / 1000));
     printf("Maximum: %f ms\n", (double)maximum_time_edes / (CLOCKS_PER_SEC / 1000));
     printf("Average: %f ms\n", (double)total_time_edes / (CLOCKS_PER_SEC / 1000) / number_of_tests);
+
+    free(time_list_edes);
+    free(random_bytes);
 }
 
 
 
 int main(void){
     speed_encrypt(NUMBER_OF_TESTS, BUFFER_SIZE);
-    // speed_decrypt(NUMBER_OF_TESTS, BUFFER_SIZE);
+    speed_decrypt(NUMBER_OF_TESTS, BUFFER_SIZE);
 
     return 0;
 }
\ No newline at end of file
@@ -10,6 +10,12 @@ import e_des
 import time
 from Crypto.Cipher import DES
 
+# The native extension (make python) is benchmarked next to the pure Python implementation when it is available
+try:
+    import _e_des
+except ImportError:
+    _e_des = None
+
 def generate_random_data(number_of_bytes : int) -> bytearray:
     """!
     @brief This function generates random data.
@@ -25,6 +31,17 @@ def generate_random_data(number_of_bytes : int) -> bytearray:
 
     return random_data
 
+def generate_password(number_of_bytes : int) -> bytes:
+    """!
+    @brief This function generates a random printable password (the native implementation does not accept zero bytes).
+
+    @param number_of_bytes The number of bytes of the password.
+
+    @return The password.
+    """
+
+    return bytes(ord('!') + byte % (ord('~') - ord('!') + 1) for byte in generate_random_data(number_of_bytes))
+
 def speed_encrypt(number_of_tests : bytearray, number_of_bytes : int) -> None:
     """!
     This function measures the encryption time of DES-ECB and E-DES.
@@ -37,7 +54,7 @@ def speed_encrypt(number_of_tests : bytearray, number_of_bytes : int) -> None:
 
 
     random_data = generate_random_data(number_of_bytes)
-    password = generate_random_data(e_des.BLOCK_SIZE)
+    password = generate_password(e_des.BLOCK_SIZE)
 
     # DES-ECB encryption time
     time_list_ecb = []
@@ -50,7 +67,7 @@ def speed_encrypt(number_of_tests : bytearray, number_of_bytes : int) -> None:
         time_list_ecb.append(end_time - start_time)
     
     # E-DES encryption time
-    sboxes = e_des.generate_sboxes(password)
+    sboxes = e_des.python_generate_sboxes(password)
 
     time_list_e_des = []
     for _ in range(number_of_tests):
@@ -75,6 +92,24 @@ def speed_encrypt(number_of_tests : bytearray, number_of_bytes : int) -> None:
     print("Maximum: {}".format(max(time_list_e_des)))
     print("Average: {}".format(sum(time_list_e_des) / len(time_list_e_des)))
 
+    # E-DES encryption time of the native extension, the same blocks ciphered in place without padding
+    if _e_des is not None:
+        key = _e_des.Key(password)
+        buffer = bytearray(random_data)
+
+        time_list_native = []
+        for _ in range(number_of_tests):
+            start_time = time.time_ns()
+            key.encrypt_blocks(buffer)
+            end_time = time.time_ns()
+
+            time_list_native.append(end_time - start_time)
+
+        print("E-DES (native, {} kernel) encryption time (in nanoseconds):".format(_e_des.kernel_name()))
+        print("Minimum: {}".format(min(time_list_native)))
+        print("Maximum: {}".format(max(time_list_native)))
+        print("Average: {}".format(sum(time_list_native) / len(time_list_native)))
+
 
 def speed_decrypt(number_of_tests : bytearray, number_of_bytes : int) -> None:
     """!
@@ -87,7 +122,7 @@ def speed_decrypt(number_of_tests : bytearray, number_of_bytes : int) -> None:
     """
 
     random_data = generate_random_data(number_of_bytes)
-    password = generate_random_data(e_des.BLOCK_SIZE)
+    password = generate_password(e_des.BLOCK_SIZE)
 
     # DES-ECB decryption time
     time_list_ecb = []
@@ -102,11 +137,11 @@ def speed_decrypt(number_of_tests : bytearray, number_of_bytes : int) -> None:
         time_list_ecb.append(end_time - start_time)
 
     # E-DES decryption time
-    sboxes = e_des.generate_sboxes(password)
+    sboxes = e_des.python_generate_sboxes(password)
 
     time_list_e_des = []
     for _ in range(number_of_tests):
-        ciphertext = e_des.encrypt(random_data, password)
+        ciphertext = e_des.python_encrypt(random_data, password)
 
         start_time = time.time_ns()
         for block_index in range(0, number_of_bytes, e_des.BLOCK_SIZE):
@@ -131,6 +166,24 @@ def speed_decrypt(number_of_tests : bytearray, number_of_bytes : int) -> None:
     print("Maximum: {}".format(max(time_list_e_des)))
     print("Average: {}".format(sum(time_list_e_des) / len(time_list_e_des)))
 
+    # E-DES decryption time of the native extension, the same blocks ciphered in place without padding
+    if _e_des is not None:
+        key = _e_des.Key(password)
+        buffer = bytearray(random_data)
+
+        time_list_native = []
+        for _ in range(number_of_tests):
+            start_time = time.time_ns()
+            key.decrypt_blocks(buffer)
+            end_time = time.time_ns()
+
+            time_list_native.append(end_time - start_time)
+
+        print("E-DES (native, {} kernel) decryption time (in nanoseconds):".format(_e_des.kernel_name()))
+        print("Minimum: {}".format(min(time_list_native)))
+        print("Maximum: {}".format(max(time_list_native)))
+        print("Average: {}".format(sum(time_list_native) / len(time_list_native)))
+
 if __name__ == "__main__":
 
     speed_encrypt(e_des.NUMBER_OF_RUNS, e_des.BUFFER_SIZE)
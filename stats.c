@@ -0,0 +1,85 @@
+#include "stats.h"
+#include <sys/resource.h>
+
+/**
+ * @file stats.c
+ * @brief Implementation of the runtime statistics and phase timing of the e-des program (--stats)
+ *
+ * @author Ana Vidal (118408)
+ * @author Simão Andrade (118345)
+ * @date 2023-10-20
+ */
+
+int stats_enabled = 0;
+
+static struct stats_counters counters_of_phase[NUMBER_OF_STATS_PHASES];
+
+static const char *phase_names[NUMBER_OF_STATS_PHASES] = {"read_bytes", "generate_sboxes", "add_padding", "feistel", "write_bytes"};
+
+uint64_t stats_now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+void stats_record(enum stats_phase phase, uint64_t start, size_t number_of_bytes)
+{
+    struct stats_counters *counters = &counters_of_phase[phase];
+
+    // Relaxed atomics, the counters are only read once the run is over
+    __atomic_add_fetch(&counters->nanoseconds, stats_now() - start, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&counters->calls, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&counters->bytes, number_of_bytes, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&counters->blocks, number_of_bytes / BLOCK_SIZE, __ATOMIC_RELAXED);
+}
+
+void stats_get(enum stats_phase phase, struct stats_counters *counters)
+{
+    counters->nanoseconds = __atomic_load_n(&counters_of_phase[phase].nanoseconds, __ATOMIC_RELAXED);
+    counters->calls = __atomic_load_n(&counters_of_phase[phase].calls, __ATOMIC_RELAXED);
+    counters->bytes = __atomic_load_n(&counters_of_phase[phase].bytes, __ATOMIC_RELAXED);
+    counters->blocks = __atomic_load_n(&counters_of_phase[phase].blocks, __ATOMIC_RELAXED);
+}
+
+/**
+ * Function that computes a throughput
+ *
+ * @param number_of_bytes the number of bytes (uint64_t)
+ * @param nanoseconds the time (uint64_t)
+ *
+ * @return the throughput in MB/s, 0 for no time (double)
+ */
+static double throughput(uint64_t number_of_bytes, uint64_t nanoseconds)
+{
+    return nanoseconds > 0 ? (double)number_of_bytes * 1000.0 / (double)nanoseconds : 0.0;
+}
+
+void stats_print(FILE *output, const char *mode, const char *operation, size_t number_of_threads, uint64_t start)
+{
+    uint64_t elapsed = stats_now() - start;
+
+    // ru_maxrss is in KiB on Linux
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    struct stats_counters feistel;
+    stats_get(STATS_FEISTEL, &feistel);
+
+    fprintf(output, "{\"mode\": \"%s\", \"operation\": \"%s\", \"kernel\": \"%s\", \"threads\": %zu, ", mode, operation, e_des_kernel_name(), number_of_threads);
+    fprintf(output, "\"elapsed_ns\": %llu, \"bytes\": %llu, \"throughput_mb_s\": %.2f, \"peak_rss_kib\": %ld, \"phases\": {",
+            (unsigned long long)elapsed, (unsigned long long)feistel.bytes, throughput(feistel.bytes, elapsed), usage.ru_maxrss);
+
+    for (int phase = 0; phase < NUMBER_OF_STATS_PHASES; phase++)
+    {
+        struct stats_counters counters;
+        stats_get((enum stats_phase)phase, &counters);
+
+        fprintf(output, "%s\"%s\": {\"ns\": %llu, \"calls\": %llu, \"bytes\": %llu, \"blocks\": %llu, \"throughput_mb_s\": %.2f}", phase > 0 ? ", " : "", phase_names[phase],
+                (unsigned long long)counters.nanoseconds, (unsigned long long)counters.calls, (unsigned long long)counters.bytes, (unsigned long long)counters.blocks,
+                throughput(counters.bytes, counters.nanoseconds));
+    }
+
+    fprintf(output, "}}\n");
+}
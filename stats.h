@@ -0,0 +1,99 @@
+#ifndef __STATS_H__
+#define __STATS_H__
+
+/**
+ * @file stats.h
+ * @brief Runtime statistics and phase timing of the e-des program (--stats)
+ *
+ * This file contains the counters (monotonic nanoseconds, calls, bytes and blocks) of the phases of a run, read_bytes, generate_sboxes, add_padding, feistel and write_bytes,
+ * and the JSON summary printed by --stats. The phases are timed around each chunk by the calling thread (the feistel phase of a chunk spread on the thread pool is its wall time).
+ *
+ * The STATS_START/STATS_STOP macros only cost a predictable branch while --stats is off, and compiling with -DEDES_STATS=0 removes them altogether.
+ *
+ * @author Ana Vidal (118408)
+ * @author Simão Andrade (118345)
+ * @date 2023-10-20
+ */
+
+#include "implementation.h"
+
+#ifndef EDES_STATS
+#define EDES_STATS 1 // phase timing of --stats, can be compiled out (-DEDES_STATS=0)
+#endif
+
+/**
+ * Enum that represents the phases of a run
+ */
+enum stats_phase
+{
+    STATS_READ_BYTES,
+    STATS_GENERATE_SBOXES,
+    STATS_ADD_PADDING,
+    STATS_FEISTEL,
+    STATS_WRITE_BYTES,
+    NUMBER_OF_STATS_PHASES
+};
+
+/**
+ * Struct that represents the counters of a phase
+ *
+ * @param nanoseconds the time spent in the phase (uint64_t)
+ * @param calls the number of times the phase ran (uint64_t)
+ * @param bytes the number of bytes processed (uint64_t)
+ * @param blocks the number of whole blocks processed (uint64_t)
+ */
+struct stats_counters
+{
+    uint64_t nanoseconds;
+    uint64_t calls;
+    uint64_t bytes;
+    uint64_t blocks;
+};
+
+// Set by --stats, the phases are only timed while it is set
+extern int stats_enabled;
+
+#if EDES_STATS
+#define STATS_START(start) uint64_t start = stats_enabled ? stats_now() : 0
+#define STATS_STOP(phase, start, number_of_bytes) (stats_enabled ? stats_record(phase, start, number_of_bytes) : (void)0)
+#else
+#define STATS_START(start)
+#define STATS_STOP(phase, start, number_of_bytes) ((void)0)
+#endif
+
+/**
+ * Function that reads the monotonic clock
+ *
+ * @return the time in nanoseconds (uint64_t)
+ */
+uint64_t stats_now(void);
+
+/**
+ * Function that adds a run of a phase to its counters, it can be called from any thread
+ *
+ * @param phase the phase (enum stats_phase)
+ * @param start the time the phase started, from stats_now (uint64_t)
+ * @param number_of_bytes the number of bytes processed (size_t)
+ */
+void stats_record(enum stats_phase phase, uint64_t start, size_t number_of_bytes);
+
+/**
+ * Function that copies the counters of a phase
+ *
+ * @param phase the phase (enum stats_phase)
+ * @param counters pointer to the copy (struct stats_counters)
+ */
+void stats_get(enum stats_phase phase, struct stats_counters *counters);
+
+/**
+ * Function that prints the JSON summary of the run: the counters and throughput of each phase, the total time and throughput, the peak resident memory, the kernel and the number of threads
+ *
+ * @param output the output stream (FILE)
+ * @param mode the mode of the run (char array)
+ * @param operation "encrypt" or "decrypt" (char array)
+ * @param number_of_threads the number of threads (size_t)
+ * @param start the time the run started, from stats_now (uint64_t)
+ */
+void stats_print(FILE *output, const char *mode, const char *operation, size_t number_of_threads, uint64_t start);
+
+#endif